@@ -0,0 +1,757 @@
+/*
+ * ALx
+ * Mixer control daemon
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * alxd owns every mixer device opened on the host. Clients connect to
+ * its Unix domain socket (usually through the ALxClient library, which
+ * implements alx.h on top of it) and share one ALXdevice per mixer.
+ *
+ * Values read from the library are cached per device and served from
+ * the cache until the next refresh; writes go through the library and
+ * then read the device back. alxd is the only owner of its mixers, so
+ * it asks the library for their notifications, which lets the library
+ * keep what the controls hold and leave out writes that change nothing.
+ * A device refreshes when notifications arrived: the cached values of
+ * devices that have subscribers are read again and they are notified of
+ * whatever changed. Devices without notifications refresh every 250 ms.
+ *
+ * usage: alxd [-c topology-cache-file]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <al.h>
+#include <alx.h>
+
+#include "protocol.h"
+#include "../win32/Shared.h"
+
+#if defined(_WIN32)
+ #include <windows.h>
+#else
+ #include <time.h>
+ #include <signal.h>
+ #include <fcntl.h>
+ #include <errno.h>
+#endif
+
+// select cannot wait for the library's notifications, which are window
+// messages on Windows, so the loop wakes up this often to process them
+#define ALXD_EVENTS_MS          50
+#define ALXD_REFRESH_MS         250
+#define ALXD_MAX_CLIENTS        (FD_SETSIZE - 1)
+#define ALXD_TRACE_RECORDS      65536
+
+struct CachedValue
+{
+    unsigned short  op;
+    int             param;
+    int             index;
+    int             value;
+};
+
+struct Device
+{
+    ALXdevice      *mixer;
+    char            name[256];
+    bool            capture;
+    bool            watched;
+    int             refs;
+    int             subscribers;
+    std::vector<CachedValue> cache;
+
+    Device() : mixer(0), capture(false), watched(false), refs(0), subscribers(0) {
+        name[0] = '\0';
+    }
+};
+
+struct Client
+{
+    alxd_socket     fd;
+    std::vector<char> in;
+    std::vector<char> out;
+    std::vector<unsigned short> devices;
+    std::vector<unsigned short> subscriptions;
+};
+
+static std::vector<Device> devices;
+static std::vector<Client> clients;
+
+///////////////////////////////////////////////////////
+
+static unsigned long now()
+{
+#if defined(_WIN32)
+    return GetTickCount();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif
+}
+
+static bool contains(const std::vector<unsigned short> &handles, unsigned short handle)
+{
+    for (size_t i = 0; i < handles.size(); i++) {
+        if (handles[i] == handle)
+            return true;
+    }
+    return false;
+}
+
+static void erase(std::vector<unsigned short> &handles, unsigned short handle)
+{
+    for (size_t i = 0; i < handles.size(); i++) {
+        if (handles[i] == handle) {
+            handles.erase(handles.begin() + i);
+            return;
+        }
+    }
+}
+
+static void queue(Client &client, const ALXDframe &frame, const char *payload, size_t len)
+{
+    ALXDframe header = frame;
+
+    header.size = (unsigned int)(sizeof(ALXDframe) + len);
+    client.out.insert(client.out.end(),
+        reinterpret_cast<const char *>(&header),
+        reinterpret_cast<const char *>(&header) + sizeof(header));
+    if (len)
+        client.out.insert(client.out.end(), payload, payload + len);
+}
+
+static void notify(unsigned short handle, const CachedValue &entry)
+{
+    ALXDframe frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.op = ALXD_OP_NOTIFY;
+    frame.device = handle;
+    frame.param = entry.param;
+    frame.index = entry.index;
+    frame.value = entry.value;
+    frame.status = entry.op;
+
+    for (size_t i = 0; i < clients.size(); i++) {
+        if (contains(clients[i].subscriptions, handle))
+            queue(clients[i], frame, NULL, 0);
+    }
+}
+
+///////////////////////////////////////////////////////
+// Devices
+
+static Device *getDevice(unsigned short handle)
+{
+    if (handle == 0 || handle > devices.size() || devices[handle - 1].mixer == NULL)
+        return NULL;
+    return &devices[handle - 1];
+}
+
+/*
+    Substring match between an OpenAL and a mixer device name, as done
+    by alxMapDevice, falling back to the first (default) device.
+*/
+static const char *mapDeviceName(const char *deviceName, bool capture)
+{
+    const ALXchar *list = alxGetString(NULL,
+        capture ? ALX_CAPTURE_DEVICE_SPECIFIER : ALX_DEVICE_SPECIFIER);
+    const ALXchar *name;
+
+    if (list == NULL)
+        return NULL;
+
+    for (name = list; *name; name += strlen(name) + 1) {
+        if (alx::match_device_name(deviceName, name))
+            return name;
+    }
+
+    return *list ? list : NULL;
+}
+
+static unsigned short openDevice(const char *name, bool capture, int &status)
+{
+    ALXdevice *mixer;
+    ALXpollfd fd;
+    size_t i;
+
+    for (i = 0; i < devices.size(); i++) {
+        if (devices[i].mixer && devices[i].capture == capture
+            && !strcmp(devices[i].name, name)) {
+            devices[i].refs++;
+            return (unsigned short)(i + 1);
+        }
+    }
+
+    mixer = capture ? alxOpenCaptureDevice(name) : alxOpenDevice(name);
+    status = alxGetError(NULL);
+    if (mixer == NULL)
+        return 0;
+
+    for (i = 0; i < devices.size(); i++) {
+        if (devices[i].mixer == NULL)
+            break;
+    }
+    if (i == devices.size()) {
+        if (devices.size() == 0xFFFF) {
+            alxCloseDevice(mixer);
+            status = ALX_OUT_OF_MEMORY;
+            return 0;
+        }
+        devices.push_back(Device());
+    }
+
+    Device &device = devices[i];
+    device.mixer = mixer;
+    device.capture = capture;
+    device.watched = alxGetPollDescriptors(mixer, &fd, 1) > 0;
+    (void) alxGetError(NULL);
+    device.refs = 1;
+    device.subscribers = 0;
+    device.cache.clear();
+    strncpy(device.name, name, sizeof(device.name) - 1);
+    device.name[sizeof(device.name) - 1] = '\0';
+    return (unsigned short)(i + 1);
+}
+
+static void closeDevice(unsigned short handle)
+{
+    Device *device = getDevice(handle);
+
+    if (device && --device->refs == 0) {
+        alxCloseDevice(device->mixer);
+        device->mixer = NULL;
+        device->cache.clear();
+    }
+}
+
+/*
+    Read a value through the library, bypassing the cache.
+*/
+static int readValue(Device &device, unsigned short op, int param, int index, int &status)
+{
+    int value = 0;
+
+    switch (op) {
+    case ALXD_OP_GET_FLOAT:
+        value = alxdFloatBits(alxGetFloat(device.mixer, param));
+        break;
+    case ALXD_OP_GET_BOOLEAN:
+        value = alxGetBoolean(device.mixer, param);
+        break;
+    case ALXD_OP_GET_INTEGER:
+        value = alxGetInteger(device.mixer, param);
+        break;
+    case ALXD_OP_GET_INDEXED_FLOAT:
+        value = alxdFloatBits(alxGetIndexedFloat(device.mixer, param, index));
+        break;
+    case ALXD_OP_GET_INDEXED_BOOLEAN:
+        value = alxGetIndexedBoolean(device.mixer, param, index);
+        break;
+    }
+
+    status = alxGetError(NULL);
+    return value;
+}
+
+static CachedValue *findCached(Device &device, unsigned short op, int param, int index)
+{
+    for (size_t i = 0; i < device.cache.size(); i++) {
+        CachedValue &entry = device.cache[i];
+        if (entry.op == op && entry.param == param && entry.index == index)
+            return &entry;
+    }
+    return NULL;
+}
+
+static int getValue(Device &device, unsigned short op, int param, int index, int &status)
+{
+    CachedValue *cached = findCached(device, op, param, index);
+    CachedValue entry;
+
+    status = ALX_NO_ERROR;
+    if (cached)
+        return cached->value;
+
+    entry.op = op;
+    entry.param = param;
+    entry.index = index;
+    entry.value = readValue(device, op, param, index, status);
+    if (status == ALX_NO_ERROR)
+        device.cache.push_back(entry);
+
+    return entry.value;
+}
+
+/*
+    Re-read every cached value of a device, notifying subscribers of
+    those that changed. Devices nobody subscribed to simply drop their
+    cache, so the next read goes to the driver again.
+*/
+static void refreshDevice(unsigned short handle)
+{
+    Device *device = getDevice(handle);
+    int status, value;
+
+    if (device->subscribers == 0) {
+        device->cache.clear();
+        return;
+    }
+
+    for (size_t i = 0; i < device->cache.size(); i++) {
+        CachedValue &entry = device->cache[i];
+        value = readValue(*device, entry.op, entry.param, entry.index, status);
+        if (status == ALX_NO_ERROR && value != entry.value) {
+            entry.value = value;
+            notify(handle, entry);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////
+// Requests
+
+static void handle(Client &client, const ALXDframe &request, const char *payload)
+{
+    ALXDframe reply = request;
+    Device *device = NULL;
+    const char *text = NULL;
+    size_t len = 0;
+    int status = ALX_NO_ERROR;
+
+    reply.value = 0;
+
+    if (request.device) {
+        if (!contains(client.devices, request.device)
+            || (device = getDevice(request.device)) == NULL) {
+            reply.status = ALX_INVALID_DEVICE;
+            queue(client, reply, NULL, 0);
+            return;
+        }
+    }
+
+    switch (request.op) {
+    case ALXD_OP_HELLO:
+        reply.value = ALXD_PROTOCOL_VERSION;
+        break;
+
+    case ALXD_OP_OPEN_DEVICE:
+    case ALXD_OP_OPEN_CAPTURE_DEVICE:
+    case ALXD_OP_MAP_DEVICE:
+    case ALXD_OP_MAP_CAPTURE_DEVICE: {
+        bool capture = request.op == ALXD_OP_OPEN_CAPTURE_DEVICE
+                    || request.op == ALXD_OP_MAP_CAPTURE_DEVICE;
+        const char *name = payload;
+
+        if (name && (request.op == ALXD_OP_MAP_DEVICE || request.op == ALXD_OP_MAP_CAPTURE_DEVICE))
+            name = mapDeviceName(name, capture);
+
+        if (name == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+
+        reply.device = openDevice(name, capture, status);
+        if (reply.device)
+            client.devices.push_back(reply.device);
+        break;
+    }
+
+    case ALXD_OP_CLOSE_DEVICE:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        erase(client.devices, request.device);
+        if (contains(client.subscriptions, request.device)
+            && !contains(client.devices, request.device)) {
+            erase(client.subscriptions, request.device);
+            device->subscribers--;
+        }
+        closeDevice(request.device);
+        break;
+
+    case ALXD_OP_GET_FLOAT:
+    case ALXD_OP_GET_BOOLEAN:
+    case ALXD_OP_GET_INTEGER:
+    case ALXD_OP_GET_INDEXED_FLOAT:
+    case ALXD_OP_GET_INDEXED_BOOLEAN:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        reply.value = getValue(*device, request.op, request.param, request.index, status);
+        break;
+
+    case ALXD_OP_SET_FLOAT:
+    case ALXD_OP_SET_BOOLEAN:
+    case ALXD_OP_SET_INTEGER:
+    case ALXD_OP_SET_INDEXED_FLOAT:
+    case ALXD_OP_SET_INDEXED_BOOLEAN:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        switch (request.op) {
+        case ALXD_OP_SET_FLOAT:
+            alxSetFloat(device->mixer, request.param, alxdBitsFloat(request.value));
+            break;
+        case ALXD_OP_SET_BOOLEAN:
+            alxSetBoolean(device->mixer, request.param, (ALXboolean) request.value);
+            break;
+        case ALXD_OP_SET_INTEGER:
+            alxSetInteger(device->mixer, request.param, request.value);
+            break;
+        case ALXD_OP_SET_INDEXED_FLOAT:
+            alxSetIndexedFloat(device->mixer, request.param, request.index, alxdBitsFloat(request.value));
+            break;
+        case ALXD_OP_SET_INDEXED_BOOLEAN:
+            alxSetIndexedBoolean(device->mixer, request.param, request.index, (ALXboolean) request.value);
+            break;
+        }
+        status = alxGetError(NULL);
+        if (status != ALX_NO_ERROR)
+            break;
+
+        // The driver snaps values to its own steps, and selecting another
+        // input source changes what several other values refer to, so
+        // the cache is always read back rather than set to the request.
+        refreshDevice(request.device);
+        break;
+
+    case ALXD_OP_GET_INTEGERV:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        alxGetIntegerv(device->mixer, request.param, request.index, &reply.value);
+        status = alxGetError(NULL);
+        break;
+
+    case ALXD_OP_SET_INTEGERV:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        alxSetIntegerv(device->mixer, request.param, request.index, &request.value);
+        status = alxGetError(NULL);
+        if (status == ALX_NO_ERROR)
+            refreshDevice(request.device);
+        break;
+
+    case ALXD_OP_GET_STRING:
+        text = alxGetString(device ? device->mixer : NULL, request.param);
+        status = alxGetError(NULL);
+        if (text) {
+            if (device) {
+                len = strlen(text) + 1;
+            }
+            else {
+                // device lists end with an empty string
+                while (text[len])
+                    len += strlen(text + len) + 1;
+                len++;
+            }
+        }
+        break;
+
+    case ALXD_OP_GET_INDEXED_STRING:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        text = alxGetIndexedString(device->mixer, request.param, request.index);
+        status = alxGetError(NULL);
+        if (text)
+            len = strlen(text) + 1;
+        break;
+
+    case ALXD_OP_SUBSCRIBE:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        if (!contains(client.subscriptions, request.device)) {
+            client.subscriptions.push_back(request.device);
+            device->subscribers++;
+        }
+        break;
+
+    case ALXD_OP_UNSUBSCRIBE:
+        if (device == NULL) {
+            status = ALX_INVALID_DEVICE;
+            break;
+        }
+        if (contains(client.subscriptions, request.device)) {
+            erase(client.subscriptions, request.device);
+            device->subscribers--;
+        }
+        break;
+
+    default:
+        status = ALX_INVALID_ENUM;
+        break;
+    }
+
+    if (len > ALXD_MAX_PAYLOAD) {
+        len = 0;
+        status = ALX_INVALID_VALUE;
+    }
+
+    reply.status = status;
+    queue(client, reply, text, len);
+}
+
+/*
+    Handle every complete frame received so far. Returns false when the
+    client sent something that is not a frame.
+*/
+static bool process(Client &client)
+{
+    size_t offset = 0;
+    ALXDframe request;
+    const char *payload;
+
+    while (client.in.size() - offset >= sizeof(ALXDframe)) {
+        memcpy(&request, &client.in[offset], sizeof(request));
+        if (request.size < sizeof(ALXDframe) || request.size > ALXD_MAX_FRAME)
+            return false;
+        if (client.in.size() - offset < request.size)
+            break;
+
+        payload = NULL;
+        if (request.size > sizeof(ALXDframe)) {
+            payload = &client.in[offset + sizeof(ALXDframe)];
+            if (payload[request.size - sizeof(ALXDframe) - 1] != '\0')
+                return false;
+        }
+
+        handle(client, request, payload);
+        offset += request.size;
+    }
+
+    client.in.erase(client.in.begin(), client.in.begin() + offset);
+    return true;
+}
+
+static void disconnect(size_t i)
+{
+    Client &client = clients[i];
+    size_t j;
+
+    for (j = 0; j < client.subscriptions.size(); j++) {
+        Device *device = getDevice(client.subscriptions[j]);
+        if (device)
+            device->subscribers--;
+    }
+    for (j = 0; j < client.devices.size(); j++)
+        closeDevice(client.devices[j]);
+
+    alxd_close(client.fd);
+    clients.erase(clients.begin() + i);
+}
+
+/*
+    Client sockets never block, so a client that stops reading can only
+    grow its own output queue instead of stalling every other client.
+*/
+static bool setNonBlocking(alxd_socket fd)
+{
+#if defined(_WIN32)
+    u_long mode = 1;
+    return ioctlsocket(fd, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static bool wouldBlock()
+{
+#if defined(_WIN32)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+///////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    struct sockaddr_un addr;
+    alxd_socket listener, fd;
+    fd_set readable, writable;
+    struct timeval timeout;
+    unsigned long lastEvents, lastRefresh, elapsed;
+    bool refresh;
+    char buffer[8192];
+    int i, n, maxfd;
+    size_t c;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            alxSetTopologyCache(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            if (!alxPublishSharedState(argv[++i])) {
+                fprintf(stderr, "alxd: cannot publish shared state %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            if (!alxStartTrace(argv[++i], ALXD_TRACE_RECORDS)) {
+                fprintf(stderr, "alxd: cannot trace to %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) {
+            if (!alxStartEventTrace(argv[++i])) {
+                fprintf(stderr, "alxd: cannot write events to %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else {
+            fprintf(stderr, "usage: %s [-c topology-cache-file] [-s shared-state-name] [-t trace-file] [-e event-file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+#if defined(_WIN32)
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+        return 1;
+#else
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    alxdSocketPath(&addr);
+#if defined(_WIN32)
+    DeleteFileA(addr.sun_path);
+#else
+    unlink(addr.sun_path);
+#endif
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == ALXD_INVALID_SOCKET
+        || bind(listener, (struct sockaddr *) &addr, sizeof(addr)) != 0
+        || listen(listener, 16) != 0) {
+        fprintf(stderr, "alxd: cannot listen on %s\n", addr.sun_path);
+        return 1;
+    }
+
+    lastEvents = lastRefresh = now();
+
+    for (;;) {
+        FD_ZERO(&readable);
+        FD_ZERO(&writable);
+        FD_SET(listener, &readable);
+        maxfd = (int) listener;
+
+        for (c = 0; c < clients.size(); c++) {
+            FD_SET(clients[c].fd, &readable);
+            if (!clients[c].out.empty())
+                FD_SET(clients[c].fd, &writable);
+            if ((int) clients[c].fd > maxfd)
+                maxfd = (int) clients[c].fd;
+        }
+
+        elapsed = now() - lastEvents;
+        elapsed = elapsed < ALXD_EVENTS_MS ? ALXD_EVENTS_MS - elapsed : 0;
+        timeout.tv_sec = elapsed / 1000;
+        timeout.tv_usec = (elapsed % 1000) * 1000;
+
+        n = select(maxfd + 1, &readable, &writable, NULL, &timeout);
+        if (n < 0)
+            continue;
+
+        if (FD_ISSET(listener, &readable)) {
+            fd = accept(listener, NULL, NULL);
+            if (fd != ALXD_INVALID_SOCKET) {
+                if (clients.size() < ALXD_MAX_CLIENTS && setNonBlocking(fd)) {
+                    clients.push_back(Client());
+                    clients.back().fd = fd;
+                }
+                else {
+                    alxd_close(fd);
+                }
+            }
+        }
+
+        for (c = clients.size(); c-- > 0; ) {
+            Client &client = clients[c];
+
+            if (FD_ISSET(client.fd, &readable)) {
+                n = recv(client.fd, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    disconnect(c);
+                    continue;
+                }
+                client.in.insert(client.in.end(), buffer, buffer + n);
+                if (!process(client)) {
+                    disconnect(c);
+                    continue;
+                }
+            }
+
+            if (!client.out.empty() && FD_ISSET(client.fd, &writable)) {
+                n = ::send(client.fd, &client.out[0], (int) client.out.size(), 0);
+                if (n < 0 && !wouldBlock()) {
+                    disconnect(c);
+                    continue;
+                }
+                if (n > 0)
+                    client.out.erase(client.out.begin(), client.out.begin() + n);
+            }
+        }
+
+        if (now() - lastEvents >= ALXD_EVENTS_MS) {
+            refresh = now() - lastRefresh >= ALXD_REFRESH_MS;
+            for (c = 0; c < devices.size(); c++) {
+                if (devices[c].mixer == NULL)
+                    continue;
+                if (alxProcessEvents(devices[c].mixer) > 0 || (refresh && !devices[c].watched))
+                    refreshDevice((unsigned short)(c + 1));
+            }
+            lastEvents = now();
+            if (refresh)
+                lastRefresh = lastEvents;
+        }
+    }
+
+    return 0;
+}
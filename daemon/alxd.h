@@ -0,0 +1,82 @@
+/*
+ * ALx
+ * Mixer daemon client extensions
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef AL_ALXD_H
+#define AL_ALXD_H
+
+/*
+ * The ALxClient library implements the alx.h API by forwarding every
+ * call to the alxd daemon, so programs only need to be linked against
+ * it instead of ALx. Setters do not wait for the daemon to answer: they
+ * are pipelined, and any error they cause is reported by a later call
+ * to alxGetError. The functions below are only found in ALxClient.
+ */
+
+#include <alx.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Change notification callback. 'param' and 'index' are those given to
+ * the getter named by 'kind' (ALXD_KIND_*), and 'value' is its result.
+ */
+typedef void (ALX_APIENTRY *LPALXDNOTIFY)( ALXdevice *mixer, ALXenum kind, ALXenum param, ALXint index, ALXfloat value, void *userdata );
+
+#define ALXD_KIND_FLOAT                          1
+#define ALXD_KIND_BOOLEAN                        2
+#define ALXD_KIND_INTEGER                        3
+#define ALXD_KIND_INDEXED_FLOAT                  4
+#define ALXD_KIND_INDEXED_BOOLEAN                5
+
+/*
+ * Ask the daemon for change notifications of a device. NULL callback
+ * unsubscribes.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxdSubscribe( ALXdevice *mixer, LPALXDNOTIFY callback, void *userdata );
+
+/*
+ * Wait up to 'timeout' milliseconds for notifications and call the
+ * callbacks of every notification received. Returns how many were
+ * dispatched.
+ */
+ALX_API ALXint          ALX_APIENTRY alxdDispatch( ALXint timeout );
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* AL_ALXD_H */
@@ -0,0 +1,1491 @@
+/*
+ * ALx
+ * Mixer daemon client
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __MINGW32__
+#define _CRT_SECURE_NO_DEPRECATE // get rid of sprintf security warnings on VS2005
+#define _CRT_NONSTDC_NO_DEPRECATE
+#if defined(_WIN32)
+#pragma comment(lib, "ws2_32.lib")
+#endif
+#endif
+
+#define ALX_BUILD_LIBRARY
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <new>
+#include <alx.h>
+
+#include "protocol.h"
+#include "alxd.h"
+#include "../win32/Levels.h"
+#include "../win32/Queue.h"
+#include "../win32/Shared.h"
+
+///////////////////////////////////////////////////////
+// Client side devices
+
+struct ALXname
+{
+    ALXenum     param;
+    ALXint      index;
+    ALXchar    *name;
+    ALXname    *next;
+};
+
+// Names are allocated along with their text. Devices remember the
+// allocator they were created with, see alxSetAllocator. The command
+// queue lives here rather than in the daemon, since an audio thread
+// must not make the system call that reaching the daemon takes.
+struct ALXdevice_struct
+{
+    unsigned short      handle;
+    ALXname            *names;
+    LPALXDNOTIFY        callback;
+    void               *userdata;
+    ALXdevice_struct   *next;
+    LPALXALLOC          allocFunc;
+    LPALXFREE           freeFunc;
+    void               *allocData;
+    alx::CommandQueue  *queue;
+    void               *queueBlock;
+    alx::QueueIndex     queueSlots;
+
+    ALXdevice_struct(LPALXALLOC allocFunc_, LPALXFREE freeFunc_, void *allocData_)
+        : handle(0), names(0), callback(0), userdata(0), next(0),
+          allocFunc(allocFunc_), freeFunc(freeFunc_), allocData(allocData_),
+          queue(0), queueBlock(0), queueSlots(0)
+    {}
+
+    ~ALXdevice_struct() {
+        ALXname *name;
+        while (names) {
+            name = names;
+            names = names->next;
+            freeFunc(name, allocData);
+        }
+        if (queueBlock)
+            freeFunc(queueBlock, allocData);
+    }
+
+    /*
+        (Re)create the command queue, as the library does. Must not be
+        called while another thread may push commands.
+    */
+    bool setQueueSize(ALXint size) {
+        ALXenum policy = queue ? queue->policy() : ALX_QUEUE_DROP_NEWEST;
+        alx::QueueIndex capacity;
+
+        queue = NULL;
+
+        if (size <= 0)
+            return true;
+
+        capacity = alx::CommandQueue::roundCapacity(size);
+        if (capacity > queueSlots) {
+            if (queueBlock)
+                freeFunc(queueBlock, allocData);
+            queueBlock = allocFunc(sizeof(alx::CommandQueue) + capacity * sizeof(alx::Command), allocData);
+            if (queueBlock == NULL) {
+                queueSlots = 0;
+                return false;
+            }
+            queueSlots = capacity;
+        }
+
+        queue = new (queueBlock) alx::CommandQueue(reinterpret_cast<alx::Command *>(
+            (char *) queueBlock + sizeof(alx::CommandQueue)), capacity);
+        queue->setPolicy(policy);
+        return true;
+    }
+};
+
+namespace alxd {
+
+#define ALXD_MAX_NOTIFICATIONS  256
+
+///////////////////////////////////////////////////////
+// Global Variables
+
+// Mixer Error
+ALXenum LastError = ALX_NO_ERROR;
+
+// Daemon connection
+alxd_socket Socket = ALXD_INVALID_SOCKET;
+unsigned int Serial = 0;
+
+// Received bytes not handled yet
+char Input[4 * ALXD_MAX_FRAME];
+size_t InputSize = 0;
+
+// Notifications received while waiting for a reply
+ALXDframe Notifications[ALXD_MAX_NOTIFICATIONS];
+unsigned int NotificationHead = 0;
+unsigned int NotificationCount = 0;
+
+// Open devices
+ALXdevice *Devices = NULL;
+
+// Memory allocator
+void * ALX_APIENTRY defaultAlloc(size_t size, void *) { return malloc(size); }
+void ALX_APIENTRY defaultFree(void *ptr, void *) { free(ptr); }
+
+LPALXALLOC AllocFunc = defaultAlloc;
+LPALXFREE FreeFunc = defaultFree;
+void *AllocData = NULL;
+
+// Device strings
+ALXchar DeviceList[ALXD_MAX_PAYLOAD] = { 0 };
+ALXchar CaptureDeviceList[ALXD_MAX_PAYLOAD] = { 0 };
+
+///////////////////////////////////////////////////////
+
+void setError(ALXenum errorCode)
+{
+    LastError = errorCode;
+}
+
+void disconnect()
+{
+    if (Socket != ALXD_INVALID_SOCKET)
+        alxd_close(Socket);
+    Socket = ALXD_INVALID_SOCKET;
+    InputSize = 0;
+}
+
+bool writeAll(const char *data, size_t size)
+{
+    int n;
+
+    while (size > 0) {
+        n = ::send(Socket, data, (int) size, 0);
+        if (n <= 0) {
+            disconnect();
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+/*
+    Read one frame, blocking until it is complete. The payload, if any,
+    is copied to 'payload', which holds ALXD_MAX_PAYLOAD bytes.
+*/
+bool readFrame(ALXDframe &frame, char *payload)
+{
+    int n;
+
+    for (;;) {
+        if (InputSize >= sizeof(ALXDframe)) {
+            memcpy(&frame, Input, sizeof(frame));
+            if (frame.size < sizeof(ALXDframe) || frame.size > ALXD_MAX_FRAME) {
+                disconnect();
+                return false;
+            }
+            if (InputSize >= frame.size)
+                break;
+        }
+
+        n = recv(Socket, Input + InputSize, (int)(sizeof(Input) - InputSize), 0);
+        if (n <= 0) {
+            disconnect();
+            return false;
+        }
+        InputSize += n;
+    }
+
+    if (payload) {
+        memcpy(payload, Input + sizeof(ALXDframe), frame.size - sizeof(ALXDframe));
+        if (frame.size == sizeof(ALXDframe))
+            payload[0] = '\0';
+    }
+
+    InputSize -= frame.size;
+    memmove(Input, Input + frame.size, InputSize);
+    return true;
+}
+
+void queueNotification(const ALXDframe &frame)
+{
+    if (NotificationCount == ALXD_MAX_NOTIFICATIONS) {
+        // drop the oldest one
+        NotificationHead = (NotificationHead + 1) % ALXD_MAX_NOTIFICATIONS;
+        NotificationCount--;
+    }
+
+    Notifications[(NotificationHead + NotificationCount) % ALXD_MAX_NOTIFICATIONS] = frame;
+    NotificationCount++;
+}
+
+/*
+    Read frames until the reply to 'serial' arrives. Replies to earlier
+    pipelined requests only report their errors, and notifications are
+    kept for alxdDispatch.
+*/
+bool wait(unsigned int serial, ALXDframe &reply, char *payload)
+{
+    while (Socket != ALXD_INVALID_SOCKET) {
+        if (!readFrame(reply, payload))
+            break;
+
+        if (reply.serial == serial)
+            return true;
+
+        if (reply.serial == 0 && reply.op == ALXD_OP_NOTIFY)
+            queueNotification(reply);
+        else if (reply.status != ALX_NO_ERROR)
+            setError(reply.status);
+
+        if (payload)
+            payload[0] = '\0';
+    }
+
+    return false;
+}
+
+unsigned int post(unsigned short op, unsigned short device, ALXenum param,
+                  ALXint index, ALXint value, const char *text);
+
+bool connect()
+{
+    struct sockaddr_un addr;
+    ALXDframe reply;
+    unsigned int serial;
+
+    if (Socket != ALXD_INVALID_SOCKET)
+        return true;
+
+#if defined(_WIN32)
+    static bool started = false;
+    if (!started) {
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+            return false;
+        started = true;
+    }
+#endif
+
+    alxdSocketPath(&addr);
+    Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (Socket == ALXD_INVALID_SOCKET)
+        return false;
+
+    if (::connect(Socket, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        disconnect();
+        return false;
+    }
+
+    serial = post(ALXD_OP_HELLO, 0, 0, 0, ALXD_PROTOCOL_VERSION, NULL);
+    if (!serial || !wait(serial, reply, NULL) || reply.value != ALXD_PROTOCOL_VERSION) {
+        disconnect();
+        return false;
+    }
+
+    return true;
+}
+
+/*
+    Send a request without waiting for its reply. Returns its serial,
+    or 0 when the daemon cannot be reached.
+*/
+unsigned int post(unsigned short op, unsigned short device, ALXenum param,
+                  ALXint index, ALXint value, const char *text)
+{
+    char frame[ALXD_MAX_FRAME];
+    ALXDframe header;
+    size_t len = text ? strlen(text) + 1 : 0;
+
+    if (op != ALXD_OP_HELLO && !connect())
+        return 0;
+
+    if (len > ALXD_MAX_PAYLOAD)
+        return 0;
+
+    if (++Serial == 0)
+        ++Serial;
+
+    header.size = (unsigned int)(sizeof(ALXDframe) + len);
+    header.serial = Serial;
+    header.op = op;
+    header.device = device;
+    header.param = param;
+    header.index = index;
+    header.value = value;
+    header.status = ALX_NO_ERROR;
+
+    memcpy(frame, &header, sizeof(header));
+    if (len)
+        memcpy(frame + sizeof(header), text, len);
+
+    if (!writeAll(frame, header.size))
+        return 0;
+
+    return Serial;
+}
+
+/*
+    Send a request and wait for its reply, recording its error.
+*/
+bool request(unsigned short op, unsigned short device, ALXenum param, ALXint index,
+             ALXint value, const char *text, ALXDframe &reply, char *payload)
+{
+    unsigned int serial;
+
+    serial = post(op, device, param, index, value, text);
+    if (!serial || !wait(serial, reply, payload)) {
+        setError(ALX_INVALID_DEVICE);
+        return false;
+    }
+
+    if (reply.status != ALX_NO_ERROR)
+        setError(reply.status);
+    return true;
+}
+
+void set(ALXdevice *pMixer, unsigned short op, ALXenum param, ALXint index, ALXint value)
+{
+    if (pMixer) {
+        if (!post(op, pMixer->handle, param, index, value, NULL))
+            setError(ALX_INVALID_DEVICE);
+    }
+    else {
+        setError(ALX_INVALID_DEVICE);
+    }
+}
+
+ALXint get(ALXdevice *pMixer, unsigned short op, ALXenum param, ALXint index, ALXint fallback)
+{
+    ALXDframe reply;
+
+    if (pMixer == NULL) {
+        setError(ALX_INVALID_DEVICE);
+        return fallback;
+    }
+
+    if (!request(op, pMixer->handle, param, index, 0, NULL, reply, NULL)
+        || reply.status != ALX_NO_ERROR)
+        return fallback;
+
+    return reply.value;
+}
+
+/*
+    Send a request and wait for its reply, returning its status instead
+    of recording it.
+*/
+ALXenum call(ALXdevice *pMixer, unsigned short op, ALXenum param, ALXint index,
+             ALXint value, ALXint *result)
+{
+    ALXDframe reply;
+    unsigned int serial;
+
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+
+    serial = post(op, pMixer->handle, param, index, value, NULL);
+    if (!serial || !wait(serial, reply, NULL))
+        return ALX_INVALID_DEVICE;
+
+    if (reply.status == ALX_NO_ERROR && result)
+        *result = reply.value;
+    return (ALXenum) reply.status;
+}
+
+ALXenum getVolume(ALXdevice *pMixer, unsigned short op, ALXenum param, ALXint index,
+                  ALXfloat *value)
+{
+    ALXint bits;
+    ALXenum status;
+
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+
+    status = call(pMixer, op, param, index, 0, &bits);
+    if (status == ALX_NO_ERROR) {
+        if (alxdBitsFloat(bits) < 0.0f)
+            return ALX_INVALID_OPERATION;
+        *value = alxdBitsFloat(bits);
+    }
+    return status;
+}
+
+ALXenum getFlag(ALXdevice *pMixer, unsigned short op, ALXenum param, ALXint index,
+                ALXboolean *value)
+{
+    ALXint flag;
+    ALXenum status;
+
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+
+    status = call(pMixer, op, param, index, 0, &flag);
+    if (status == ALX_NO_ERROR)
+        *value = (ALXboolean) flag;
+    return status;
+}
+
+ALXdevice *open(unsigned short op, const ALXchar *name)
+{
+    ALXDframe reply;
+    ALXdevice *pMixer;
+
+    if (name == NULL) {
+        setError(ALX_INVALID_DEVICE);
+        return NULL;
+    }
+
+    if (!request(op, 0, 0, 0, 0, name, reply, NULL) || reply.device == 0)
+        return NULL;
+
+    void *block = AllocFunc(sizeof(ALXdevice), AllocData);
+    if (block == NULL) {
+        (void) post(ALXD_OP_CLOSE_DEVICE, reply.device, 0, 0, 0, NULL);
+        setError(ALX_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    pMixer = new (block) ALXdevice(AllocFunc, FreeFunc, AllocData);
+    pMixer->handle = reply.device;
+    pMixer->next = Devices;
+    Devices = pMixer;
+    return pMixer;
+}
+
+const ALXchar *getName(ALXdevice *pMixer, unsigned short op, ALXenum param, ALXint index)
+{
+    char payload[ALXD_MAX_PAYLOAD];
+    ALXDframe reply;
+    ALXname *name;
+
+    for (name = pMixer->names; name; name = name->next) {
+        if (name->param == param && name->index == index)
+            return name->name;
+    }
+
+    if (!request(op, pMixer->handle, param, index, 0, NULL, reply, payload)
+        || reply.status != ALX_NO_ERROR || reply.size == sizeof(ALXDframe))
+        return NULL;
+
+    size_t size = strlen(payload) + 1;
+    name = (ALXname *) pMixer->allocFunc(sizeof(ALXname) + size, pMixer->allocData);
+    if (name == NULL) {
+        setError(ALX_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    name->param = param;
+    name->index = index;
+    name->name = reinterpret_cast<ALXchar *>(name + 1);
+    memcpy(name->name, payload, size);
+    name->next = pMixer->names;
+    pMixer->names = name;
+    return name->name;
+}
+
+void dispatch(const ALXDframe &frame)
+{
+    ALXdevice *pMixer;
+    ALXenum kind;
+    ALXfloat value;
+
+    switch (frame.status) {
+    case ALXD_OP_GET_FLOAT:             kind = ALXD_KIND_FLOAT;           break;
+    case ALXD_OP_GET_BOOLEAN:           kind = ALXD_KIND_BOOLEAN;         break;
+    case ALXD_OP_GET_INTEGER:           kind = ALXD_KIND_INTEGER;         break;
+    case ALXD_OP_GET_INDEXED_FLOAT:     kind = ALXD_KIND_INDEXED_FLOAT;   break;
+    case ALXD_OP_GET_INDEXED_BOOLEAN:   kind = ALXD_KIND_INDEXED_BOOLEAN; break;
+    default:                            return;
+    }
+
+    if (kind == ALXD_KIND_FLOAT || kind == ALXD_KIND_INDEXED_FLOAT)
+        value = alxdBitsFloat(frame.value);
+    else
+        value = (ALXfloat) frame.value;
+
+    for (pMixer = Devices; pMixer; pMixer = pMixer->next) {
+        if (pMixer->handle == frame.device && pMixer->callback)
+            pMixer->callback(pMixer, kind, frame.param, frame.index, value, pMixer->userdata);
+    }
+}
+
+bool readable(ALXint timeout)
+{
+    fd_set set;
+    struct timeval tv;
+
+    if (InputSize > 0)
+        return true;
+
+    FD_ZERO(&set);
+    FD_SET(Socket, &set);
+    tv.tv_sec = timeout / 1000;
+    tv.tv_usec = (timeout % 1000) * 1000;
+
+    return select((int) Socket + 1, &set, NULL, NULL, timeout < 0 ? NULL : &tv) > 0;
+}
+
+} // namespace alxd
+
+/*
+    Level analysis needs no device, so the kernels are built in, and
+    report their errors and take their memory here.
+*/
+namespace alx {
+
+void setError(ALXenum errorCode)
+{
+    alxd::setError(errorCode);
+}
+
+void *allocate(size_t size, LPALXFREE *freeFunc, void **data)
+{
+    *freeFunc = alxd::FreeFunc;
+    *data = alxd::AllocData;
+    return alxd::AllocFunc(size, alxd::AllocData);
+}
+
+} // namespace alx
+
+///////////////////////////////////////////////////////
+// ALMix Functions calls
+
+#define ALXAPI
+#define ALXAPIENTRY
+
+extern "C" {
+
+ALXAPI ALXdevice * ALXAPIENTRY alxOpenDevice(const ALXchar *devicename)
+{
+    return alxd::open(ALXD_OP_OPEN_DEVICE, devicename);
+}
+
+
+ALXAPI ALXdevice * ALXAPIENTRY alxOpenCaptureDevice(const ALXchar *devicename)
+{
+    return alxd::open(ALXD_OP_OPEN_CAPTURE_DEVICE, devicename);
+}
+
+
+ALXAPI ALXdevice * ALXAPIENTRY alxMapDevice(ALCdevice *pDevice)
+{
+    if (pDevice == NULL) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return NULL;
+    }
+
+    return alxd::open(ALXD_OP_MAP_DEVICE,
+        alcGetString(pDevice, ALC_DEVICE_SPECIFIER));
+}
+
+
+ALXAPI ALXdevice * ALXAPIENTRY alxMapCaptureDevice(ALCdevice *pDevice)
+{
+    if (pDevice == NULL) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return NULL;
+    }
+
+    return alxd::open(ALXD_OP_MAP_CAPTURE_DEVICE,
+        alcGetString(pDevice, ALC_CAPTURE_DEVICE_SPECIFIER));
+}
+
+
+ALXAPI void ALXAPIENTRY alxCloseDevice(ALXdevice *pMixer)
+{
+    ALXdevice **link;
+
+    if (pMixer == NULL)
+        return;
+
+    alx::forgetDevice(pMixer);
+    for (link = &alxd::Devices; *link; link = &(*link)->next) {
+        if (*link == pMixer) {
+            *link = pMixer->next;
+            break;
+        }
+    }
+
+    (void) alxd::post(ALXD_OP_CLOSE_DEVICE, pMixer->handle, 0, 0, 0, NULL);
+
+    LPALXFREE freeFunc = pMixer->freeFunc;
+    void *allocData = pMixer->allocData;
+    pMixer->~ALXdevice();
+    freeFunc(pMixer, allocData);
+}
+
+
+ALXAPI ALXfloat ALXAPIENTRY alxGetFloat(ALXdevice *pMixer, ALXenum param)
+{
+    return alxdBitsFloat(alxd::get(pMixer, ALXD_OP_GET_FLOAT,
+        param, 0, alxdFloatBits(-1.0f)));
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetFloat(ALXdevice *pMixer, ALXenum param, ALXfloat value)
+{
+    alxd::set(pMixer, ALXD_OP_SET_FLOAT, param, 0, alxdFloatBits(value));
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxGetBoolean(ALXdevice *pMixer, ALXenum param)
+{
+    return (ALXboolean) alxd::get(pMixer, ALXD_OP_GET_BOOLEAN, param, 0, ALX_FALSE);
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetBoolean(ALXdevice *pMixer, ALXenum param, ALXboolean value)
+{
+    alxd::set(pMixer, ALXD_OP_SET_BOOLEAN, param, 0, value);
+}
+
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetString(ALXdevice *pMixer, ALXenum param)
+{
+    ALXchar *list;
+    ALXDframe reply;
+
+    if (pMixer)
+        return alxd::getName(pMixer, ALXD_OP_GET_STRING, param, -1);
+
+    switch (param)
+    {
+    case ALX_DEVICE_SPECIFIER:
+        list = alxd::DeviceList;
+        break;
+
+    case ALX_CAPTURE_DEVICE_SPECIFIER:
+        list = alxd::CaptureDeviceList;
+        break;
+
+    default:
+        alxd::setError(ALX_INVALID_ENUM);
+        return NULL;
+    }
+
+    if (!alxd::request(ALXD_OP_GET_STRING, 0, param, 0, 0, NULL, reply, list)
+        || reply.status != ALX_NO_ERROR) {
+        list[0] = '\0';
+        list[1] = '\0';
+        return NULL;
+    }
+
+    return list;
+}
+
+
+ALXAPI ALXint ALXAPIENTRY alxGetInteger(ALXdevice *pMixer, ALXenum param)
+{
+    if (pMixer == NULL && param == ALX_LEVEL_ISA)
+        return alx::levelISA();
+
+    if (pMixer) {
+        switch (param) {
+        case ALX_QUEUE_SIZE:
+            return pMixer->queue ? pMixer->queue->capacity() : 0;
+        case ALX_QUEUE_PENDING:
+            return pMixer->queue ? pMixer->queue->pending() : 0;
+        case ALX_QUEUE_DROPPED:
+            return pMixer->queue ? pMixer->queue->dropped() : 0;
+        case ALX_QUEUE_OVERFLOW:
+            return pMixer->queue ? pMixer->queue->policy() : ALX_QUEUE_DROP_NEWEST;
+        }
+    }
+
+    return alxd::get(pMixer, ALXD_OP_GET_INTEGER, param, 0, -1);
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetInteger(ALXdevice *pMixer, ALXenum param, ALXint value)
+{
+    if (pMixer == NULL && param == ALX_LEVEL_ISA) {
+        if (!alx::setLevelISA(value))
+            alxd::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    if (pMixer) {
+        switch (param) {
+        case ALX_QUEUE_SIZE:
+            if (!pMixer->setQueueSize(value))
+                alxd::setError(ALX_OUT_OF_MEMORY);
+            return;
+        case ALX_QUEUE_OVERFLOW:
+            if (value != ALX_QUEUE_DROP_NEWEST && value != ALX_QUEUE_DROP_OLDEST)
+                alxd::setError(ALX_INVALID_VALUE);
+            else if (pMixer->queue)
+                pMixer->queue->setPolicy(value);
+            else
+                alxd::setError(ALX_INVALID_OPERATION);
+            return;
+        }
+    }
+
+    alxd::set(pMixer, ALXD_OP_SET_INTEGER, param, 0, value);
+}
+
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetIndexedString(ALXdevice *pMixer, ALXenum param, ALXint index)
+{
+    if (pMixer == NULL) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return NULL;
+    }
+
+    return alxd::getName(pMixer, ALXD_OP_GET_INDEXED_STRING, param, index);
+}
+
+
+ALXAPI ALXfloat ALX_APIENTRY alxGetIndexedFloat(ALXdevice *pMixer, ALXenum param, ALXint index)
+{
+    return alxdBitsFloat(alxd::get(pMixer, ALXD_OP_GET_INDEXED_FLOAT,
+        param, index, alxdFloatBits(-1.0f)));
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxGetIndexedBoolean(ALXdevice *pMixer, ALXenum param, ALXint index)
+{
+    return (ALXboolean) alxd::get(pMixer, ALXD_OP_GET_INDEXED_BOOLEAN, param, index, ALX_FALSE);
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetIndexedFloat(ALXdevice *pMixer, ALXenum param, ALXint index, ALXfloat value)
+{
+    alxd::set(pMixer, ALXD_OP_SET_INDEXED_FLOAT, param, index, alxdFloatBits(value));
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetIndexedBoolean(ALXdevice *pMixer, ALXenum param, ALXint index, ALXboolean value)
+{
+    alxd::set(pMixer, ALXD_OP_SET_INDEXED_BOOLEAN, param, index, value);
+}
+
+
+/*
+    Typed access
+
+    Unlike the setters above, the typed ones wait for the daemon, since
+    they return its status.
+*/
+ALXAPI ALXenum ALXAPIENTRY alxGetMasterVolume(ALXdevice *pMixer, ALXfloat *value)
+{
+    return alxd::getVolume(pMixer, ALXD_OP_GET_FLOAT, ALX_MASTER_VOLUME, 0, value);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetMasterVolume(ALXdevice *pMixer, ALXfloat value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_FLOAT, ALX_MASTER_VOLUME, 0, alxdFloatBits(value), NULL);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetMasterMute(ALXdevice *pMixer, ALXboolean *value)
+{
+    return alxd::getFlag(pMixer, ALXD_OP_GET_BOOLEAN, ALX_MASTER_VOLUME, 0, value);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetMasterMute(ALXdevice *pMixer, ALXboolean value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_BOOLEAN, ALX_MASTER_VOLUME, 0, value, NULL);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetPCMOutputVolume(ALXdevice *pMixer, ALXfloat *value)
+{
+    return alxd::getVolume(pMixer, ALXD_OP_GET_FLOAT, ALX_PCM_OUTPUT_VOLUME, 0, value);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetPCMOutputVolume(ALXdevice *pMixer, ALXfloat value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_FLOAT, ALX_PCM_OUTPUT_VOLUME, 0, alxdFloatBits(value), NULL);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetPCMOutputMute(ALXdevice *pMixer, ALXboolean *value)
+{
+    return alxd::getFlag(pMixer, ALXD_OP_GET_BOOLEAN, ALX_PCM_OUTPUT_VOLUME, 0, value);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetPCMOutputMute(ALXdevice *pMixer, ALXboolean value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_BOOLEAN, ALX_PCM_OUTPUT_VOLUME, 0, value, NULL);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetInputVolume(ALXdevice *pMixer, ALXfloat *value)
+{
+    return alxd::getVolume(pMixer, ALXD_OP_GET_FLOAT, ALX_INPUT_VOLUME, 0, value);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetInputVolume(ALXdevice *pMixer, ALXfloat value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_FLOAT, ALX_INPUT_VOLUME, 0, alxdFloatBits(value), NULL);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetInputSource(ALXdevice *pMixer, ALXint *value)
+{
+    ALXint source;
+    ALXenum status;
+
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+
+    status = alxd::call(pMixer, ALXD_OP_GET_INTEGER, ALX_INPUT_SOURCE, 0, 0, &source);
+    if (status == ALX_NO_ERROR) {
+        if (source < 0)
+            return ALX_INVALID_OPERATION;
+        *value = source;
+    }
+    return status;
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetInputSource(ALXdevice *pMixer, ALXint value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_INTEGER, ALX_INPUT_SOURCE, 0, value, NULL);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetOutputVolume(ALXdevice *pMixer, ALXint index, ALXfloat *value)
+{
+    return alxd::getVolume(pMixer, ALXD_OP_GET_INDEXED_FLOAT, ALX_OUTPUT_VOLUME, index, value);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetOutputVolume(ALXdevice *pMixer, ALXint index, ALXfloat value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_INDEXED_FLOAT, ALX_OUTPUT_VOLUME, index,
+        alxdFloatBits(value), NULL);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetOutputMute(ALXdevice *pMixer, ALXint index, ALXboolean *value)
+{
+    return alxd::getFlag(pMixer, ALXD_OP_GET_INDEXED_BOOLEAN, ALX_OUTPUT_VOLUME, index, value);
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetOutputMute(ALXdevice *pMixer, ALXint index, ALXboolean value)
+{
+    return alxd::call(pMixer, ALXD_OP_SET_INDEXED_BOOLEAN, ALX_OUTPUT_VOLUME, index, value, NULL);
+}
+
+ALXAPI ALXint ALXAPIENTRY alxGetOutputCount(ALXdevice *pMixer)
+{
+    ALXint count = 0;
+
+    alxd::call(pMixer, ALXD_OP_GET_INTEGER, ALX_OUTPUT_VOLUME_SPECIFIER, 0, 0, &count);
+    return count;
+}
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetOutputName(ALXdevice *pMixer, ALXint index)
+{
+    if (pMixer == NULL)
+        return NULL;
+    return alxd::getName(pMixer, ALXD_OP_GET_INDEXED_STRING, ALX_OUTPUT_VOLUME_SPECIFIER, index);
+}
+
+ALXAPI ALXint ALXAPIENTRY alxGetInputSourceCount(ALXdevice *pMixer)
+{
+    ALXint count = 0;
+
+    alxd::call(pMixer, ALXD_OP_GET_INTEGER, ALX_INPUT_SOURCE_SPECIFIER, 0, 0, &count);
+    return count;
+}
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetInputSourceName(ALXdevice *pMixer, ALXint index)
+{
+    if (pMixer == NULL)
+        return NULL;
+    return alxd::getName(pMixer, ALXD_OP_GET_INDEXED_STRING, ALX_INPUT_SOURCE_SPECIFIER, index);
+}
+
+
+/*
+    alxSetTopologyCache
+
+    The daemon owns the devices, and so their topology cache; it is set
+    on its command line.
+*/
+ALXAPI void ALXAPIENTRY alxSetTopologyCache(const ALXchar *filename)
+{
+    (void) filename;
+}
+
+
+/*
+    alxSetAllocator
+
+    Devices and the names cached for them use the given functions; NULL
+    restores malloc and free
+*/
+ALXAPI void ALXAPIENTRY alxSetAllocator(LPALXALLOC allocFunc, LPALXFREE freeFunc, void *userdata)
+{
+    if (allocFunc != NULL && freeFunc != NULL) {
+        alxd::AllocFunc = allocFunc;
+        alxd::FreeFunc = freeFunc;
+        alxd::AllocData = userdata;
+    }
+    else {
+        alxd::AllocFunc = alxd::defaultAlloc;
+        alxd::FreeFunc = alxd::defaultFree;
+        alxd::AllocData = NULL;
+    }
+}
+
+
+/*
+    alxGetChangesSince
+
+    The daemon keeps the change log of its devices; clients follow
+    changes with alxdSubscribe instead.
+*/
+ALXAPI ALXint ALXAPIENTRY alxGetChangesSince(ALXdevice *pMixer, ALXint generation, ALXchange *changes, ALXint count)
+{
+    (void) pMixer; (void) generation; (void) changes; (void) count;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return -1;
+}
+
+
+/*
+    alxPublishSharedState
+
+    Only the daemon publishes its devices (alxd -s name); the segment is
+    read with the functions below.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxPublishSharedState(const ALXchar *name)
+{
+    (void) name;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return ALX_FALSE;
+}
+
+
+/*
+    alxAttachSharedState, alxReadSharedDevice, alxDetachSharedState
+
+    Same as in ALx, which shares the code.
+*/
+ALXAPI const ALXsharedState * ALXAPIENTRY alxAttachSharedState(const ALXchar *name)
+{
+    return alx::attachSharedState(name);
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxReadSharedDevice(const ALXsharedState *state, ALXint index, ALXsharedDevice *values)
+{
+    return alx::readSharedDevice(state, index, values) ? ALX_TRUE : ALX_FALSE;
+}
+
+
+ALXAPI void ALXAPIENTRY alxDetachSharedState(const ALXsharedState *state)
+{
+    alx::detachSharedState(state);
+}
+
+
+/*
+    alxStartTrace, alxStopTrace, alxStartEventTrace, alxStopEventTrace
+
+    The driver is called by the daemon, which is traced with alxd -t
+    and -e.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxStartTrace(const ALXchar *filename, ALXint records)
+{
+    (void) filename; (void) records;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return ALX_FALSE;
+}
+
+
+ALXAPI void ALXAPIENTRY alxStopTrace()
+{
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxStartEventTrace(const ALXchar *filename)
+{
+    (void) filename;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return ALX_FALSE;
+}
+
+
+ALXAPI void ALXAPIENTRY alxStopEventTrace()
+{
+}
+
+
+/*
+    alxQueueFloat, alxQueueBoolean
+
+    Queue a set command without blocking; realtime safe. The commands
+    reach the daemon when the control thread calls alxProcessQueue.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxQueueFloat(ALXdevice *pMixer, ALXenum param, ALXint index, ALXfloat value)
+{
+    alx::Command command;
+
+    if (pMixer == NULL || pMixer->queue == NULL)
+        return ALX_FALSE;
+
+    command.param = param;
+    command.index = index;
+    command.isFloat = ALX_TRUE;
+    command.value = value;
+
+    return pMixer->queue->push(command) ? ALX_TRUE : ALX_FALSE;
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxQueueBoolean(ALXdevice *pMixer, ALXenum param, ALXint index, ALXboolean value)
+{
+    alx::Command command;
+
+    if (pMixer == NULL || pMixer->queue == NULL)
+        return ALX_FALSE;
+
+    command.param = param;
+    command.index = index;
+    command.isFloat = ALX_FALSE;
+    command.value = value ? 1.0f : 0.0f;
+
+    return pMixer->queue->push(command) ? ALX_TRUE : ALX_FALSE;
+}
+
+
+/*
+    alxProcessQueue
+
+    Forward every queued command to the daemon, returning how many were
+    sent. Like any other set, they are not waited for.
+*/
+ALXAPI ALXint ALXAPIENTRY alxProcessQueue(ALXdevice *pMixer)
+{
+    alx::Command command;
+    ALXint count = 0;
+
+    if (pMixer == NULL) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return 0;
+    }
+
+    if (pMixer->queue == NULL)
+        return 0;
+
+    while (pMixer->queue->pop(command)) {
+        if (command.isFloat) {
+            if (command.index < 0)
+                alxSetFloat(pMixer, command.param, command.value);
+            else
+                alxSetIndexedFloat(pMixer, command.param, command.index, command.value);
+        }
+        else {
+            ALXboolean flag = command.value != 0.0f ? ALX_TRUE : ALX_FALSE;
+            if (command.index < 0)
+                alxSetBoolean(pMixer, command.param, flag);
+            else
+                alxSetIndexedBoolean(pMixer, command.param, command.index, flag);
+        }
+        ++count;
+    }
+
+    return count;
+}
+
+
+/*
+    alxGetPollDescriptors
+
+    Notifications come over the daemon socket, shared by every device.
+*/
+ALXAPI ALXint ALXAPIENTRY alxGetPollDescriptors(ALXdevice *pMixer, ALXpollfd *fds, ALXint count)
+{
+    if (pMixer == NULL || alxd::Socket == ALXD_INVALID_SOCKET) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return 0;
+    }
+
+    if (count < 0 || (count > 0 && fds == NULL)) {
+        alxd::setError(ALX_INVALID_VALUE);
+        return 0;
+    }
+
+    if (count > 0) {
+        fds[0].fd = (ALXint) alxd::Socket;
+        fds[0].handle = NULL;
+        fds[0].events = ALX_POLL_IN;
+    }
+
+    return 1;
+}
+
+
+/*
+    alxProcessEvents
+
+    Calls the alxdSubscribe callbacks of every device, then forwards
+    the command queue.
+*/
+ALXAPI ALXint ALXAPIENTRY alxProcessEvents(ALXdevice *pMixer)
+{
+    if (pMixer == NULL) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return 0;
+    }
+
+    return alxdDispatch(0) + alxProcessQueue(pMixer);
+}
+
+
+/*
+    Buses
+
+    Sources belong to the OpenAL contexts of the calling process, which
+    the daemon cannot reach; link against ALx to use buses.
+*/
+ALXAPI ALXint ALXAPIENTRY alxGenBus(ALXdevice *pMixer, ALXint parent)
+{
+    (void) pMixer; (void) parent;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return 0;
+}
+
+ALXAPI void ALXAPIENTRY alxDeleteBus(ALXdevice *pMixer, ALXint bus)
+{
+    (void) pMixer; (void) bus;
+    alxd::setError(ALX_INVALID_OPERATION);
+}
+
+ALXAPI void ALXAPIENTRY alxAttachSource(ALXdevice *pMixer, ALXint bus, ALXuint source)
+{
+    (void) pMixer; (void) bus; (void) source;
+    alxd::setError(ALX_INVALID_OPERATION);
+}
+
+ALXAPI void ALXAPIENTRY alxDetachSource(ALXdevice *pMixer, ALXuint source)
+{
+    (void) pMixer; (void) source;
+    alxd::setError(ALX_INVALID_OPERATION);
+}
+
+
+/*
+    Capture tap
+
+    The daemon only has the mixer; the capture device is the client's.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxSetCaptureTap(ALXdevice *pMixer, ALXenum format, ALXint frames, ALXint window)
+{
+    (void) pMixer; (void) format; (void) frames; (void) window;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return ALX_FALSE;
+}
+
+ALXAPI ALXint ALXAPIENTRY alxPumpCaptureTap(ALXdevice *pMixer)
+{
+    (void) pMixer;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return 0;
+}
+
+ALXAPI ALXuint ALXAPIENTRY alxGetCapturePosition(ALXdevice *pMixer)
+{
+    (void) pMixer;
+    return 0;
+}
+
+ALXAPI const void * ALXAPIENTRY alxGetCaptureWindow(ALXdevice *pMixer, ALXuint position, ALXint frames)
+{
+    (void) pMixer; (void) position; (void) frames;
+    return NULL;
+}
+
+ALXAPI ALXboolean ALXAPIENTRY alxIsCaptureWindowValid(ALXdevice *pMixer, ALXuint position)
+{
+    (void) pMixer; (void) position;
+    return ALX_FALSE;
+}
+
+ALXAPI ALXboolean ALXAPIENTRY alxSetCaptureDucker(ALXdevice *pMixer, ALXducker *ducker)
+{
+    (void) pMixer; (void) ducker;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return ALX_FALSE;
+}
+
+
+/*
+    alxProcessTone
+
+    The software tone filter lives with the daemon's device, which
+    cannot reach the client's blocks.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxProcessTone(ALXdevice *pMixer, ALXenum type, ALXint channels, ALXint rate,
+                                             void *samples, ALXint frames)
+{
+    (void) pMixer; (void) type; (void) channels; (void) rate; (void) samples; (void) frames;
+    alxd::setError(ALX_INVALID_OPERATION);
+    return ALX_FALSE;
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxdSubscribe(ALXdevice *pMixer, LPALXDNOTIFY callback, void *userdata)
+{
+    ALXdevice *other;
+    ALXDframe reply;
+    bool shared = false;
+
+    if (pMixer == NULL) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return ALX_FALSE;
+    }
+
+    for (other = alxd::Devices; other; other = other->next) {
+        if (other != pMixer && other->handle == pMixer->handle && other->callback)
+            shared = true;
+    }
+
+    pMixer->callback = callback;
+    pMixer->userdata = userdata;
+
+    if (shared)
+        return ALX_TRUE;
+
+    if (!alxd::request(callback ? ALXD_OP_SUBSCRIBE : ALXD_OP_UNSUBSCRIBE,
+                       pMixer->handle, 0, 0, 0, NULL, reply, NULL))
+        return ALX_FALSE;
+
+    return reply.status == ALX_NO_ERROR ? ALX_TRUE : ALX_FALSE;
+}
+
+
+ALXAPI ALXint ALXAPIENTRY alxdDispatch(ALXint timeout)
+{
+    ALXDframe frame;
+    ALXint count = 0;
+
+    // only block while there is nothing to dispatch yet
+    while (alxd::Socket != ALXD_INVALID_SOCKET
+           && alxd::readable(alxd::NotificationCount ? 0 : timeout)) {
+        if (!alxd::readFrame(frame, NULL))
+            break;
+
+        if (frame.serial == 0 && frame.op == ALXD_OP_NOTIFY)
+            alxd::queueNotification(frame);
+        else if (frame.status != ALX_NO_ERROR)
+            alxd::setError(frame.status);
+    }
+
+    while (alxd::NotificationCount) {
+        frame = alxd::Notifications[alxd::NotificationHead];
+        alxd::NotificationHead = (alxd::NotificationHead + 1) % ALXD_MAX_NOTIFICATIONS;
+        alxd::NotificationCount--;
+
+        alxd::dispatch(frame);
+        ++count;
+    }
+
+    return count;
+}
+
+
+ALXAPI void ALXAPIENTRY alxGetIntegerv(ALXdevice *pMixer, ALXenum param, ALXint index, ALXint *values)
+{
+    ALXDframe reply;
+
+    if (pMixer == NULL) {
+        alxd::setError(ALX_INVALID_DEVICE);
+        return;
+    }
+
+    if (values == NULL) {
+        alxd::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    if (alxd::request(ALXD_OP_GET_INTEGERV, pMixer->handle, param, index, 0, NULL, reply, NULL)
+        && reply.status == ALX_NO_ERROR)
+        values[0] = reply.value;
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetIntegerv(ALXdevice *pMixer, ALXenum param, ALXint index, const ALXint *values)
+{
+    if (values == NULL) {
+        alxd::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    alxd::set(pMixer, ALXD_OP_SET_INTEGERV, param, index, values[0]);
+}
+
+
+/*
+    alxGetProcAddress
+
+    Retrieves the function address for a particular extension function
+*/
+ALXAPI void * ALXAPIENTRY alxGetProcAddress(ALXdevice *device, const ALXchar *funcName)
+{
+    static const struct {
+        const ALXchar *funcName;
+        void *address;
+    } Functions[] = {
+        { "alxOpenDevice",                (void *) alxOpenDevice              },
+        { "alxOpenCaptureDevice",         (void *) alxOpenCaptureDevice       },
+        { "alxMapDevice",                 (void *) alxMapDevice               },
+        { "alxMapCaptureDevice",          (void *) alxMapCaptureDevice        },
+        { "alxCloseDevice",               (void *) alxCloseDevice             },
+        { "alxGetFloat",                  (void *) alxGetFloat                },
+        { "alxSetFloat",                  (void *) alxSetFloat                },
+        { "alxGetBoolean",                (void *) alxGetBoolean              },
+        { "alxSetBoolean",                (void *) alxSetBoolean              },
+        { "alxGetString",                 (void *) alxGetString               },
+        { "alxGetInteger",                (void *) alxGetInteger              },
+        { "alxSetInteger",                (void *) alxSetInteger              },
+        { "alxGetIndexedString",          (void *) alxGetIndexedString        },
+        { "alxGetIndexedFloat",           (void *) alxGetIndexedFloat         },
+        { "alxGetIndexedBoolean",         (void *) alxGetIndexedBoolean       },
+        { "alxSetIndexedFloat",           (void *) alxSetIndexedFloat         },
+        { "alxSetIndexedBoolean",         (void *) alxSetIndexedBoolean       },
+        { "alxGetError",                  (void *) alxGetError                },
+        { "alxSetTopologyCache",          (void *) alxSetTopologyCache        },
+        { "alxQueueFloat",                (void *) alxQueueFloat              },
+        { "alxQueueBoolean",              (void *) alxQueueBoolean            },
+        { "alxProcessQueue",              (void *) alxProcessQueue            },
+        { "alxGetPollDescriptors",        (void *) alxGetPollDescriptors      },
+        { "alxProcessEvents",             (void *) alxProcessEvents           },
+        { "alxGenBus",                    (void *) alxGenBus                  },
+        { "alxDeleteBus",                 (void *) alxDeleteBus               },
+        { "alxAttachSource",              (void *) alxAttachSource            },
+        { "alxDetachSource",              (void *) alxDetachSource            },
+        { "alxSetCaptureTap",             (void *) alxSetCaptureTap           },
+        { "alxPumpCaptureTap",            (void *) alxPumpCaptureTap          },
+        { "alxGetCapturePosition",        (void *) alxGetCapturePosition      },
+        { "alxGetCaptureWindow",          (void *) alxGetCaptureWindow        },
+        { "alxIsCaptureWindowValid",      (void *) alxIsCaptureWindowValid    },
+        { "alxMeasureLevels",             (void *) alxMeasureLevels           },
+        { "alxCreateLoudnessMeter",       (void *) alxCreateLoudnessMeter     },
+        { "alxDeleteLoudnessMeter",       (void *) alxDeleteLoudnessMeter     },
+        { "alxResetLoudnessMeter",        (void *) alxResetLoudnessMeter      },
+        { "alxAddLoudnessSamples",        (void *) alxAddLoudnessSamples      },
+        { "alxGetLoudness",               (void *) alxGetLoudness             },
+        { "alxSetLoudnessTarget",         (void *) alxSetLoudnessTarget       },
+        { "alxCreateDucker",              (void *) alxCreateDucker            },
+        { "alxDeleteDucker",              (void *) alxDeleteDucker            },
+        { "alxAddDuckTarget",             (void *) alxAddDuckTarget           },
+        { "alxRemoveDuckTargets",         (void *) alxRemoveDuckTargets       },
+        { "alxGetDuckerFloat",            (void *) alxGetDuckerFloat          },
+        { "alxSetDuckerFloat",            (void *) alxSetDuckerFloat          },
+        { "alxProcessDucker",             (void *) alxProcessDucker           },
+        { "alxSetCaptureDucker",          (void *) alxSetCaptureDucker        },
+        { "alxProcessTone",               (void *) alxProcessTone             },
+        { "alxCreateEnvelope",            (void *) alxCreateEnvelope          },
+        { "alxDeleteEnvelope",            (void *) alxDeleteEnvelope          },
+        { "alxAddEnvelopePoint",          (void *) alxAddEnvelopePoint        },
+        { "alxClearEnvelope",             (void *) alxClearEnvelope           },
+        { "alxGetEnvelopeGain",           (void *) alxGetEnvelopeGain         },
+        { "alxProcessEnvelope",           (void *) alxProcessEnvelope         },
+        { "alxSetEnvelopeTarget",         (void *) alxSetEnvelopeTarget       },
+        { "alxAdvanceEnvelope",           (void *) alxAdvanceEnvelope         },
+        { "alxSetAllocator",              (void *) alxSetAllocator            },
+        { "alxGetChangesSince",           (void *) alxGetChangesSince         },
+        { "alxPublishSharedState",        (void *) alxPublishSharedState      },
+        { "alxAttachSharedState",         (void *) alxAttachSharedState       },
+        { "alxReadSharedDevice",          (void *) alxReadSharedDevice        },
+        { "alxDetachSharedState",         (void *) alxDetachSharedState       },
+        { "alxStartTrace",                (void *) alxStartTrace              },
+        { "alxStopTrace",                 (void *) alxStopTrace               },
+        { "alxStartEventTrace",           (void *) alxStartEventTrace         },
+        { "alxStopEventTrace",            (void *) alxStopEventTrace          },
+        { "alxGetMasterVolume",           (void *) alxGetMasterVolume         },
+        { "alxSetMasterVolume",           (void *) alxSetMasterVolume         },
+        { "alxGetMasterMute",             (void *) alxGetMasterMute           },
+        { "alxSetMasterMute",             (void *) alxSetMasterMute           },
+        { "alxGetPCMOutputVolume",        (void *) alxGetPCMOutputVolume      },
+        { "alxSetPCMOutputVolume",        (void *) alxSetPCMOutputVolume      },
+        { "alxGetPCMOutputMute",          (void *) alxGetPCMOutputMute        },
+        { "alxSetPCMOutputMute",          (void *) alxSetPCMOutputMute        },
+        { "alxGetInputVolume",            (void *) alxGetInputVolume          },
+        { "alxSetInputVolume",            (void *) alxSetInputVolume          },
+        { "alxGetInputSource",            (void *) alxGetInputSource          },
+        { "alxSetInputSource",            (void *) alxSetInputSource          },
+        { "alxGetOutputVolume",           (void *) alxGetOutputVolume         },
+        { "alxSetOutputVolume",           (void *) alxSetOutputVolume         },
+        { "alxGetOutputMute",             (void *) alxGetOutputMute           },
+        { "alxSetOutputMute",             (void *) alxSetOutputMute           },
+        { "alxGetOutputCount",            (void *) alxGetOutputCount          },
+        { "alxGetOutputName",             (void *) alxGetOutputName           },
+        { "alxGetInputSourceCount",       (void *) alxGetInputSourceCount     },
+        { "alxGetInputSourceName",        (void *) alxGetInputSourceName      },
+        { "alxGetIntegerv",               (void *) alxGetIntegerv             },
+        { "alxSetIntegerv",               (void *) alxSetIntegerv             },
+        { "alxdSubscribe",                (void *) alxdSubscribe              },
+        { "alxdDispatch",                 (void *) alxdDispatch               },
+        { NULL,                           (void *) NULL                       } };
+    int i = 0;
+
+    (void) device;
+
+    if (funcName == NULL) {
+        alxd::setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    while (Functions[i].funcName && strcmp(Functions[i].funcName, funcName))
+        i++;
+    return Functions[i].address;
+}
+
+
+/*
+    alxGetError
+
+    Return last ALMix generated error code
+*/
+ALXAPI ALXenum ALXAPIENTRY alxGetError(ALXdevice *pMixer)
+{
+    ALXenum errorCode;
+
+    (void) pMixer;
+
+    errorCode = alxd::LastError;
+    alxd::LastError = ALX_NO_ERROR;
+    return errorCode;
+}
+
+} // extern "C"
+
+/* Modeline for vim: set tw=79 et ts=4: */
@@ -0,0 +1,175 @@
+/*
+ * ALx
+ * Mixer daemon wire protocol
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef ALXD_PROTOCOL_H
+#define ALXD_PROTOCOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+ #include <winsock2.h>
+ #include <afunix.h>
+ typedef SOCKET alxd_socket;
+ #define ALXD_INVALID_SOCKET     INVALID_SOCKET
+ #define alxd_close              closesocket
+#else
+ #include <sys/types.h>
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <sys/select.h>
+ #include <unistd.h>
+ typedef int alxd_socket;
+ #define ALXD_INVALID_SOCKET     (-1)
+ #define alxd_close              close
+#endif
+
+/*
+ * Every message, in both directions, is a frame made of the fixed header
+ * below optionally followed by a NUL terminated string payload (device
+ * names, line names and device lists). Frames are sent in host byte
+ * order, since both ends always run on the same host.
+ *
+ * Requests carry a serial number chosen by the client and echoed back
+ * in the reply, so a client may send several requests before reading
+ * any reply. Replies come in request order. Notifications are sent
+ * with serial 0.
+ */
+
+#define ALXD_PROTOCOL_VERSION   1
+
+#define ALXD_MAX_PAYLOAD        4096
+#define ALXD_MAX_FRAME          (sizeof(ALXDframe) + ALXD_MAX_PAYLOAD)
+
+#define ALXD_SOCKET_ENV         "ALXD_SOCKET"
+#define ALXD_SOCKET_NAME        "alxd.sock"
+
+enum ALXDop {
+    ALXD_OP_HELLO = 1,              /* value: protocol version */
+    ALXD_OP_OPEN_DEVICE,            /* payload: device name */
+    ALXD_OP_OPEN_CAPTURE_DEVICE,    /* payload: device name */
+    ALXD_OP_MAP_DEVICE,             /* payload: OpenAL device name */
+    ALXD_OP_MAP_CAPTURE_DEVICE,     /* payload: OpenAL device name */
+    ALXD_OP_CLOSE_DEVICE,
+    ALXD_OP_GET_FLOAT,
+    ALXD_OP_SET_FLOAT,
+    ALXD_OP_GET_BOOLEAN,
+    ALXD_OP_SET_BOOLEAN,
+    ALXD_OP_GET_INTEGER,
+    ALXD_OP_SET_INTEGER,
+    ALXD_OP_GET_STRING,             /* reply payload: string or list */
+    ALXD_OP_GET_INDEXED_STRING,     /* reply payload: string */
+    ALXD_OP_GET_INDEXED_FLOAT,
+    ALXD_OP_GET_INDEXED_BOOLEAN,
+    ALXD_OP_SET_INDEXED_FLOAT,
+    ALXD_OP_SET_INDEXED_BOOLEAN,
+    ALXD_OP_SUBSCRIBE,
+    ALXD_OP_UNSUBSCRIBE,
+    ALXD_OP_NOTIFY,                 /* status: getter op the value is for */
+    ALXD_OP_GET_INTEGERV,           /* raw value, never cached */
+    ALXD_OP_SET_INTEGERV
+};
+
+typedef struct ALXDframe_struct
+{
+    unsigned int        size;       /* whole frame, payload included */
+    unsigned int        serial;
+    unsigned short      op;
+    unsigned short      device;     /* daemon side handle, 0 for none */
+    int                 param;
+    int                 index;
+    int                 value;      /* integer, boolean or float bits */
+    int                 status;     /* ALX error code in replies */
+} ALXDframe;
+
+inline int alxdFloatBits(float value)
+{
+    int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float alxdBitsFloat(int bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*
+    Getter whose cached value a setter changes, or 0.
+*/
+inline unsigned short alxdGetterOf(unsigned short op)
+{
+    switch (op) {
+    case ALXD_OP_SET_FLOAT:           return ALXD_OP_GET_FLOAT;
+    case ALXD_OP_SET_BOOLEAN:         return ALXD_OP_GET_BOOLEAN;
+    case ALXD_OP_SET_INDEXED_FLOAT:   return ALXD_OP_GET_INDEXED_FLOAT;
+    case ALXD_OP_SET_INDEXED_BOOLEAN: return ALXD_OP_GET_INDEXED_BOOLEAN;
+    default:                          return 0;
+    }
+}
+
+/*
+    Socket path: $ALXD_SOCKET, or alxd.sock in the temporary directory.
+*/
+inline void alxdSocketPath(struct sockaddr_un *addr)
+{
+    const char *path = getenv(ALXD_SOCKET_ENV);
+    const char *dir;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (path && *path) {
+        strncpy(addr->sun_path, path, sizeof(addr->sun_path) - 1);
+        return;
+    }
+
+#if defined(_WIN32)
+    dir = getenv("TEMP");
+    if (!dir)
+        dir = ".";
+    _snprintf(addr->sun_path, sizeof(addr->sun_path) - 1, "%s\\%s", dir, ALXD_SOCKET_NAME);
+#else
+    dir = getenv("TMPDIR");
+    if (!dir)
+        dir = "/tmp";
+    snprintf(addr->sun_path, sizeof(addr->sun_path) - 1, "%s/%s", dir, ALXD_SOCKET_NAME);
+#endif
+}
+
+#endif /* ALXD_PROTOCOL_H */
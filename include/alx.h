@@ -36,6 +36,7 @@
 #ifndef AL_ALX_H
 #define AL_ALX_H
 
+#include <stddef.h>
 #include <alc.h>
 
 #if defined(__cplusplus)
@@ -88,9 +89,16 @@ typedef int ALXenum;
 /** signed 32-bit 2's complement integer */
 typedef int ALXint;
 
+/** unsigned 32-bit integer, as OpenAL object names */
+typedef unsigned int ALXuint;
+
 /** 32-bit IEEE754 floating-point */
 typedef float ALXfloat;
 
+/** user memory allocator, see alxSetAllocator */
+typedef void *          (ALX_APIENTRY *LPALXALLOC)( size_t size, void *userdata );
+typedef void            (ALX_APIENTRY *LPALXFREE)( void *ptr, void *userdata );
+
 
 /* Enumerant values begin at column 50. No tabs. */
 
@@ -154,6 +162,11 @@ typedef float ALXfloat;
  */
 #define ALX_OUT_OF_MEMORY                        0xA005
 
+/**
+ * Operation not valid in the current state
+ */
+#define ALX_INVALID_OPERATION                    0xA006
+
 
 #define ALX_EXTENSIONS                           0x2006
 
@@ -164,12 +177,296 @@ typedef float ALXfloat;
 
 /**
  * Multiple selectors
+ *
+ * ALX_INPUT_SOURCE is set with the index of the source to record from.
+ * Setting it as an indexed float selects that source and sets its
+ * volume in one call.
  */
 #define ALX_INPUT_SOURCE                         0x2009
 #define ALX_INPUT_SOURCE_SPECIFIER               0x200A
 #define ALX_OUTPUT_VOLUME                        0x200B
 #define ALX_OUTPUT_VOLUME_SPECIFIER              0x200C
 
+/**
+ * Realtime command queue
+ *
+ * ALX_QUEUE_SIZE is set with the number of commands the queue holds,
+ * 0 to remove it; set it before any thread queues commands.
+ * ALX_QUEUE_PENDING and ALX_QUEUE_DROPPED are read-only counters.
+ * ALX_QUEUE_OVERFLOW is followed by ALX_QUEUE_DROP_NEWEST (default) or
+ * ALX_QUEUE_DROP_OLDEST.
+ */
+#define ALX_QUEUE_SIZE                           0x2010
+#define ALX_QUEUE_PENDING                        0x2011
+#define ALX_QUEUE_DROPPED                        0x2012
+#define ALX_QUEUE_OVERFLOW                       0x2013
+#define ALX_QUEUE_DROP_NEWEST                    0x2014
+#define ALX_QUEUE_DROP_OLDEST                    0x2015
+
+/**
+ * Change feed
+ *
+ * ALX_GENERATION is the read-only number of the last change seen by the
+ * device. ALX_CHANGE_LOG_SIZE is the number of changes it remembers,
+ * 64 unless set, up to 65536; setting it forgets the changes logged so
+ * far.
+ */
+#define ALX_GENERATION                           0x2016
+#define ALX_CHANGE_LOG_SIZE                      0x2017
+
+/*
+ * A change of a control value. 'param' and 'index' are those of the
+ * getter, with 'index' -1 for parameters that are not indexed, and
+ * 'isBoolean' tells a mute from a volume. Values unknown before are
+ * -1.0.
+ */
+typedef struct ALXchange_struct
+{
+    ALXint              generation;
+    ALXenum             param;
+    ALXint              index;
+    ALXboolean          isBoolean;
+    ALXfloat            oldValue;
+    ALXfloat            newValue;
+} ALXchange;
+
+/**
+ * Raw values
+ *
+ * alxGetIntegerv and alxSetIntegerv take ALX_MASTER_VOLUME,
+ * ALX_PCM_OUTPUT_VOLUME, ALX_INPUT_VOLUME and ALX_OUTPUT_VOLUME in the
+ * units of the driver. The read-only _MIN and _MAX below are the range
+ * of those values, and _STEP how many units apart the hardware steps
+ * are.
+ */
+#define ALX_MASTER_VOLUME_MIN                    0x2020
+#define ALX_MASTER_VOLUME_MAX                    0x2021
+#define ALX_MASTER_VOLUME_STEP                   0x2022
+#define ALX_PCM_OUTPUT_VOLUME_MIN                0x2023
+#define ALX_PCM_OUTPUT_VOLUME_MAX                0x2024
+#define ALX_PCM_OUTPUT_VOLUME_STEP               0x2025
+#define ALX_INPUT_VOLUME_MIN                     0x2026
+#define ALX_INPUT_VOLUME_MAX                     0x2027
+#define ALX_INPUT_VOLUME_STEP                    0x2028
+#define ALX_OUTPUT_VOLUME_MIN                    0x2029
+#define ALX_OUTPUT_VOLUME_MAX                    0x202A
+#define ALX_OUTPUT_VOLUME_STEP                   0x202B
+
+/**
+ * Backend
+ *
+ * ALX_BACKEND selects what ALX_MASTER_VOLUME and its mute control:
+ * ALX_BACKEND_DRIVER (default), the system mixer, or, for devices
+ * from alxMapDevice only, ALX_BACKEND_OPENAL, the listener AL_GAIN of
+ * the mapped device's contexts, which only affects this process and
+ * makes no driver call. alxMapDevice maps devices no system mixer goes
+ * with, such as loopback devices, too; those only have
+ * ALX_BACKEND_OPENAL.
+ */
+#define ALX_BACKEND                              0x2030
+#define ALX_BACKEND_DRIVER                       0x2031
+#define ALX_BACKEND_OPENAL                       0x2032
+
+/**
+ * Buses
+ *
+ * Gain (ALXfloat, 0 and up) and mute (ALXboolean) of the bus whose id
+ * is given as index, bus 0 being the root one. See alxGenBus.
+ */
+#define ALX_BUS_GAIN                             0x2040
+#define ALX_BUS_MUTE                             0x2041
+
+/**
+ * Level analysis
+ *
+ * Sample types of alxMeasureLevels, and what it measures (flags).
+ * ALX_INPUT_PEAK and ALX_INPUT_RMS read-only floats 0.0-1.0, the peak
+ * meter of the recording line when the driver has one, otherwise the
+ * loudest channel of the latest window of the capture tap (16 bit or
+ * float formats). ALX_LEVEL_ISA, with alxGetInteger and alxSetInteger
+ * on a NULL device, is the instruction set the measurements run with:
+ * the best the processor has, until set to another it supports.
+ */
+#define ALX_SAMPLE_INT16                         0x2050
+#define ALX_SAMPLE_FLOAT32                       0x2051
+#define ALX_INPUT_PEAK                           0x2052
+#define ALX_INPUT_RMS                            0x2053
+#define ALX_LEVEL_ISA                            0x2054
+#define ALX_ISA_SCALAR                           0x2055
+#define ALX_ISA_SSE2                             0x2056
+#define ALX_ISA_AVX2                             0x2057
+
+#define ALX_LEVEL_RMS                            0x0001
+#define ALX_LEVEL_PEAK                           0x0002
+#define ALX_LEVEL_TRUE_PEAK                      0x0004
+
+#define ALX_MAX_LEVEL_CHANNELS                   32
+
+typedef struct ALXlevel_struct
+{
+    ALXfloat            rms;        /* full scale is 1.0 */
+    ALXfloat            peak;
+    ALXfloat            truePeak;   /* 4x oversampled, ITU-R BS.1770 */
+    ALXfloat            history[16];/* true peak filter state, zero it before the first call */
+} ALXlevel;
+
+/**
+ * Loudness
+ *
+ * What alxGetLoudness returns, per EBU R128 and ITU-R BS.1770-4: the
+ * momentary (400 ms) and short-term (3 s) loudness, updated every
+ * 100 ms, and the gated integrated loudness, all in LUFS, minus
+ * infinity while nothing was heard; and the loudness range, in LU.
+ */
+#define ALX_LOUDNESS_MOMENTARY                   0x2060
+#define ALX_LOUDNESS_SHORT_TERM                  0x2061
+#define ALX_LOUDNESS_INTEGRATED                  0x2062
+#define ALX_LOUDNESS_RANGE                       0x2063
+
+typedef struct ALXloudness_struct ALXloudness;
+
+/**
+ * Ducking
+ *
+ * Ducker floats: the threshold in dBFS that captured speech must be
+ * above (-45 unless set), the attack, hold and release times in ms
+ * (20, 300 and 500), and the read-only amount of ducking, from 0.0 to
+ * 1.0, and noise floor in dBFS.
+ */
+#define ALX_DUCK_THRESHOLD                       0x2070
+#define ALX_DUCK_ATTACK                          0x2071
+#define ALX_DUCK_HOLD                            0x2072
+#define ALX_DUCK_RELEASE                         0x2073
+#define ALX_DUCK_AMOUNT                          0x2074
+#define ALX_DUCK_NOISE_FLOOR                     0x2075
+
+#define ALX_MAX_DUCK_TARGETS                     8
+
+typedef struct ALXducker_struct ALXducker;
+
+/**
+ * Tone
+ *
+ * ALX_BASS and ALX_TREBLE floats, and ALX_EQUALIZER indexed floats, one
+ * per band, from 0.0 to 1.0 and flat at 0.5. They use the controls of
+ * the speakers when the driver has them. Otherwise alxProcessTone
+ * filters blocks with them: bass is a low shelf at 100 Hz and treble
+ * a high shelf at 10 kHz, up to 12 dB either way, and the equalizer
+ * has 10 bands an octave wide from 31.25 Hz. ALX_EQUALIZER_BANDS is
+ * the read-only band count, and ALX_TONE_HARDWARE the read-only flags
+ * of those the driver has.
+ */
+#define ALX_BASS                                 0x2080
+#define ALX_TREBLE                               0x2081
+#define ALX_EQUALIZER                            0x2082
+#define ALX_EQUALIZER_BANDS                      0x2083
+#define ALX_TONE_HARDWARE                        0x2084
+
+#define ALX_TONE_BASS                            0x0001
+#define ALX_TONE_TREBLE                          0x0002
+#define ALX_TONE_EQUALIZER                       0x0004
+
+#define ALX_MAX_EQUALIZER_BANDS                  32
+
+/**
+ * Noise gate
+ *
+ * Floats of a capture device, gating what alxPumpCaptureTap moves into
+ * a 16 bit or float tap, in place: the threshold in dBFS (-50 unless
+ * set), the ratio of the expander below it (1.0, which leaves the
+ * signal alone), the attack and release times in ms (1 and 100), the
+ * range, the most it takes off in dB (-60), and how many ms the level
+ * must stay below the threshold before the recording line is muted
+ * (0, never). Muting needs a driver with both an input mute and a
+ * peak meter, which unmutes it once the level is back; both happen in
+ * alxProcessQueue or alxProcessEvents, not in the pump. The read-only
+ * ALX_GATE_GAIN float is the current gain in dB, and the ALX_GATE_MUTED
+ * boolean whether the gate muted the line.
+ */
+#define ALX_GATE_THRESHOLD                       0x2090
+#define ALX_GATE_RATIO                           0x2091
+#define ALX_GATE_ATTACK                          0x2092
+#define ALX_GATE_RELEASE                         0x2093
+#define ALX_GATE_RANGE                           0x2094
+#define ALX_GATE_MUTE_DELAY                      0x2095
+#define ALX_GATE_GAIN                            0x2096
+#define ALX_GATE_MUTED                           0x2097
+
+/**
+ * Envelopes
+ *
+ * Points an envelope can hold, scheduled and not yet passed.
+ */
+#define ALX_MAX_ENVELOPE_POINTS                  65536
+
+typedef struct ALXenvelope_struct ALXenvelope;
+
+/**
+ * Event loop integration
+ *
+ * What alxGetPollDescriptors asks the application to wait for: a file
+ * descriptor or socket to become readable or a HANDLE to be signaled
+ * (ALX_POLL_IN), or window messages posted to the thread that made the
+ * call (ALX_POLL_MESSAGES), as MsgWaitForMultipleObjects does with
+ * QS_POSTMESSAGE.
+ */
+#define ALX_POLL_IN                              0x0001
+#define ALX_POLL_MESSAGES                        0x0002
+
+typedef struct ALXpollfd_struct
+{
+    ALXint              fd;         /* -1 when none */
+    void               *handle;     /* NULL when none */
+    ALXint              events;
+} ALXpollfd;
+
+
+/*
+ * Shared state layout.
+ * A process that called alxPublishSharedState writes the values of its
+ * devices to a named shared memory segment laid out as below; other
+ * processes read them with alxAttachSharedState. Every value a device
+ * reads from or writes to the driver is published, so the owner decides
+ * how fresh the segment is by how often it reads. Values are -1 while
+ * unknown. A device with an empty name is closed, and its slot free.
+ * 'equalizer' holds the bands of a driver equalizer; those of the
+ * software tone filter are not published.
+ *
+ * 'sequence' is odd while the owner is writing a device; copy a device
+ * with alxReadSharedDevice to get consistent values.
+ */
+#define ALX_SHARED_STATE_MAGIC                   0x534C5841 /* 'ALXS' */
+#define ALX_SHARED_STATE_VERSION                 3
+#define ALX_SHARED_MAX_DEVICES                   16
+#define ALX_SHARED_MAX_LINES                     64
+#define ALX_SHARED_NAME_SIZE                     32
+
+typedef struct ALXsharedDevice_struct
+{
+    volatile ALXint     sequence;
+    ALXint              capture;
+    ALXchar             name[ALX_SHARED_NAME_SIZE];
+    ALXfloat            masterVolume;
+    ALXint              masterMute;
+    ALXfloat            pcmVolume;
+    ALXint              pcmMute;
+    ALXfloat            inputVolume;
+    ALXint              inputSource;
+    ALXint              numOutputs;
+    ALXfloat            outputVolume[ALX_SHARED_MAX_LINES];
+    ALXint              outputMute[ALX_SHARED_MAX_LINES];
+    ALXfloat            equalizer[ALX_SHARED_MAX_LINES];
+} ALXsharedDevice;
+
+typedef struct ALXsharedState_struct
+{
+    ALXint              magic;
+    ALXint              version;
+    volatile ALXint     numDevices;
+    ALXint              reserved;
+    ALXsharedDevice     devices[ALX_SHARED_MAX_DEVICES];
+} ALXsharedState;
+
 
 /*
  * Create/Destroy Mixer
@@ -219,8 +516,331 @@ ALX_API void            ALX_APIENTRY alxSetIndexedFloat( ALXdevice *mixer, ALXen
 
 ALX_API void            ALX_APIENTRY alxSetIndexedBoolean( ALXdevice *mixer, ALXenum param, ALXint index, ALXboolean value );
 
+ALX_API void            ALX_APIENTRY alxGetIntegerv( ALXdevice *mixer, ALXenum param, ALXint index, ALXint *values );
+
+ALX_API void            ALX_APIENTRY alxSetIntegerv( ALXdevice *mixer, ALXenum param, ALXint index, const ALXint *values );
+
 ALX_API void *          ALX_APIENTRY alxGetProcAddress( ALXdevice *device, const ALXchar *funcName );
 
+/*
+ * Realtime command queue.
+ * alxQueueFloat and alxQueueBoolean may be called from one audio thread
+ * per device: they never allocate, lock or call the system, and return
+ * ALX_FALSE when the command was dropped. Queued commands are applied
+ * by alxProcessQueue, called from a control thread. 'index' is -1 for
+ * parameters that are not indexed.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxQueueFloat( ALXdevice *mixer, ALXenum param, ALXint index, ALXfloat value );
+
+ALX_API ALXboolean      ALX_APIENTRY alxQueueBoolean( ALXdevice *mixer, ALXenum param, ALXint index, ALXboolean value );
+
+ALX_API ALXint          ALX_APIENTRY alxProcessQueue( ALXdevice *mixer );
+
+/*
+ * Event loop integration.
+ * ALx starts no threads. alxGetPollDescriptors tells what the event
+ * loop has to wait for to learn about changes made to the device by
+ * others, copying up to 'count' descriptors to 'fds' and returning how
+ * many there are. Whenever one is ready, alxProcessEvents reads the
+ * changed values, into the change log and the shared state, applies
+ * the queued commands, and returns how many events it handled. Close
+ * the device on the thread that asked for its descriptors.
+ */
+ALX_API ALXint          ALX_APIENTRY alxGetPollDescriptors( ALXdevice *mixer, ALXpollfd *fds, ALXint count );
+
+ALX_API ALXint          ALX_APIENTRY alxProcessEvents( ALXdevice *mixer );
+
+/*
+ * Buses.
+ * A tree of gains over the OpenAL sources of the application. A bus
+ * made by alxGenBus goes under 'parent', 0 for the root bus; deleting
+ * it moves its buses and sources to its parent. alxAttachSource puts
+ * a source of the current context on a bus, after which its AL_GAIN
+ * is the product of the ALX_BUS_GAIN of the buses above it, or zero
+ * under one with ALX_BUS_MUTE set, so the application should no longer
+ * set it. Only the sources whose gain changed are updated, once per
+ * context, when the change is made, or at the end of alxProcessQueue
+ * for queued ones.
+ */
+ALX_API ALXint          ALX_APIENTRY alxGenBus( ALXdevice *mixer, ALXint parent );
+
+ALX_API void            ALX_APIENTRY alxDeleteBus( ALXdevice *mixer, ALXint bus );
+
+ALX_API void            ALX_APIENTRY alxAttachSource( ALXdevice *mixer, ALXint bus, ALXuint source );
+
+ALX_API void            ALX_APIENTRY alxDetachSource( ALXdevice *mixer, ALXuint source );
+
+/*
+ * Capture tap.
+ * Lets several consumers share what a device from alxMapCaptureDevice
+ * captures without copying it. alxSetCaptureTap sizes a ring of at
+ * least 'frames' frames of the AL_FORMAT_* the device was opened with,
+ * from which windows of up to 'window' frames can be read; 0 frames
+ * removes it. Set it before other threads use it, and do not call
+ * alcCaptureSamples on the device any more: the one thread calling
+ * alxPumpCaptureTap moves the captured frames into the ring.
+ *
+ * Positions count frames since the tap was set, and wrap around.
+ * Readers keep their own, starting from alxGetCapturePosition, which
+ * is how far the ring is written. alxGetCaptureWindow returns the
+ * frames from 'position' on, in place, or NULL when they are not
+ * captured yet or were overwritten. A reader that falls a whole ring
+ * behind has its frames overwritten while it uses them, which
+ * alxIsCaptureWindowValid tells once it is done; it should then
+ * discard its results and start again from alxGetCapturePosition.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxSetCaptureTap( ALXdevice *mixer, ALXenum format, ALXint frames, ALXint window );
+
+ALX_API ALXint          ALX_APIENTRY alxPumpCaptureTap( ALXdevice *mixer );
+
+ALX_API ALXuint         ALX_APIENTRY alxGetCapturePosition( ALXdevice *mixer );
+
+ALX_API const void *    ALX_APIENTRY alxGetCaptureWindow( ALXdevice *mixer, ALXuint position, ALXint frames );
+
+ALX_API ALXboolean      ALX_APIENTRY alxIsCaptureWindowValid( ALXdevice *mixer, ALXuint position );
+
+/*
+ * Level analysis.
+ * Measures each channel of 'frames' interleaved frames of 'channels'
+ * samples of 'type' into 'levels[channel]', setting only the fields
+ * named by 'what'. True peak carries its filter through the history
+ * of each level, so consecutive blocks of a stream should be measured
+ * with the same levels. Needs no device, and is safe from any thread.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxMeasureLevels( ALXenum type, ALXint channels, const void *samples, ALXint frames, ALXint what, ALXlevel *levels );
+
+/*
+ * Loudness.
+ * A meter of a stream of 'rate' Hz with 'channels' channels, in the
+ * order of WAVE_FORMAT_EXTENSIBLE: with 6, the fourth is LFE and left
+ * out, the last two surround and weighted 1.41. Feed it consecutive
+ * interleaved blocks of any size, from the application or windows of
+ * the capture tap; only one thread may use a meter at a time.
+ *
+ * alxSetLoudnessTarget makes each 100 ms of samples move 'param' of
+ * 'mixer', ALX_MASTER_VOLUME, ALX_PCM_OUTPUT_VOLUME, or, with 'index',
+ * ALX_OUTPUT_VOLUME or ALX_BUS_GAIN (index -1 otherwise), toward what
+ * would bring the short-term loudness to 'target' LUFS, by at most
+ * 'rate' dB per second, and writes it when it moved by 0.1 dB. The
+ * meter should see the stream before that gain. Writes go through the
+ * command queue if the device had one when the target was set, so a
+ * meter fed by an audio thread never calls the driver. Silence holds
+ * the gain, volumes stay at 1.0 or below, bus gains at 4.0 (+12 dB).
+ * A NULL mixer stops following, and so does closing the mixer, which
+ * must wait until no thread is feeding the meter.
+ */
+ALX_API ALXloudness *   ALX_APIENTRY alxCreateLoudnessMeter( ALXint rate, ALXint channels );
+
+ALX_API void            ALX_APIENTRY alxDeleteLoudnessMeter( ALXloudness *meter );
+
+ALX_API void            ALX_APIENTRY alxResetLoudnessMeter( ALXloudness *meter );
+
+ALX_API ALXboolean      ALX_APIENTRY alxAddLoudnessSamples( ALXloudness *meter, ALXenum type, const void *samples, ALXint frames );
+
+ALX_API ALXfloat        ALX_APIENTRY alxGetLoudness( ALXloudness *meter, ALXenum param );
+
+ALX_API ALXboolean      ALX_APIENTRY alxSetLoudnessTarget( ALXloudness *meter, ALXdevice *mixer, ALXenum param, ALXint index, ALXfloat target, ALXfloat rate );
+
+/*
+ * Ducking.
+ * A ducker detects speech in captured blocks of a 'rate' Hz stream,
+ * given to alxProcessDucker or, once linked with alxSetCaptureDucker,
+ * taken from every frame alxPumpCaptureTap moves into the tap, and
+ * lowers its targets by up to 'depth' dB (0 or below) while it hears
+ * it. Targets are the controls alxSetLoudnessTarget takes, lowered
+ * from the value they had when added, and written back to it when
+ * removed or when the ducker is deleted. Each block writes a target
+ * at most once, through the command queue of its device, so the thread
+ * processing the ducker never calls the driver: alxAddDuckTarget fails
+ * with ALX_INVALID_OPERATION on a device without a queue, and the
+ * control thread applies the writes with alxProcessQueue or
+ * alxProcessEvents. Only one thread may use a ducker at a time: that is
+ * the one pumping the tap for a linked ducker. A NULL ducker unlinks;
+ * devices from ALxClient have no tap to link.
+ *
+ * Closing a device removes the targets it has in every ducker, writing
+ * them back, and unlinks its ducker; deleting a linked ducker unlinks
+ * it from its device. Either must wait until no thread is processing
+ * the ducker or pumping the tap.
+ */
+ALX_API ALXducker *     ALX_APIENTRY alxCreateDucker( ALXint rate );
+
+ALX_API void            ALX_APIENTRY alxDeleteDucker( ALXducker *ducker );
+
+ALX_API ALXboolean      ALX_APIENTRY alxAddDuckTarget( ALXducker *ducker, ALXdevice *mixer, ALXenum param, ALXint index, ALXfloat depth );
+
+ALX_API void            ALX_APIENTRY alxRemoveDuckTargets( ALXducker *ducker, ALXdevice *mixer );
+
+ALX_API ALXfloat        ALX_APIENTRY alxGetDuckerFloat( ALXducker *ducker, ALXenum param );
+
+ALX_API void            ALX_APIENTRY alxSetDuckerFloat( ALXducker *ducker, ALXenum param, ALXfloat value );
+
+ALX_API ALXboolean      ALX_APIENTRY alxProcessDucker( ALXducker *ducker, ALXenum type, ALXint channels, const void *samples, ALXint frames );
+
+ALX_API ALXboolean      ALX_APIENTRY alxSetCaptureDucker( ALXdevice *mixer, ALXducker *ducker );
+
+/*
+ * Tone.
+ * Runs the software bass, treble and equalizer of a device in place
+ * over 'frames' interleaved frames of 'channels' samples of 'type' at
+ * 'rate' Hz: blocks the application mixes itself, or those rendered
+ * by an ALC_SOFT_loopback device. Flat levels and those the driver
+ * has cost nothing. One thread may run it while another sets levels;
+ * the filters are designed again on the first block after a change.
+ * Not in ALxClient.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxProcessTone( ALXdevice *mixer, ALXenum type, ALXint channels, ALXint rate, void *samples, ALXint frames );
+
+/*
+ * Envelopes.
+ * An envelope schedules gain changes at positions of a frame clock
+ * the application keeps, such as the AL_SAMPLE_OFFSET of a source;
+ * positions wrap around like those of the capture tap. A point sets
+ * the gain, a factor of 0.0 or more, at its position, and the gain
+ * moves linearly from one point to the next; until the first point
+ * is passed, and after the last, it holds. Points are added in the
+ * order of their positions, up to the 'points' the envelope was
+ * created with, and are dropped once passed; alxClearEnvelope drops
+ * them all, holding the gain where it is.
+ *
+ * alxProcessEnvelope applies the gain to 'frames' interleaved frames
+ * of 'channels' samples of 'type' in place, the first frame being at
+ * 'position', frame by frame. alxSetEnvelopeTarget makes the envelope
+ * move a control alxSetLoudnessTarget takes instead, NULL 'mixer'
+ * unlinking it: each alxAdvanceEnvelope moves the clock to 'position'
+ * and writes the gain when it moved by 0.5 dB or reached a point, so
+ * the driver's latency makes those moves coarse. Only one thread may
+ * use an envelope at a time. Closing the mixer unlinks it, which must
+ * wait until no thread is advancing the envelope.
+ */
+ALX_API ALXenvelope *   ALX_APIENTRY alxCreateEnvelope( ALXint points );
+
+ALX_API void            ALX_APIENTRY alxDeleteEnvelope( ALXenvelope *envelope );
+
+ALX_API ALXboolean      ALX_APIENTRY alxAddEnvelopePoint( ALXenvelope *envelope, ALXuint position, ALXfloat gain );
+
+ALX_API void            ALX_APIENTRY alxClearEnvelope( ALXenvelope *envelope );
+
+ALX_API ALXfloat        ALX_APIENTRY alxGetEnvelopeGain( ALXenvelope *envelope );
+
+ALX_API ALXboolean      ALX_APIENTRY alxProcessEnvelope( ALXenvelope *envelope, ALXenum type, ALXint channels, ALXuint position, void *samples, ALXint frames );
+
+ALX_API ALXboolean      ALX_APIENTRY alxSetEnvelopeTarget( ALXenvelope *envelope, ALXdevice *mixer, ALXenum param, ALXint index );
+
+ALX_API void            ALX_APIENTRY alxAdvanceEnvelope( ALXenvelope *envelope, ALXuint position );
+
+/*
+ * Memory allocation.
+ * Devices opened after this call take their memory from 'allocFunc',
+ * in a few large blocks given back to 'freeFunc' by alxCloseDevice.
+ * Once a device is open, getting and setting values never allocates.
+ * NULL functions restore malloc and free.
+ */
+ALX_API void            ALX_APIENTRY alxSetAllocator( LPALXALLOC allocFunc, LPALXFREE freeFunc, void *userdata );
+
+/*
+ * Change feed.
+ * Each device numbers the changes of its control values it sees, from
+ * its own writes and from values read back from the driver, and keeps
+ * the last ones. alxGetChangesSince copies those made after a given
+ * generation, or returns -1 when the log no longer holds them all.
+ */
+ALX_API ALXint          ALX_APIENTRY alxGetChangesSince( ALXdevice *mixer, ALXint generation, ALXchange *changes, ALXint count );
+
+/*
+ * Shared state.
+ * alxPublishSharedState creates the named segment and publishes the
+ * devices opened from then on; NULL stops publishing. Readers map the
+ * segment read-only with alxAttachSharedState, and copy a device out of
+ * it without any system call with alxReadSharedDevice, which returns
+ * ALX_FALSE if the owner kept writing it.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxPublishSharedState( const ALXchar *name );
+
+ALX_API const ALXsharedState * ALX_APIENTRY alxAttachSharedState( const ALXchar *name );
+
+ALX_API ALXboolean      ALX_APIENTRY alxReadSharedDevice( const ALXsharedState *state, ALXint index, ALXsharedDevice *values );
+
+ALX_API void            ALX_APIENTRY alxDetachSharedState( const ALXsharedState *state );
+
+/*
+ * Driver call trace.
+ * alxStartTrace records every call made to the mixer driver, with its
+ * timing, arguments and result, in a ring file holding the last
+ * 'records' calls; see alxtrace.h for its format. alxStopTrace closes
+ * the file.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxStartTrace( const ALXchar *filename, ALXint records );
+
+ALX_API void            ALX_APIENTRY alxStopTrace( void );
+
+/*
+ * Trace events.
+ * alxStartEventTrace writes timed spans of the library internals, such
+ * as device discovery steps, device enumeration and driver writes, to a
+ * Chrome trace event JSON file that chrome://tracing and the Perfetto
+ * UI can load. Timestamps are QueryPerformanceCounter microseconds.
+ * Off until this is called.
+ */
+ALX_API ALXboolean      ALX_APIENTRY alxStartEventTrace( const ALXchar *filename );
+
+ALX_API void            ALX_APIENTRY alxStopEventTrace( void );
+
+/*
+ * Typed access.
+ * One entry point per control, without the parameter switch of the
+ * query functions. They return the status, ALX_NO_ERROR on success,
+ * instead of leaving it for alxGetError. Names point into the device
+ * and stay valid until it is closed.
+ */
+ALX_API ALXenum         ALX_APIENTRY alxGetMasterVolume( ALXdevice *mixer, ALXfloat *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetMasterVolume( ALXdevice *mixer, ALXfloat value );
+
+ALX_API ALXenum         ALX_APIENTRY alxGetMasterMute( ALXdevice *mixer, ALXboolean *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetMasterMute( ALXdevice *mixer, ALXboolean value );
+
+ALX_API ALXenum         ALX_APIENTRY alxGetPCMOutputVolume( ALXdevice *mixer, ALXfloat *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetPCMOutputVolume( ALXdevice *mixer, ALXfloat value );
+
+ALX_API ALXenum         ALX_APIENTRY alxGetPCMOutputMute( ALXdevice *mixer, ALXboolean *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetPCMOutputMute( ALXdevice *mixer, ALXboolean value );
+
+ALX_API ALXenum         ALX_APIENTRY alxGetInputVolume( ALXdevice *mixer, ALXfloat *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetInputVolume( ALXdevice *mixer, ALXfloat value );
+
+ALX_API ALXenum         ALX_APIENTRY alxGetInputSource( ALXdevice *mixer, ALXint *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetInputSource( ALXdevice *mixer, ALXint value );
+
+ALX_API ALXenum         ALX_APIENTRY alxGetOutputVolume( ALXdevice *mixer, ALXint index, ALXfloat *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetOutputVolume( ALXdevice *mixer, ALXint index, ALXfloat value );
+
+ALX_API ALXenum         ALX_APIENTRY alxGetOutputMute( ALXdevice *mixer, ALXint index, ALXboolean *value );
+
+ALX_API ALXenum         ALX_APIENTRY alxSetOutputMute( ALXdevice *mixer, ALXint index, ALXboolean value );
+
+ALX_API ALXint          ALX_APIENTRY alxGetOutputCount( ALXdevice *mixer );
+
+ALX_API const ALXchar * ALX_APIENTRY alxGetOutputName( ALXdevice *mixer, ALXint index );
+
+ALX_API ALXint          ALX_APIENTRY alxGetInputSourceCount( ALXdevice *mixer );
+
+ALX_API const ALXchar * ALX_APIENTRY alxGetInputSourceName( ALXdevice *mixer, ALXint index );
+
+/*
+ * Topology cache.
+ * Devices opened after this call look their lines and controls up in
+ * the given file before asking the driver, and store what they had to
+ * discover. NULL disables the cache.
+ */
+ALX_API void            ALX_APIENTRY alxSetTopologyCache( const ALXchar *filename );
+
 /*
  * Pointer-to-function types, useful for dynamically getting ALX entry points.
  */
@@ -243,6 +863,77 @@ typedef ALXboolean      (ALX_APIENTRY *LPALXGETINDEXEDBOOLEAN)( ALXdevice *mixer
 typedef void            (ALX_APIENTRY *LPALXSETINDEXEDFLOAT)( ALXdevice *mixer, ALXenum param, ALXint index, ALXfloat value );
 typedef void            (ALX_APIENTRY *LPALXSETINDEXEDBOOLEAN)( ALXdevice *mixer, ALXenum param, ALXint index, ALXboolean value );
 typedef void *          (ALX_APIENTRY *LPALXGETPROCADDRESS)( ALXdevice *device, const ALXchar *funcName );
+typedef void            (ALX_APIENTRY *LPALXSETTOPOLOGYCACHE)( const ALXchar *filename );
+typedef ALXboolean      (ALX_APIENTRY *LPALXQUEUEFLOAT)( ALXdevice *mixer, ALXenum param, ALXint index, ALXfloat value );
+typedef ALXboolean      (ALX_APIENTRY *LPALXQUEUEBOOLEAN)( ALXdevice *mixer, ALXenum param, ALXint index, ALXboolean value );
+typedef ALXint          (ALX_APIENTRY *LPALXPROCESSQUEUE)( ALXdevice *mixer );
+typedef ALXint          (ALX_APIENTRY *LPALXGETPOLLDESCRIPTORS)( ALXdevice *mixer, ALXpollfd *fds, ALXint count );
+typedef ALXint          (ALX_APIENTRY *LPALXPROCESSEVENTS)( ALXdevice *mixer );
+typedef ALXint          (ALX_APIENTRY *LPALXGENBUS)( ALXdevice *mixer, ALXint parent );
+typedef void            (ALX_APIENTRY *LPALXDELETEBUS)( ALXdevice *mixer, ALXint bus );
+typedef void            (ALX_APIENTRY *LPALXATTACHSOURCE)( ALXdevice *mixer, ALXint bus, ALXuint source );
+typedef void            (ALX_APIENTRY *LPALXDETACHSOURCE)( ALXdevice *mixer, ALXuint source );
+typedef ALXboolean      (ALX_APIENTRY *LPALXSETCAPTURETAP)( ALXdevice *mixer, ALXenum format, ALXint frames, ALXint window );
+typedef ALXint          (ALX_APIENTRY *LPALXPUMPCAPTURETAP)( ALXdevice *mixer );
+typedef ALXuint         (ALX_APIENTRY *LPALXGETCAPTUREPOSITION)( ALXdevice *mixer );
+typedef const void *    (ALX_APIENTRY *LPALXGETCAPTUREWINDOW)( ALXdevice *mixer, ALXuint position, ALXint frames );
+typedef ALXboolean      (ALX_APIENTRY *LPALXISCAPTUREWINDOWVALID)( ALXdevice *mixer, ALXuint position );
+typedef ALXboolean      (ALX_APIENTRY *LPALXMEASURELEVELS)( ALXenum type, ALXint channels, const void *samples, ALXint frames, ALXint what, ALXlevel *levels );
+typedef ALXloudness *   (ALX_APIENTRY *LPALXCREATELOUDNESSMETER)( ALXint rate, ALXint channels );
+typedef void            (ALX_APIENTRY *LPALXDELETELOUDNESSMETER)( ALXloudness *meter );
+typedef void            (ALX_APIENTRY *LPALXRESETLOUDNESSMETER)( ALXloudness *meter );
+typedef ALXboolean      (ALX_APIENTRY *LPALXADDLOUDNESSSAMPLES)( ALXloudness *meter, ALXenum type, const void *samples, ALXint frames );
+typedef ALXfloat        (ALX_APIENTRY *LPALXGETLOUDNESS)( ALXloudness *meter, ALXenum param );
+typedef ALXboolean      (ALX_APIENTRY *LPALXSETLOUDNESSTARGET)( ALXloudness *meter, ALXdevice *mixer, ALXenum param, ALXint index, ALXfloat target, ALXfloat rate );
+typedef ALXducker *     (ALX_APIENTRY *LPALXCREATEDUCKER)( ALXint rate );
+typedef void            (ALX_APIENTRY *LPALXDELETEDUCKER)( ALXducker *ducker );
+typedef ALXboolean      (ALX_APIENTRY *LPALXADDDUCKTARGET)( ALXducker *ducker, ALXdevice *mixer, ALXenum param, ALXint index, ALXfloat depth );
+typedef void            (ALX_APIENTRY *LPALXREMOVEDUCKTARGETS)( ALXducker *ducker, ALXdevice *mixer );
+typedef ALXfloat        (ALX_APIENTRY *LPALXGETDUCKERFLOAT)( ALXducker *ducker, ALXenum param );
+typedef void            (ALX_APIENTRY *LPALXSETDUCKERFLOAT)( ALXducker *ducker, ALXenum param, ALXfloat value );
+typedef ALXboolean      (ALX_APIENTRY *LPALXPROCESSDUCKER)( ALXducker *ducker, ALXenum type, ALXint channels, const void *samples, ALXint frames );
+typedef ALXboolean      (ALX_APIENTRY *LPALXSETCAPTUREDUCKER)( ALXdevice *mixer, ALXducker *ducker );
+typedef ALXboolean      (ALX_APIENTRY *LPALXPROCESSTONE)( ALXdevice *mixer, ALXenum type, ALXint channels, ALXint rate, void *samples, ALXint frames );
+typedef ALXenvelope *   (ALX_APIENTRY *LPALXCREATEENVELOPE)( ALXint points );
+typedef void            (ALX_APIENTRY *LPALXDELETEENVELOPE)( ALXenvelope *envelope );
+typedef ALXboolean      (ALX_APIENTRY *LPALXADDENVELOPEPOINT)( ALXenvelope *envelope, ALXuint position, ALXfloat gain );
+typedef void            (ALX_APIENTRY *LPALXCLEARENVELOPE)( ALXenvelope *envelope );
+typedef ALXfloat        (ALX_APIENTRY *LPALXGETENVELOPEGAIN)( ALXenvelope *envelope );
+typedef ALXboolean      (ALX_APIENTRY *LPALXPROCESSENVELOPE)( ALXenvelope *envelope, ALXenum type, ALXint channels, ALXuint position, void *samples, ALXint frames );
+typedef ALXboolean      (ALX_APIENTRY *LPALXSETENVELOPETARGET)( ALXenvelope *envelope, ALXdevice *mixer, ALXenum param, ALXint index );
+typedef void            (ALX_APIENTRY *LPALXADVANCEENVELOPE)( ALXenvelope *envelope, ALXuint position );
+typedef void            (ALX_APIENTRY *LPALXSETALLOCATOR)( LPALXALLOC allocFunc, LPALXFREE freeFunc, void *userdata );
+typedef ALXint          (ALX_APIENTRY *LPALXGETCHANGESSINCE)( ALXdevice *mixer, ALXint generation, ALXchange *changes, ALXint count );
+typedef ALXboolean      (ALX_APIENTRY *LPALXPUBLISHSHAREDSTATE)( const ALXchar *name );
+typedef const ALXsharedState * (ALX_APIENTRY *LPALXATTACHSHAREDSTATE)( const ALXchar *name );
+typedef ALXboolean      (ALX_APIENTRY *LPALXREADSHAREDDEVICE)( const ALXsharedState *state, ALXint index, ALXsharedDevice *values );
+typedef void            (ALX_APIENTRY *LPALXDETACHSHAREDSTATE)( const ALXsharedState *state );
+typedef ALXboolean      (ALX_APIENTRY *LPALXSTARTTRACE)( const ALXchar *filename, ALXint records );
+typedef void            (ALX_APIENTRY *LPALXSTOPTRACE)( void );
+typedef ALXboolean      (ALX_APIENTRY *LPALXSTARTEVENTTRACE)( const ALXchar *filename );
+typedef void            (ALX_APIENTRY *LPALXSTOPEVENTTRACE)( void );
+typedef void            (ALX_APIENTRY *LPALXGETINTEGERV)( ALXdevice *mixer, ALXenum param, ALXint index, ALXint *values );
+typedef void            (ALX_APIENTRY *LPALXSETINTEGERV)( ALXdevice *mixer, ALXenum param, ALXint index, const ALXint *values );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETMASTERVOLUME)( ALXdevice *mixer, ALXfloat *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETMASTERVOLUME)( ALXdevice *mixer, ALXfloat value );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETMASTERMUTE)( ALXdevice *mixer, ALXboolean *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETMASTERMUTE)( ALXdevice *mixer, ALXboolean value );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETPCMOUTPUTVOLUME)( ALXdevice *mixer, ALXfloat *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETPCMOUTPUTVOLUME)( ALXdevice *mixer, ALXfloat value );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETPCMOUTPUTMUTE)( ALXdevice *mixer, ALXboolean *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETPCMOUTPUTMUTE)( ALXdevice *mixer, ALXboolean value );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETINPUTVOLUME)( ALXdevice *mixer, ALXfloat *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETINPUTVOLUME)( ALXdevice *mixer, ALXfloat value );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETINPUTSOURCE)( ALXdevice *mixer, ALXint *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETINPUTSOURCE)( ALXdevice *mixer, ALXint value );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETOUTPUTVOLUME)( ALXdevice *mixer, ALXint index, ALXfloat *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETOUTPUTVOLUME)( ALXdevice *mixer, ALXint index, ALXfloat value );
+typedef ALXenum         (ALX_APIENTRY *LPALXGETOUTPUTMUTE)( ALXdevice *mixer, ALXint index, ALXboolean *value );
+typedef ALXenum         (ALX_APIENTRY *LPALXSETOUTPUTMUTE)( ALXdevice *mixer, ALXint index, ALXboolean value );
+typedef ALXint          (ALX_APIENTRY *LPALXGETOUTPUTCOUNT)( ALXdevice *mixer );
+typedef const ALXchar * (ALX_APIENTRY *LPALXGETOUTPUTNAME)( ALXdevice *mixer, ALXint index );
+typedef ALXint          (ALX_APIENTRY *LPALXGETINPUTSOURCECOUNT)( ALXdevice *mixer );
+typedef const ALXchar * (ALX_APIENTRY *LPALXGETINPUTSOURCENAME)( ALXdevice *mixer, ALXint index );
 
 
 #if defined(TARGET_OS_MAC) && TARGET_OS_MAC
@@ -0,0 +1,319 @@
+/*
+ * ALx
+ * ALx C++ API Header File
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef AL_ALX_HPP
+#define AL_ALX_HPP
+
+/*
+ * Header only C++17 wrapper over the typed entry points of alx.h.
+ *
+ * Parameters are tag types, so asking a control for a value of the
+ * wrong type, or forgetting the index of an indexed one, fails to
+ * compile instead of setting ALX_INVALID_ENUM:
+ *
+ *     alx::device dev = alx::device::open(name);
+ *     float level = dev.get<alx::MasterVolume>();
+ *     dev.set<alx::OutputMute>(i, true);
+ *
+ * get and set throw alx::error; read and write return the status.
+ */
+
+#include <alx.h>
+
+#include <exception>
+#include <string_view>
+#include <utility>
+
+namespace alx {
+
+/*
+    Status other than ALX_NO_ERROR
+*/
+class error : public std::exception
+{
+public:
+    explicit error(ALXenum code) noexcept : _code(code) {}
+
+    ALXenum code() const noexcept { return _code; }
+
+    const char *what() const noexcept override {
+        switch (_code) {
+        case ALX_INVALID_DEVICE:    return "alx: invalid device";
+        case ALX_INVALID_ENUM:      return "alx: invalid enum";
+        case ALX_INVALID_VALUE:     return "alx: invalid value";
+        case ALX_OUT_OF_MEMORY:     return "alx: out of memory";
+        case ALX_INVALID_OPERATION: return "alx: invalid operation";
+        default:                    return "alx: error";
+        }
+    }
+
+private:
+    ALXenum _code;
+};
+
+namespace detail {
+
+inline void check(ALXenum status)
+{
+    if (status != ALX_NO_ERROR)
+        throw error(status);
+}
+
+inline bool flag(ALXboolean value) { return value != ALX_FALSE; }
+inline ALXboolean flag(bool value) { return value ? ALX_TRUE : ALX_FALSE; }
+
+} // namespace detail
+
+///////////////////////////////////////////////////////
+// Parameters
+//
+// Each tag names its value type, whether it takes an index, and the
+// typed entry points behind it.
+
+struct MasterVolume
+{
+    typedef float value_type;
+    static constexpr bool indexed = false;
+    static ALXenum get(ALXdevice *d, float &v) { return alxGetMasterVolume(d, &v); }
+    static ALXenum set(ALXdevice *d, float v) { return alxSetMasterVolume(d, v); }
+};
+
+struct MasterMute
+{
+    typedef bool value_type;
+    static constexpr bool indexed = false;
+    static ALXenum get(ALXdevice *d, bool &v) {
+        ALXboolean b;
+        ALXenum status = alxGetMasterMute(d, &b);
+        if (status == ALX_NO_ERROR)
+            v = detail::flag(b);
+        return status;
+    }
+    static ALXenum set(ALXdevice *d, bool v) { return alxSetMasterMute(d, detail::flag(v)); }
+};
+
+struct PCMVolume
+{
+    typedef float value_type;
+    static constexpr bool indexed = false;
+    static ALXenum get(ALXdevice *d, float &v) { return alxGetPCMOutputVolume(d, &v); }
+    static ALXenum set(ALXdevice *d, float v) { return alxSetPCMOutputVolume(d, v); }
+};
+
+struct PCMMute
+{
+    typedef bool value_type;
+    static constexpr bool indexed = false;
+    static ALXenum get(ALXdevice *d, bool &v) {
+        ALXboolean b;
+        ALXenum status = alxGetPCMOutputMute(d, &b);
+        if (status == ALX_NO_ERROR)
+            v = detail::flag(b);
+        return status;
+    }
+    static ALXenum set(ALXdevice *d, bool v) { return alxSetPCMOutputMute(d, detail::flag(v)); }
+};
+
+struct InputVolume
+{
+    typedef float value_type;
+    static constexpr bool indexed = false;
+    static ALXenum get(ALXdevice *d, float &v) { return alxGetInputVolume(d, &v); }
+    static ALXenum set(ALXdevice *d, float v) { return alxSetInputVolume(d, v); }
+};
+
+struct InputSource
+{
+    typedef int value_type;
+    static constexpr bool indexed = false;
+    static ALXenum get(ALXdevice *d, int &v) { return alxGetInputSource(d, &v); }
+    static ALXenum set(ALXdevice *d, int v) { return alxSetInputSource(d, v); }
+};
+
+struct OutputVolume
+{
+    typedef float value_type;
+    static constexpr bool indexed = true;
+    static ALXenum get(ALXdevice *d, int i, float &v) { return alxGetOutputVolume(d, i, &v); }
+    static ALXenum set(ALXdevice *d, int i, float v) { return alxSetOutputVolume(d, i, v); }
+};
+
+struct OutputMute
+{
+    typedef bool value_type;
+    static constexpr bool indexed = true;
+    static ALXenum get(ALXdevice *d, int i, bool &v) {
+        ALXboolean b;
+        ALXenum status = alxGetOutputMute(d, i, &b);
+        if (status == ALX_NO_ERROR)
+            v = detail::flag(b);
+        return status;
+    }
+    static ALXenum set(ALXdevice *d, int i, bool v) {
+        return alxSetOutputMute(d, i, detail::flag(v));
+    }
+};
+
+///////////////////////////////////////////////////////
+// Device
+
+/*
+    Owns an ALXdevice, closed when the object goes away. Movable, not
+    copyable.
+*/
+class device
+{
+public:
+    device() noexcept : _mixer(nullptr) {}
+    explicit device(ALXdevice *mixer) noexcept : _mixer(mixer) {}
+
+    device(device &&other) noexcept : _mixer(other.release()) {}
+
+    device &operator =(device &&other) noexcept {
+        if (this != &other)
+            reset(other.release());
+        return *this;
+    }
+
+    device(const device &) = delete;
+    device &operator =(const device &) = delete;
+
+    ~device() { reset(); }
+
+    static device open(const char *name) { return opened(alxOpenDevice(name)); }
+    static device open_capture(const char *name) { return opened(alxOpenCaptureDevice(name)); }
+    static device map(ALCdevice *alc) { return opened(alxMapDevice(alc)); }
+    static device map_capture(ALCdevice *alc) { return opened(alxMapCaptureDevice(alc)); }
+
+    ALXdevice *handle() const noexcept { return _mixer; }
+    explicit operator bool() const noexcept { return _mixer != nullptr; }
+
+    ALXdevice *release() noexcept {
+        ALXdevice *mixer = _mixer;
+        _mixer = nullptr;
+        return mixer;
+    }
+
+    void reset(ALXdevice *mixer = nullptr) noexcept {
+        if (_mixer)
+            alxCloseDevice(_mixer);
+        _mixer = mixer;
+    }
+
+    template<typename P>
+    typename P::value_type get() const {
+        static_assert(!P::indexed, "this parameter takes an index");
+        typename P::value_type value{};
+        detail::check(P::get(_mixer, value));
+        return value;
+    }
+
+    template<typename P>
+    typename P::value_type get(int index) const {
+        static_assert(P::indexed, "this parameter takes no index");
+        typename P::value_type value{};
+        detail::check(P::get(_mixer, index, value));
+        return value;
+    }
+
+    template<typename P>
+    void set(typename P::value_type value) {
+        static_assert(!P::indexed, "this parameter takes an index");
+        detail::check(P::set(_mixer, value));
+    }
+
+    template<typename P>
+    void set(int index, typename P::value_type value) {
+        static_assert(P::indexed, "this parameter takes no index");
+        detail::check(P::set(_mixer, index, value));
+    }
+
+    template<typename P>
+    ALXenum read(typename P::value_type &value) const noexcept {
+        static_assert(!P::indexed, "this parameter takes an index");
+        return P::get(_mixer, value);
+    }
+
+    template<typename P>
+    ALXenum read(int index, typename P::value_type &value) const noexcept {
+        static_assert(P::indexed, "this parameter takes no index");
+        return P::get(_mixer, index, value);
+    }
+
+    template<typename P>
+    ALXenum write(typename P::value_type value) noexcept {
+        static_assert(!P::indexed, "this parameter takes an index");
+        return P::set(_mixer, value);
+    }
+
+    template<typename P>
+    ALXenum write(int index, typename P::value_type value) noexcept {
+        static_assert(P::indexed, "this parameter takes no index");
+        return P::set(_mixer, index, value);
+    }
+
+    int outputs() const noexcept { return alxGetOutputCount(_mixer); }
+    int input_sources() const noexcept { return alxGetInputSourceCount(_mixer); }
+
+    /*
+        Names point into the device, and are empty for a bad index.
+    */
+    std::string_view output_name(int index) const noexcept {
+        return view(alxGetOutputName(_mixer, index));
+    }
+
+    std::string_view input_source_name(int index) const noexcept {
+        return view(alxGetInputSourceName(_mixer, index));
+    }
+
+private:
+    ALXdevice *_mixer;
+
+    static device opened(ALXdevice *mixer) {
+        if (mixer == nullptr) {
+            ALXenum code = alxGetError(nullptr);
+            throw error(code != ALX_NO_ERROR ? code : ALX_INVALID_DEVICE);
+        }
+        return device(mixer);
+    }
+
+    static std::string_view view(const ALXchar *name) noexcept {
+        return name ? std::string_view(name) : std::string_view();
+    }
+};
+
+} // namespace alx
+
+#endif /* AL_ALX_HPP */
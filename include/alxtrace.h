@@ -0,0 +1,109 @@
+/*
+ * ALx
+ * ALx driver trace file format
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef AL_ALXTRACE_H
+#define AL_ALXTRACE_H
+
+/*
+ * alxStartTrace records every call ALx makes to the mixer driver in a
+ * memory-mapped ring file: the header below followed by 'capacity'
+ * fixed size records. Record n is stored at n % capacity, so once the
+ * ring is full it keeps the last 'capacity' calls. Both ends run on the
+ * same host; the file is in host byte order.
+ */
+
+#include <alx.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if defined(_MSC_VER)
+typedef __int64 ALXint64;
+#else
+typedef long long ALXint64;
+#endif
+
+#define ALX_TRACE_MAGIC                          0x54584C41 /* 'ALXT' */
+#define ALX_TRACE_VERSION                        1
+
+/**
+ * Driver calls
+ */
+#define ALX_TRACE_OPEN                           1
+#define ALX_TRACE_CLOSE                          2
+#define ALX_TRACE_GET_DEV_CAPS                   3
+#define ALX_TRACE_GET_LINE_INFO                  4
+#define ALX_TRACE_GET_LINE_CONTROLS              5
+#define ALX_TRACE_GET_CONTROL_DETAILS            6
+#define ALX_TRACE_SET_CONTROL_DETAILS            7
+
+typedef struct ALXtraceHeader_struct
+{
+    ALXint              magic;
+    ALXint              version;
+    ALXint              capacity;       /* records in the ring */
+    ALXint              recordSize;
+    volatile ALXint     count;          /* records written so far */
+    ALXint              reserved;
+    ALXint64            started;        /* seconds since 1970 */
+} ALXtraceHeader;
+
+/*
+ * 'id' is what the call was asked about: a control id for the control
+ * details calls, and the line id, control id, component or control type
+ * for the line calls, according to 'flags'. 'value' is what the call
+ * read or wrote: the first value of a control, the index of the first
+ * item set in a list of booleans, or the line or control id found.
+ */
+typedef struct ALXtraceRecord_struct
+{
+    ALXint64            start;          /* microseconds since the trace started */
+    unsigned int        duration;       /* microseconds */
+    unsigned short      call;           /* ALX_TRACE_* */
+    unsigned short      items;          /* multiple items of the control */
+    unsigned int        mixer;          /* mixer handle, low 32 bits */
+    unsigned int        id;
+    unsigned int        flags;          /* driver call flags */
+    unsigned int        value;
+    unsigned int        result;         /* MMRESULT */
+    unsigned int        reserved;
+} ALXtraceRecord;
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* AL_ALXTRACE_H */
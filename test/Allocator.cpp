@@ -0,0 +1,183 @@
+/*
+ * Allocator testing
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * Opens every mixer device through a counting allocator, then checks
+ * that getting and setting values allocates nothing, and that closing
+ * a device gives everything back. Under the debug CRT, allocations that
+ * bypass the user allocator are caught too; like ALx_realtime, this
+ * test is built with the library sources for that.
+ *
+ * Exits with 0 on success and 1 on failure.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+
+#include <alx.h>
+
+#define ROUNDS      100
+
+static long userAllocs = 0;
+static long userFrees = 0;
+static long crtAllocs = 0;
+
+static void * ALX_APIENTRY countingAlloc(size_t size, void *userdata)
+{
+    ++*(long *) userdata;
+    return malloc(size);
+}
+
+static void ALX_APIENTRY countingFree(void *ptr, void *)
+{
+    ++userFrees;
+    free(ptr);
+}
+
+#if defined(_DEBUG)
+static int allocHook(int allocType, void *, size_t, int, long, const unsigned char *, int)
+{
+    if (allocType != _HOOK_FREE)
+        ++crtAllocs;
+    return TRUE;
+}
+#endif
+
+static int check(bool condition, const char *what, const char *deviceName)
+{
+    printf("%s: %s (%s)\n", condition ? "ok" : "FAILED", what, deviceName);
+    return condition ? 0 : 1;
+}
+
+static void exercise(ALXdevice *mixer)
+{
+    ALXint i, n, round, current;
+    ALXfloat value;
+    ALXboolean flag;
+
+    for (round = 0; round < ROUNDS; ++round) {
+        value = alxGetFloat(mixer, ALX_MASTER_VOLUME);
+        if (value >= 0.0f)
+            alxSetFloat(mixer, ALX_MASTER_VOLUME, value);
+        flag = alxGetBoolean(mixer, ALX_MASTER_VOLUME);
+        alxSetBoolean(mixer, ALX_MASTER_VOLUME, flag);
+
+        value = alxGetFloat(mixer, ALX_INPUT_VOLUME);
+        if (value >= 0.0f)
+            alxSetFloat(mixer, ALX_INPUT_VOLUME, value);
+
+        n = alxGetInteger(mixer, ALX_OUTPUT_VOLUME_SPECIFIER);
+        for (i = 0; i < n; ++i) {
+            (void) alxGetIndexedString(mixer, ALX_OUTPUT_VOLUME_SPECIFIER, i);
+            value = alxGetIndexedFloat(mixer, ALX_OUTPUT_VOLUME, i);
+            if (value >= 0.0f)
+                alxSetIndexedFloat(mixer, ALX_OUTPUT_VOLUME, i, value);
+            flag = alxGetIndexedBoolean(mixer, ALX_OUTPUT_VOLUME, i);
+            alxSetIndexedBoolean(mixer, ALX_OUTPUT_VOLUME, i, flag);
+        }
+
+        // the source recorded from is the one not disabled
+        n = alxGetInteger(mixer, ALX_INPUT_SOURCE_SPECIFIER);
+        for (i = 0, current = -1; i < n; ++i) {
+            (void) alxGetIndexedString(mixer, ALX_INPUT_SOURCE_SPECIFIER, i);
+            if (!alxGetIndexedBoolean(mixer, ALX_INPUT_SOURCE, i))
+                current = i;
+        }
+        if (current >= 0)
+            alxSetInteger(mixer, ALX_INPUT_SOURCE, current);
+
+        (void) alxGetError(mixer);
+    }
+}
+
+static int testDevice(ALXdevice *(ALX_APIENTRY *openDevice)(const ALXchar *), const ALXchar *deviceName)
+{
+    ALXdevice *mixer;
+    long opened;
+    int failures = 0;
+
+    userAllocs = userFrees = 0;
+    mixer = openDevice(deviceName);
+    if (mixer == NULL)
+        return 0;
+
+    failures += check(userAllocs > 0, "device memory comes from the user allocator", deviceName);
+
+    opened = userAllocs;
+    crtAllocs = 0;
+#if defined(_DEBUG)
+    _CrtSetAllocHook(allocHook);
+#endif
+    exercise(mixer);
+#if defined(_DEBUG)
+    _CrtSetAllocHook(NULL);
+#endif
+    failures += check(userAllocs == opened, "get and set use no user memory", deviceName);
+    failures += check(crtAllocs == 0, "get and set use no heap memory", deviceName);
+
+    alxCloseDevice(mixer);
+    failures += check(userFrees == userAllocs, "closing gives all memory back", deviceName);
+
+    return failures;
+}
+
+int main()
+{
+    const ALXchar *names;
+    ALXchar list[2048];
+    const ALXchar *name;
+    int failures = 0;
+
+    alxSetAllocator(countingAlloc, countingFree, &userAllocs);
+
+    /* device lists are static, but copy them before opening devices */
+    names = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+    memcpy(list, names, sizeof(list));
+    for (name = list; *name; name += strlen(name) + 1)
+        failures += testDevice(alxOpenDevice, name);
+
+    names = alxGetString(NULL, ALX_CAPTURE_DEVICE_SPECIFIER);
+    memcpy(list, names, sizeof(list));
+    for (name = list; *name; name += strlen(name) + 1)
+        failures += testDevice(alxOpenCaptureDevice, name);
+
+    alxSetAllocator(NULL, NULL, NULL);
+
+    return failures ? 1 : 0;
+}
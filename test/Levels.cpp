@@ -0,0 +1,560 @@
+/*
+ * Level analysis testing and benchmark
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * Measures the same noise with every instruction set the processor
+ * supports, checking the results against the scalar reference, checks
+ * the loudness meter against EBU Tech 3341 and 3342 signals, the
+ * ducker's timing, where an envelope's gain lands and the gains of
+ * the tone filter's shelves and peaks and of the noise gate, then
+ * reports how many frames per second each one measures, for int16 and
+ * float blocks at a few channel counts.
+ *
+ * Exits with 0 on success, 1 on failure.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Windows.h>
+
+#include <alx.h>
+#include "../win32/Levels.h"
+
+#define FRAMES          48000
+#define BENCH_SECONDS   0.5
+
+static float floats[FRAMES * ALX_MAX_LEVEL_CHANNELS];
+static short shorts[FRAMES * ALX_MAX_LEVEL_CHANNELS];
+
+static const ALXint ISAs[] = { ALX_ISA_SCALAR, ALX_ISA_SSE2, ALX_ISA_AVX2 };
+static const char *ISANames[] = { "scalar", "sse2", "avx2" };
+static const ALXint Channels[] = { 1, 2, 6, 8, 32 };
+
+static int check(bool condition, const char *what)
+{
+    printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    return condition ? 0 : 1;
+}
+
+static double now()
+{
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double) counter.QuadPart / (double) frequency.QuadPart;
+}
+
+static const void *samples(ALXenum type)
+{
+    return type == ALX_SAMPLE_INT16 ? (const void *) shorts : (const void *) floats;
+}
+
+/*
+    Two consecutive blocks, so true peak goes through its history too
+*/
+static void measure(ALXenum type, ALXint channels, ALXint frames, ALXlevel *levels)
+{
+    memset(levels, 0, ALX_MAX_LEVEL_CHANNELS * sizeof(ALXlevel));
+    alxMeasureLevels(type, channels, samples(type), frames, ALX_LEVEL_RMS | ALX_LEVEL_PEAK | ALX_LEVEL_TRUE_PEAK, levels);
+    alxMeasureLevels(type, channels, samples(type), frames, ALX_LEVEL_RMS | ALX_LEVEL_PEAK | ALX_LEVEL_TRUE_PEAK, levels);
+}
+
+static bool same(const ALXlevel *a, const ALXlevel *b, ALXint channels)
+{
+    ALXint c;
+
+    for (c = 0; c < channels; ++c) {
+        if (fabs(a[c].rms - b[c].rms) > 1e-5 || fabs(a[c].peak - b[c].peak) > 1e-6
+            || fabs(a[c].truePeak - b[c].truePeak) > 1e-5)
+            return false;
+    }
+    return true;
+}
+
+static void loudness(ALXint channels, ALXfloat *values)
+{
+    ALXloudness *meter = alxCreateLoudnessMeter(48000, channels);
+
+    alxAddLoudnessSamples(meter, ALX_SAMPLE_FLOAT32, floats, FRAMES - 7);
+    alxAddLoudnessSamples(meter, ALX_SAMPLE_FLOAT32, floats, FRAMES - 7);
+    values[0] = alxGetLoudness(meter, ALX_LOUDNESS_MOMENTARY);
+    values[1] = alxGetLoudness(meter, ALX_LOUDNESS_INTEGRATED);
+    alxDeleteLoudnessMeter(meter);
+}
+
+/*
+    The tone filter, bass up, treble down and every other band moved,
+    run over both sample types at every channel count
+*/
+static void filterTone(ALXenum type, ALXint channels, void *block)
+{
+    alx::ToneFilter *filter = new alx::ToneFilter;
+    int stage;
+
+    filter->setLevel(alx::ToneFilter::Bass, 0.9f);
+    filter->setLevel(alx::ToneFilter::Treble, 0.2f);
+    for (stage = alx::ToneFilter::FirstBand; stage < ALX_TONE_STAGES; stage += 2)
+        filter->setLevel(stage, (stage & 2) ? 0.8f : 0.1f);
+
+    memcpy(block, samples(type), (FRAMES - 7) * channels * (type == ALX_SAMPLE_INT16 ? sizeof(short) : sizeof(float)));
+    filter->process(type, channels, 48000, block, FRAMES - 7);
+    delete filter;
+}
+
+static bool sameTone(ALXint isa, ALXenum type, ALXint channels)
+{
+    static float expected[FRAMES * ALX_MAX_LEVEL_CHANNELS], filtered[FRAMES * ALX_MAX_LEVEL_CHANNELS];
+    const short *a = (const short *) expected, *b = (const short *) filtered;
+    int i;
+
+    alxSetInteger(NULL, ALX_LEVEL_ISA, ALX_ISA_SCALAR);
+    filterTone(type, channels, expected);
+    alxSetInteger(NULL, ALX_LEVEL_ISA, isa);
+    filterTone(type, channels, filtered);
+
+    for (i = 0; i < (FRAMES - 7) * channels; ++i) {
+        if (type == ALX_SAMPLE_INT16 ? abs(a[i] - b[i]) > 1 : fabs(expected[i] - filtered[i]) > 1e-5)
+            return false;
+    }
+    return true;
+}
+
+/*
+    The gate expanding quiet noise, its gain moving across every chunk
+*/
+static void gateNoise(ALXenum type, ALXint channels, void *block)
+{
+    alx::NoiseGate *gate = new alx::NoiseGate;
+    float *x = (float *) block;
+    short *p = (short *) block;
+    int i;
+
+    gate->set(alx::NoiseGate::Threshold, -20.0f);
+    gate->set(alx::NoiseGate::Ratio, 3.0f);
+    gate->set(alx::NoiseGate::Release, 5.0f);
+
+    for (i = 0; i < (FRAMES - 7) * channels; ++i) {
+        if (type == ALX_SAMPLE_INT16)
+            p[i] = shorts[i] / 16;
+        else
+            x[i] = floats[i] / 16.0f;
+    }
+    gate->process(type, channels, 48000, block, FRAMES - 7);
+    delete gate;
+}
+
+static bool sameGate(ALXint isa, ALXenum type, ALXint channels)
+{
+    static float expected[FRAMES * ALX_MAX_LEVEL_CHANNELS], gated[FRAMES * ALX_MAX_LEVEL_CHANNELS];
+    const short *a = (const short *) expected, *b = (const short *) gated;
+    int i;
+
+    alxSetInteger(NULL, ALX_LEVEL_ISA, ALX_ISA_SCALAR);
+    gateNoise(type, channels, expected);
+    alxSetInteger(NULL, ALX_LEVEL_ISA, isa);
+    gateNoise(type, channels, gated);
+
+    for (i = 0; i < (FRAMES - 7) * channels; ++i) {
+        if (type == ALX_SAMPLE_INT16 ? abs(a[i] - b[i]) > 1 : fabs(expected[i] - gated[i]) > 1e-6)
+            return false;
+    }
+    return true;
+}
+
+static int testISA(ALXint isa, const char *name)
+{
+    ALXlevel expected[ALX_MAX_LEVEL_CHANNELS], levels[ALX_MAX_LEVEL_CHANNELS];
+    char what[64];
+    int failures = 0, t;
+    unsigned i;
+
+    for (t = 0; t < 2; ++t) {
+        ALXenum type = t ? ALX_SAMPLE_INT16 : ALX_SAMPLE_FLOAT32;
+        bool agree = true;
+
+        for (i = 0; i < sizeof(Channels) / sizeof(Channels[0]); ++i) {
+            // an odd frame count leaves samples short of a whole period
+            alxSetInteger(NULL, ALX_LEVEL_ISA, ALX_ISA_SCALAR);
+            measure(type, Channels[i], FRAMES - 7, expected);
+            alxSetInteger(NULL, ALX_LEVEL_ISA, isa);
+            measure(type, Channels[i], FRAMES - 7, levels);
+            agree = agree && same(expected, levels, Channels[i]);
+        }
+
+        sprintf(what, "%s %s agrees with the scalar reference", name, t ? "int16" : "float");
+        failures += check(agree, what);
+    }
+
+    {
+        ALXfloat expected[2], values[2];
+        bool agree = true;
+
+        for (i = 0; i < sizeof(Channels) / sizeof(Channels[0]); ++i) {
+            alxSetInteger(NULL, ALX_LEVEL_ISA, ALX_ISA_SCALAR);
+            loudness(Channels[i], expected);
+            alxSetInteger(NULL, ALX_LEVEL_ISA, isa);
+            loudness(Channels[i], values);
+            agree = agree && fabs(expected[0] - values[0]) < 1e-4 && fabs(expected[1] - values[1]) < 1e-4;
+        }
+
+        sprintf(what, "%s loudness agrees with the scalar reference", name);
+        failures += check(agree, what);
+    }
+
+    for (t = 0; t < 2; ++t) {
+        ALXenum type = t ? ALX_SAMPLE_INT16 : ALX_SAMPLE_FLOAT32;
+        bool agree = true;
+
+        for (i = 0; i < sizeof(Channels) / sizeof(Channels[0]); ++i)
+            agree = agree && sameTone(isa, type, Channels[i]);
+
+        sprintf(what, "%s %s tone filter agrees with the scalar reference", name, t ? "int16" : "float");
+        failures += check(agree, what);
+    }
+
+    for (t = 0; t < 2; ++t) {
+        ALXenum type = t ? ALX_SAMPLE_INT16 : ALX_SAMPLE_FLOAT32;
+        bool agree = true;
+
+        for (i = 0; i < sizeof(Channels) / sizeof(Channels[0]); ++i)
+            agree = agree && sameGate(isa, type, Channels[i]);
+
+        sprintf(what, "%s %s noise gate agrees with the scalar reference", name, t ? "int16" : "float");
+        failures += check(agree, what);
+    }
+    return failures;
+}
+
+/*
+    'seconds' of a stereo 997 Hz tone 'dbfs' dB below full scale
+*/
+static void tone(ALXloudness *meter, double dbfs, int seconds)
+{
+    static float block[4800 * 2];
+    double amplitude = pow(10.0, dbfs / 20.0);
+    int n, f;
+
+    for (n = 0; n < seconds * 10; ++n) {
+        for (f = 0; f < 4800; ++f)
+            block[2 * f] = block[2 * f + 1] = (float) (amplitude * sin(2.0 * 3.14159265358979 * 997.0 * (n * 4800 + f) / 48000.0));
+        alxAddLoudnessSamples(meter, ALX_SAMPLE_FLOAT32, block, 4800);
+    }
+}
+
+static int testLoudness()
+{
+    ALXloudness *meter = alxCreateLoudnessMeter(48000, 2);
+    int failures = 0;
+
+    // the 3 s window holds 1 s of tone, then 2 s, and silence before it
+    tone(meter, -23.0, 1);
+    failures += check(fabs(alxGetLoudness(meter, ALX_LOUDNESS_SHORT_TERM) + 23.0 + 10.0 * log10(3.0)) < 0.1,
+        "short-term loudness after 1 s counts 2 s of silence");
+    tone(meter, -23.0, 1);
+    failures += check(fabs(alxGetLoudness(meter, ALX_LOUDNESS_SHORT_TERM) + 23.0 + 10.0 * log10(1.5)) < 0.1,
+        "short-term loudness after 2 s counts 1 s of silence");
+
+    tone(meter, -23.0, 18);
+    failures += check(fabs(alxGetLoudness(meter, ALX_LOUDNESS_MOMENTARY) + 23.0) < 0.1
+        && fabs(alxGetLoudness(meter, ALX_LOUDNESS_SHORT_TERM) + 23.0) < 0.1
+        && fabs(alxGetLoudness(meter, ALX_LOUDNESS_INTEGRATED) + 23.0) < 0.1,
+        "tone at -23 dBFS measures -23 LUFS");
+
+    // quiet parts fall under the gates
+    alxResetLoudnessMeter(meter);
+    tone(meter, -72.0, 10);
+    tone(meter, -36.0, 10);
+    tone(meter, -23.0, 60);
+    tone(meter, -36.0, 10);
+    tone(meter, -72.0, 10);
+    failures += check(fabs(alxGetLoudness(meter, ALX_LOUDNESS_INTEGRATED) + 23.0) < 0.1,
+        "gated integrated loudness");
+
+    alxResetLoudnessMeter(meter);
+    tone(meter, -20.0, 20);
+    tone(meter, -30.0, 20);
+    failures += check(fabs(alxGetLoudness(meter, ALX_LOUDNESS_RANGE) - 10.0) < 1.0,
+        "loudness range of -20 then -30 dBFS is 10 LU");
+
+    alxDeleteLoudnessMeter(meter);
+    return failures;
+}
+
+/*
+    10 ms blocks of a stereo 300 Hz tone over faint noise
+*/
+static void duck(ALXducker *ducker, double dbfs, int blocks)
+{
+    static short block[480 * 2];
+    double amplitude = pow(10.0, dbfs / 20.0);
+    int n, f;
+
+    for (n = 0; n < blocks; ++n) {
+        for (f = 0; f < 480; ++f) {
+            block[2 * f] = block[2 * f + 1] = (short) (32767.0 * (0.001 * (2.0 * rand() / RAND_MAX - 1.0)
+                + amplitude * sin(2.0 * 3.14159265358979 * 300.0 * f / 48000.0)));
+        }
+        alxProcessDucker(ducker, ALX_SAMPLE_INT16, 2, block, 480);
+    }
+}
+
+static int testDucker()
+{
+    ALXducker *ducker = alxCreateDucker(48000);
+    int failures = 0;
+
+    alxSetDuckerFloat(ducker, ALX_DUCK_ATTACK, 10.0f);
+    duck(ducker, -200.0, 50);
+    failures += check(alxGetDuckerFloat(ducker, ALX_DUCK_AMOUNT) == 0.0f, "noise does not duck");
+    duck(ducker, -20.0, 1);
+    failures += check(alxGetDuckerFloat(ducker, ALX_DUCK_AMOUNT) == 1.0f, "speech ducks within a block");
+    duck(ducker, -20.0, 100);
+    duck(ducker, -200.0, 29);
+    failures += check(alxGetDuckerFloat(ducker, ALX_DUCK_AMOUNT) == 1.0f, "ducking holds");
+    duck(ducker, -200.0, 51);
+    failures += check(alxGetDuckerFloat(ducker, ALX_DUCK_AMOUNT) == 0.0f, "ducking releases");
+
+    alxDeleteDucker(ducker);
+    return failures;
+}
+
+/*
+    Holds 1.0 up to 1000 frames past 'start', falls to 0.0 at 2000 and
+    rises to 0.5 at 3000, the clock wrapping around on the way. Blocks
+    of odd sizes cut across the points.
+*/
+static int testEnvelope()
+{
+    static float block[4000 * 2];
+    ALXenvelope *envelope = alxCreateEnvelope(4);
+    ALXuint start = 0xfffffc00u;
+    int failures = 0, done, n, i;
+    bool exact = true;
+
+    alxAddEnvelopePoint(envelope, start + 1000, 1.0f);
+    alxAddEnvelopePoint(envelope, start + 2000, 0.0f);
+    alxAddEnvelopePoint(envelope, start + 3000, 0.5f);
+    failures += check(alxAddEnvelopePoint(envelope, start + 2500, 1.0f) == ALX_FALSE
+        && alxGetError(NULL) == ALX_INVALID_VALUE, "envelope points stay in order");
+
+    for (i = 0; i < 4000 * 2; ++i)
+        block[i] = 1.0f;
+    for (done = 0; done < 4000; done += n) {
+        n = 4000 - done < 333 ? 4000 - done : 333;
+        alxProcessEnvelope(envelope, ALX_SAMPLE_FLOAT32, 2, start + done, block + 2 * done, n);
+    }
+
+    for (i = 0; i < 4000; ++i) {
+        double expected = i < 1000 ? 1.0 : i < 2000 ? (2000 - i) / 1000.0
+            : i < 3000 ? 0.5 * (i - 2000) / 1000.0 : 0.5;
+        if (fabs(block[2 * i] - expected) > 1e-5 || block[2 * i + 1] != block[2 * i])
+            exact = false;
+    }
+    failures += check(exact, "envelope gain lands on every frame");
+    failures += check(alxGetEnvelopeGain(envelope) == 0.5f, "envelope holds after its last point");
+
+    alxDeleteEnvelope(envelope);
+    return failures;
+}
+
+/*
+    dB a stage at 'level' takes a stereo sine at 'frequency' by, once
+    the filter settled
+*/
+static double toneGain(int stage, ALXfloat level, double frequency)
+{
+    static float block[48000 * 2];
+    alx::ToneFilter *filter = new alx::ToneFilter;
+    double in = 0.0, out = 0.0, x;
+    int i;
+
+    for (i = 0; i < 48000; ++i)
+        block[2 * i] = block[2 * i + 1] = (float) (0.1 * sin(2.0 * 3.14159265358979 * frequency * i / 48000.0));
+    filter->setLevel(stage, level);
+    filter->process(ALX_SAMPLE_FLOAT32, 2, 48000, block, 48000);
+    delete filter;
+
+    for (i = 24000; i < 48000; ++i) {
+        x = 0.1 * sin(2.0 * 3.14159265358979 * frequency * i / 48000.0);
+        in += x * x;
+        out += (double) block[2 * i] * block[2 * i];
+    }
+    return 10.0 * log10(out / in);
+}
+
+static int testTone()
+{
+    bool peaks = true;
+    int failures = 0, stage;
+
+    failures += check(fabs(toneGain(alx::ToneFilter::Bass, 1.0f, 20.0) - 12.0) < 0.1,
+        "bass at 1.0 lifts 20 Hz by 12 dB");
+    failures += check(fabs(toneGain(alx::ToneFilter::Treble, 1.0f, 20000.0) - 12.0) < 0.1,
+        "treble at 1.0 lifts 20 kHz by 12 dB");
+    failures += check(fabs(toneGain(alx::ToneFilter::Bass, 0.0f, 20.0) + 12.0) < 0.1,
+        "bass at 0.0 cuts 20 Hz by 12 dB");
+
+    for (stage = alx::ToneFilter::FirstBand; stage < ALX_TONE_STAGES; ++stage)
+        peaks = peaks && fabs(toneGain(stage, 1.0f, alx::ToneFilter::frequency(stage)) - 12.0) < 0.1;
+    failures += check(peaks, "every band at 1.0 lifts its center by 12 dB");
+
+    failures += check(fabs(toneGain(alx::ToneFilter::Bass, 0.5f, 20.0)) < 0.01,
+        "flat levels leave blocks alone");
+    return failures;
+}
+
+/*
+    The gain in dB the gate settles on for a stereo sine whose RMS is
+    'dbfs', with a whole period in every chunk so the level holds
+*/
+static double gateGain(double dbfs, ALXfloat threshold, ALXfloat ratio, ALXfloat range)
+{
+    static float block[48000 * 2];
+    alx::NoiseGate *gate = new alx::NoiseGate;
+    double amplitude = pow(10.0, dbfs / 20.0) * sqrt(2.0), gain;
+    int i;
+
+    for (i = 0; i < 48000; ++i)
+        block[2 * i] = block[2 * i + 1] = (float) (amplitude * sin(2.0 * 3.14159265358979 * i / ALX_GATE_CHUNK));
+    gate->set(alx::NoiseGate::Threshold, threshold);
+    gate->set(alx::NoiseGate::Ratio, ratio);
+    gate->set(alx::NoiseGate::Range, range);
+    gate->process(ALX_SAMPLE_FLOAT32, 2, 48000, block, 48000);
+    gain = gate->gain();
+    delete gate;
+    return gain;
+}
+
+static int testGate()
+{
+    int failures = 0;
+
+    failures += check(fabs(gateGain(-40.0, -30.0f, 2.0f, -60.0f) + 10.0) < 0.1,
+        "10 dB under the threshold at ratio 2 takes 10 dB off");
+    failures += check(fabs(gateGain(-40.0, -30.0f, 4.0f, -20.0f) + 20.0) < 0.1,
+        "the gate takes no more than its range off");
+    failures += check(gateGain(-20.0, -30.0f, 4.0f, -60.0f) == 0.0,
+        "levels over the threshold pass");
+    failures += check(gateGain(-40.0, -30.0f, 1.0f, -60.0f) == 0.0,
+        "ratio 1 leaves blocks alone");
+    return failures;
+}
+
+static void bench(ALXenum type, ALXint channels, ALXint what)
+{
+    ALXlevel levels[ALX_MAX_LEVEL_CHANNELS];
+    double start, seconds;
+    long frames;
+
+    memset(levels, 0, sizeof(levels));
+    start = now();
+    for (frames = 0; (seconds = now() - start) < BENCH_SECONDS; frames += FRAMES)
+        alxMeasureLevels(type, channels, samples(type), FRAMES, what, levels);
+
+    printf(" %12.0f", frames / seconds);
+}
+
+static void benchLoudness(ALXint channels)
+{
+    ALXloudness *meter = alxCreateLoudnessMeter(48000, channels);
+    double start, seconds;
+    long frames;
+
+    start = now();
+    for (frames = 0; (seconds = now() - start) < BENCH_SECONDS; frames += FRAMES)
+        alxAddLoudnessSamples(meter, ALX_SAMPLE_FLOAT32, floats, FRAMES);
+
+    printf(" %12.0f", frames / seconds);
+    alxDeleteLoudnessMeter(meter);
+}
+
+int main()
+{
+    int failures = 0, t;
+    unsigned i, j;
+
+    srand(1);
+    for (i = 0; i < FRAMES * ALX_MAX_LEVEL_CHANNELS; ++i) {
+        floats[i] = 0.7f * (2.0f * rand() / RAND_MAX - 1.0f);
+        shorts[i] = (short) (floats[i] * 32767.0f);
+    }
+
+    printf("best instruction set: %s\n",
+        ISANames[alxGetInteger(NULL, ALX_LEVEL_ISA) - ALX_ISA_SCALAR]);
+
+    for (i = 1; i < sizeof(ISAs) / sizeof(ISAs[0]); ++i) {
+        alxSetInteger(NULL, ALX_LEVEL_ISA, ISAs[i]);
+        if (alxGetError(NULL) != ALX_NO_ERROR)
+            printf("no %s, skipping\n", ISANames[i]);
+        else
+            failures += testISA(ISAs[i], ISANames[i]);
+    }
+    failures += testLoudness();
+    failures += testDucker();
+    failures += testEnvelope();
+    failures += testTone();
+    failures += testGate();
+
+    printf("\nframes/s        channels");
+    for (j = 0; j < sizeof(Channels) / sizeof(Channels[0]); ++j)
+        printf(" %12d", Channels[j]);
+    printf("\n");
+
+    for (i = 0; i < sizeof(ISAs) / sizeof(ISAs[0]); ++i) {
+        alxSetInteger(NULL, ALX_LEVEL_ISA, ISAs[i]);
+        if (alxGetError(NULL) != ALX_NO_ERROR)
+            continue;
+
+        for (t = 0; t < 4; ++t) {
+            ALXenum type = (t & 1) ? ALX_SAMPLE_INT16 : ALX_SAMPLE_FLOAT32;
+            ALXint what = (t & 2) ? ALX_LEVEL_TRUE_PEAK : ALX_LEVEL_RMS | ALX_LEVEL_PEAK;
+
+            printf("%-7s %-6s %-10s", ISANames[i], (t & 1) ? "int16" : "float",
+                (t & 2) ? "true peak" : "rms+peak");
+            for (j = 0; j < sizeof(Channels) / sizeof(Channels[0]); ++j)
+                bench(type, Channels[j], what);
+            printf("\n");
+        }
+
+        printf("%-7s %-6s %-10s", ISANames[i], "float", "loudness");
+        for (j = 0; j < sizeof(Channels) / sizeof(Channels[0]); ++j)
+            benchLoudness(Channels[j]);
+        printf("\n");
+    }
+
+    return failures ? 1 : 0;
+}
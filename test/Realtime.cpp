@@ -0,0 +1,228 @@
+/*
+ * Realtime command queue testing
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * One thread queues commands as an audio thread would while the main
+ * thread applies them. Allocations are counted in every build, through
+ * the allocator given to alxSetAllocator and a replaced operator new;
+ * this test is therefore built together with the library sources, so
+ * the library's own operator new calls are counted too. A ducker is
+ * then checked to move its target only through the queue.
+ *
+ * Exits with 0 on success, 1 on failure and SKIP_RETURN_CODE when there
+ * is no mixer device to test with.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <new>
+#include <Windows.h>
+
+#include <alx.h>
+
+#define QUEUE_SIZE          64
+#define NUM_COMMANDS        100000
+#define SKIP_RETURN_CODE    77
+
+static volatile DWORD producerThread = 0;
+static volatile LONG producerAllocs = 0;
+static volatile LONG producerDone = 0;
+static LONG queued = 0;
+
+static void countAllocation()
+{
+    if (GetCurrentThreadId() == producerThread)
+        InterlockedIncrement(&producerAllocs);
+}
+
+static void * ALX_APIENTRY countingAlloc(size_t size, void *)
+{
+    countAllocation();
+    return malloc(size);
+}
+
+static void ALX_APIENTRY countingFree(void *ptr, void *)
+{
+    free(ptr);
+}
+
+void *operator new(size_t size)
+{
+    void *ptr;
+
+    countAllocation();
+    ptr = malloc(size ? size : 1);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) throw()
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) throw()
+{
+    free(ptr);
+}
+
+static DWORD WINAPI producer(LPVOID param)
+{
+    ALXdevice *mixer = (ALXdevice *) param;
+    int i;
+
+    for (i = 0; i < NUM_COMMANDS; ++i) {
+        ALXboolean ok = (i & 1)
+            ? alxQueueBoolean(mixer, ALX_MASTER_VOLUME, -1, (i & 2) ? ALX_TRUE : ALX_FALSE)
+            : alxQueueFloat(mixer, ALX_MASTER_VOLUME, -1, (i % 100) / 100.0f);
+        if (ok)
+            ++queued;
+    }
+
+    InterlockedExchange(&producerDone, 1);
+    return 0;
+}
+
+/*
+    10 ms blocks of a stereo 300 Hz tone at 'amplitude' over faint noise
+*/
+static void duck(ALXducker *ducker, double amplitude, int blocks)
+{
+    static short block[480 * 2];
+    int n, f;
+
+    for (n = 0; n < blocks; ++n) {
+        for (f = 0; f < 480; ++f) {
+            block[2 * f] = block[2 * f + 1] = (short) (32767.0 * (0.001 * (2.0 * rand() / RAND_MAX - 1.0)
+                + amplitude * sin(2.0 * 3.14159265358979 * 300.0 * f / 48000.0)));
+        }
+        alxProcessDucker(ducker, ALX_SAMPLE_INT16, 2, block, 480);
+    }
+}
+
+static int check(bool condition, const char *what)
+{
+    printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    return condition ? 0 : 1;
+}
+
+int main()
+{
+    const ALXchar *names = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+    ALXdevice *mixer;
+    ALXducker *ducker;
+    ALXfloat volume;
+    ALXboolean mute;
+    HANDLE thread;
+    LONG applied = 0, dropped, overflow;
+    int failures = 0;
+    int i;
+
+    alxSetAllocator(countingAlloc, countingFree, NULL);
+
+    mixer = names && *names ? alxOpenDevice(names) : NULL;
+    if (mixer == NULL) {
+        printf("no mixer device, skipping\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    volume = alxGetFloat(mixer, ALX_MASTER_VOLUME);
+    mute = alxGetBoolean(mixer, ALX_MASTER_VOLUME);
+
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, QUEUE_SIZE);
+    failures += check(alxGetInteger(mixer, ALX_QUEUE_SIZE) == QUEUE_SIZE, "queue size");
+
+    thread = CreateThread(NULL, 0, producer, mixer, CREATE_SUSPENDED, (LPDWORD) &producerThread);
+    ResumeThread(thread);
+
+    while (!producerDone)
+        applied += alxProcessQueue(mixer);
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    applied += alxProcessQueue(mixer);
+
+    dropped = alxGetInteger(mixer, ALX_QUEUE_DROPPED);
+    failures += check(producerAllocs == 0, "no allocation on the producer thread");
+    failures += check(applied == queued, "every queued command applied");
+    failures += check(applied + dropped == NUM_COMMANDS, "applied and dropped add up");
+    failures += check(alxGetInteger(mixer, ALX_QUEUE_PENDING) == 0, "queue drained");
+
+    /* overflow without a consumer */
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, QUEUE_SIZE);
+    alxSetInteger(mixer, ALX_QUEUE_OVERFLOW, ALX_QUEUE_DROP_OLDEST);
+    for (i = 0; i < QUEUE_SIZE * 2; ++i)
+        alxQueueFloat(mixer, ALX_MASTER_VOLUME, -1, i / (QUEUE_SIZE * 2.0f));
+    overflow = alxGetInteger(mixer, ALX_QUEUE_DROPPED);
+    failures += check(overflow == QUEUE_SIZE, "drop oldest counts overwritten commands");
+    failures += check(alxProcessQueue(mixer) == QUEUE_SIZE, "drop oldest keeps the newest commands");
+
+    alxSetInteger(mixer, ALX_QUEUE_OVERFLOW, ALX_QUEUE_DROP_NEWEST);
+    for (i = 0; i < QUEUE_SIZE + 1; ++i)
+        alxQueueFloat(mixer, ALX_MASTER_VOLUME, -1, volume);
+    failures += check(alxQueueFloat(mixer, ALX_MASTER_VOLUME, -1, volume) == ALX_FALSE,
+        "drop newest rejects commands when full");
+    alxProcessQueue(mixer);
+
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, 0);
+    failures += check(alxQueueFloat(mixer, ALX_MASTER_VOLUME, -1, volume) == ALX_FALSE,
+        "no queue, no command");
+
+    /* the pump thread runs duckers, so their targets need a queue */
+    ducker = alxCreateDucker(48000);
+    alxSetDuckerFloat(ducker, ALX_DUCK_ATTACK, 10.0f);
+    failures += check(alxAddDuckTarget(ducker, mixer, ALX_MASTER_VOLUME, -1, -12.0f) == ALX_FALSE
+        && alxGetError(mixer) == ALX_INVALID_OPERATION, "no queue, no duck target");
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, QUEUE_SIZE);
+    failures += check(alxAddDuckTarget(ducker, mixer, ALX_MASTER_VOLUME, -1, -12.0f) != ALX_FALSE,
+        "duck target on a device with a queue");
+    duck(ducker, 0.0, 50);
+    duck(ducker, 0.1, 1);
+    failures += check(alxGetInteger(mixer, ALX_QUEUE_PENDING) == 1, "ducking writes through the queue");
+    alxDeleteDucker(ducker);
+    alxProcessQueue(mixer);
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, 0);
+
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, volume);
+    alxSetBoolean(mixer, ALX_MASTER_VOLUME, mute);
+    alxCloseDevice(mixer);
+
+    return failures ? 1 : 0;
+}
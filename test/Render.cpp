@@ -0,0 +1,414 @@
+/*
+ * Offline rendering testing
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * Renders through an ALC_SOFT_loopback device, so nothing is played
+ * to the sound hardware, and checks sample by sample the gains ALx
+ * sets against a rendering of the same source at unity gain. Then
+ * reports how many frames per second are rendered with each feature
+ * in use.
+ *
+ * The loopback device is mapped with alxMapDevice, which maps it even
+ * without a mixer device, on the OpenAL backend. Exits with 0 on
+ * success, 1 on failure and SKIP_RETURN_CODE when the extension or
+ * mono float rendering is missing.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <Windows.h>
+
+#include <al.h>
+#include <alc.h>
+
+#if HAVE_ALEXT_H
+#include <alext.h>
+#endif
+
+#include <alx.h>
+
+#ifndef ALC_SOFT_loopback
+#define ALC_SOFT_loopback 1
+#define ALC_FORMAT_CHANNELS_SOFT                 0x1990
+#define ALC_FORMAT_TYPE_SOFT                     0x1991
+#define ALC_MONO_SOFT                            0x1500
+#define ALC_FLOAT_SOFT                           0x1406
+typedef ALCdevice * (ALC_APIENTRY *LPALCLOOPBACKOPENDEVICESOFT)( const ALCchar *deviceName );
+typedef ALCboolean (ALC_APIENTRY *LPALCISRENDERFORMATSUPPORTEDSOFT)( ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type );
+typedef void (ALC_APIENTRY *LPALCRENDERSAMPLESSOFT)( ALCdevice *device, ALCvoid *buffer, ALCsizei samples );
+#endif
+
+#define FREQUENCY       48000
+#define TONE            1000
+#define BLOCK           256
+#define RAMP_BLOCKS     16
+#define CHECK_FRAMES    (BLOCK * RAMP_BLOCKS)
+#define TOLERANCE       1e-4f
+
+#define BENCH_SOURCES   32
+#define BENCH_BUSES     4
+#define BENCH_FRAMES    (FREQUENCY * 20)
+
+#define SKIP_RETURN_CODE    77
+
+static LPALCLOOPBACKOPENDEVICESOFT loopbackOpenDevice;
+static LPALCISRENDERFORMATSUPPORTEDSOFT isRenderFormatSupported;
+static LPALCRENDERSAMPLESSOFT renderSamples;
+
+static ALCdevice *device;
+static ALXdevice *mixer;
+
+static float reference[CHECK_FRAMES];
+static float output[CHECK_FRAMES];
+static float scratch[BLOCK];
+
+static int check(bool condition, const char *what)
+{
+    printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    return condition ? 0 : 1;
+}
+
+static double now()
+{
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double) counter.QuadPart / (double) frequency.QuadPart;
+}
+
+/*
+    One second of a tone, which loops without a seam
+*/
+static ALuint makeBuffer()
+{
+    static short samples[FREQUENCY];
+    ALuint buffer;
+    int i;
+
+    for (i = 0; i < FREQUENCY; ++i)
+        samples[i] = (short) (16384.0 * sin(2.0 * 3.14159265358979 * TONE * i / FREQUENCY));
+
+    alGenBuffers(1, &buffer);
+    alBufferData(buffer, AL_FORMAT_MONO16, samples, sizeof(samples), FREQUENCY);
+    return buffer;
+}
+
+/*
+    Looping, at the listener, so there is no distance attenuation
+*/
+static ALuint makeSource(ALuint buffer)
+{
+    ALuint source;
+
+    alGenSources(1, &source);
+    alSourcei(source, AL_BUFFER, buffer);
+    alSourcei(source, AL_LOOPING, AL_TRUE);
+    alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+    alSource3f(source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+    return source;
+}
+
+static void restart(ALuint source)
+{
+    alSourceRewind(source);
+    alSourcePlay(source);
+}
+
+static void render(float *out, int frames)
+{
+    renderSamples(device, out, frames);
+}
+
+/*
+    Largest difference between the output and 'gain' times the reference
+*/
+static float deviation(int first, int last, float gain)
+{
+    float worst = 0.0f, d;
+    int i;
+
+    for (i = first; i < last; ++i) {
+        d = fabsf(output[i] - gain * reference[i]);
+        if (d > worst)
+            worst = d;
+    }
+    return worst;
+}
+
+/*
+    Whether every sample lies between the reference scaled by 'from' and
+    by 'to', as while OpenAL fades from one gain to the other
+*/
+static bool between(int first, int last, float from, float to)
+{
+    float low, high;
+    int i;
+
+    for (i = first; i < last; ++i) {
+        low = from * reference[i];
+        high = to * reference[i];
+        if (low > high) {
+            float t = low;
+            low = high;
+            high = t;
+        }
+        if (output[i] < low - TOLERANCE || output[i] > high + TOLERANCE)
+            return false;
+    }
+    return true;
+}
+
+static int testListener(ALuint source)
+{
+    int failures = 0;
+
+    alxSetInteger(mixer, ALX_BACKEND, ALX_BACKEND_OPENAL);
+    failures += check(alxGetInteger(mixer, ALX_BACKEND) == ALX_BACKEND_OPENAL, "OpenAL backend");
+
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, 0.5f);
+    restart(source);
+    render(output, CHECK_FRAMES);
+    failures += check(deviation(0, CHECK_FRAMES, 0.5f) < TOLERANCE, "listener gain");
+
+    alxSetBoolean(mixer, ALX_MASTER_VOLUME, ALX_TRUE);
+    restart(source);
+    render(output, CHECK_FRAMES);
+    failures += check(deviation(0, CHECK_FRAMES, 0.0f) < TOLERANCE, "listener mute");
+
+    alxSetBoolean(mixer, ALX_MASTER_VOLUME, ALX_FALSE);
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, 1.0f);
+    return failures;
+}
+
+static int testBuses(ALuint source)
+{
+    ALXint bus, child;
+    int failures = 0;
+
+    bus = alxGenBus(mixer, 0);
+    child = alxGenBus(mixer, bus);
+    alxAttachSource(mixer, child, source);
+    failures += check(bus != 0 && child != 0 && alxGetError(mixer) == ALX_NO_ERROR, "nested buses");
+
+    alxSetIndexedFloat(mixer, ALX_BUS_GAIN, bus, 0.5f);
+    alxSetIndexedFloat(mixer, ALX_BUS_GAIN, child, 0.5f);
+    restart(source);
+    render(output, CHECK_FRAMES);
+    failures += check(deviation(0, CHECK_FRAMES, 0.25f) < TOLERANCE, "bus gains multiply");
+
+    alxSetIndexedBoolean(mixer, ALX_BUS_MUTE, bus, ALX_TRUE);
+    restart(source);
+    render(output, CHECK_FRAMES);
+    failures += check(deviation(0, CHECK_FRAMES, 0.0f) < TOLERANCE, "muted parent bus");
+
+    alxSetIndexedBoolean(mixer, ALX_BUS_MUTE, bus, ALX_FALSE);
+    alxDeleteBus(mixer, child);
+    restart(source);
+    render(output, CHECK_FRAMES);
+    failures += check(deviation(0, CHECK_FRAMES, 0.5f) < TOLERANCE, "deleted bus gives its sources to its parent");
+
+    alxDeleteBus(mixer, bus);
+    return failures;
+}
+
+/*
+    Fades a bus out with one queued gain per block, as an automation
+    thread would, checking that each block moves from the previous gain
+    to the new one and ends on it.
+*/
+static int testRamp(ALuint source)
+{
+    ALXint bus = alxGenBus(mixer, 0);
+    float from = 1.0f, to;
+    bool inside = true, reached = true;
+    int i;
+
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, RAMP_BLOCKS);
+    alxAttachSource(mixer, bus, source);
+    restart(source);
+
+    for (i = 0; i < RAMP_BLOCKS; ++i) {
+        to = 1.0f - (float) (i + 1) / RAMP_BLOCKS;
+        alxQueueFloat(mixer, ALX_BUS_GAIN, bus, to);
+        alxProcessQueue(mixer);
+        render(output + i * BLOCK, BLOCK);
+
+        inside = inside && between(i * BLOCK, (i + 1) * BLOCK, from, to);
+        reached = reached && fabsf(output[(i + 1) * BLOCK - 1] - to * reference[(i + 1) * BLOCK - 1]) < TOLERANCE;
+        from = to;
+    }
+
+    alxDetachSource(mixer, source);
+    alxDeleteBus(mixer, bus);
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, 0);
+
+    return check(inside, "ramp moves between consecutive gains")
+         + check(reached, "ramp reaches each gain within a block");
+}
+
+/*
+    Frames per second rendered with BENCH_SOURCES sources playing while
+    'feature' is applied before every block
+*/
+static double bench(const char *name, void (*feature)(int block))
+{
+    double start, seconds;
+    int frames;
+
+    start = now();
+    for (frames = 0; frames < BENCH_FRAMES; frames += BLOCK) {
+        if (feature != NULL)
+            feature(frames / BLOCK);
+        render(scratch, BLOCK);
+    }
+    seconds = now() - start;
+
+    printf("%-16s %12.0f frames/s\n", name, BENCH_FRAMES / seconds);
+    return BENCH_FRAMES / seconds;
+}
+
+static ALXint benchBuses[BENCH_BUSES];
+
+static void listenerGain(int block)
+{
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, (block & 1) ? 0.5f : 0.25f);
+}
+
+static void busGain(int block)
+{
+    alxSetIndexedFloat(mixer, ALX_BUS_GAIN, benchBuses[block % BENCH_BUSES], (block & 1) ? 0.5f : 0.25f);
+}
+
+static void queuedRamp(int block)
+{
+    alxQueueFloat(mixer, ALX_BUS_GAIN, benchBuses[0], (block % 64) / 64.0f);
+    alxProcessQueue(mixer);
+}
+
+static void benchmark(ALuint buffer)
+{
+    ALuint sources[BENCH_SOURCES];
+    ALXint group;
+    int i;
+
+    for (i = 0; i < BENCH_SOURCES; ++i) {
+        sources[i] = makeSource(buffer);
+        alSourcef(sources[i], AL_GAIN, 1.0f / BENCH_SOURCES);
+        alSourcePlay(sources[i]);
+    }
+
+    bench("none", NULL);
+
+    alxSetInteger(mixer, ALX_BACKEND, ALX_BACKEND_OPENAL);
+    bench("listener gain", listenerGain);
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, 1.0f);
+
+    group = alxGenBus(mixer, 0);
+    alxSetIndexedFloat(mixer, ALX_BUS_GAIN, group, 1.0f / BENCH_SOURCES);
+    for (i = 0; i < BENCH_BUSES; ++i)
+        benchBuses[i] = alxGenBus(mixer, group);
+    for (i = 0; i < BENCH_SOURCES; ++i)
+        alxAttachSource(mixer, benchBuses[i % BENCH_BUSES], sources[i]);
+    bench("bus gain", busGain);
+
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, 64);
+    bench("queued ramp", queuedRamp);
+    alxSetInteger(mixer, ALX_QUEUE_SIZE, 0);
+
+    for (i = 0; i < BENCH_SOURCES; ++i)
+        alxDetachSource(mixer, sources[i]);
+    alxDeleteBus(mixer, group);
+    alDeleteSources(BENCH_SOURCES, sources);
+}
+
+int main()
+{
+    ALCint attributes[] = {
+        ALC_FORMAT_CHANNELS_SOFT, ALC_MONO_SOFT,
+        ALC_FORMAT_TYPE_SOFT, ALC_FLOAT_SOFT,
+        ALC_FREQUENCY, FREQUENCY,
+        0
+    };
+    ALCcontext *context;
+    ALuint buffer, source;
+    int failures = 0;
+
+    if (!alcIsExtensionPresent(NULL, "ALC_SOFT_loopback")) {
+        printf("no ALC_SOFT_loopback, skipping\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    loopbackOpenDevice = (LPALCLOOPBACKOPENDEVICESOFT) alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+    isRenderFormatSupported = (LPALCISRENDERFORMATSUPPORTEDSOFT) alcGetProcAddress(NULL, "alcIsRenderFormatSupportedSOFT");
+    renderSamples = (LPALCRENDERSAMPLESSOFT) alcGetProcAddress(NULL, "alcRenderSamplesSOFT");
+
+    device = loopbackOpenDevice(NULL);
+    if (device == NULL || !isRenderFormatSupported(device, FREQUENCY, ALC_MONO_SOFT, ALC_FLOAT_SOFT)) {
+        printf("no mono float loopback rendering, skipping\n");
+        if (device)
+            alcCloseDevice(device);
+        return SKIP_RETURN_CODE;
+    }
+
+    mixer = alxMapDevice(device);
+    if (check(mixer != NULL, "map the loopback device")) {
+        alcCloseDevice(device);
+        return 1;
+    }
+
+    context = alcCreateContext(device, attributes);
+    alcMakeContextCurrent(context);
+
+    buffer = makeBuffer();
+    source = makeSource(buffer);
+
+    restart(source);
+    render(reference, CHECK_FRAMES);
+
+    failures += testListener(source);
+    failures += testBuses(source);
+    failures += testRamp(source);
+    alDeleteSources(1, &source);
+
+    benchmark(buffer);
+
+    alDeleteBuffers(1, &buffer);
+    alxCloseDevice(mixer);
+    alcMakeContextCurrent(NULL);
+    alcDestroyContext(context);
+    alcCloseDevice(device);
+
+    return failures ? 1 : 0;
+}
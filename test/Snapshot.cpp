@@ -0,0 +1,137 @@
+/*
+ * Snapshot testing
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+/*
+ * Runs the alxctl given as the first argument to dump the first mixer
+ * device, moves its master volume, then loads the snapshot back: the
+ * volume must read exactly what it did before, both as a float and in
+ * the driver's units, and a second dump must match the first.
+ *
+ * Exits with 0 on success, 1 on failure and SKIP_RETURN_CODE when there
+ * is no mixer device.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include <alx.h>
+
+#define SNAPSHOT_FILE       "ALx_snapshot.json"
+#define SECOND_FILE         "ALx_snapshot2.json"
+#define SKIP_RETURN_CODE    77
+
+static int check(bool condition, const char *what)
+{
+    printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    return condition ? 0 : 1;
+}
+
+/*
+    Runs alxctl with 'arguments', 0 when it succeeds
+*/
+static int run(const char *alxctl, const char *arguments)
+{
+    std::string command = std::string("\"") + alxctl + "\" " + arguments;
+    return system(command.c_str());
+}
+
+/*
+    Contents of a file, empty when it cannot be read
+*/
+static std::string readFile(const char *filename)
+{
+    std::string text;
+    char buffer[4096];
+    size_t n;
+    FILE *file = fopen(filename, "rb");
+
+    if (file == NULL)
+        return text;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, n);
+    fclose(file);
+    return text;
+}
+
+int main(int argc, char *argv[])
+{
+    const ALXchar *names = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+    ALXdevice *mixer;
+    ALXfloat original, volume;
+    ALXint raw, restored;
+    int failures = 0;
+
+    if (argc < 2) {
+        printf("usage: %s ALXCTL\n", argv[0]);
+        return 1;
+    }
+
+    mixer = names && *names ? alxOpenDevice(names) : NULL;
+    if (mixer == NULL) {
+        printf("no mixer device, skipping\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    // a value that takes all of a float's digits to print
+    original = alxGetFloat(mixer, ALX_MASTER_VOLUME);
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, 1.0f / 3.0f);
+    volume = alxGetFloat(mixer, ALX_MASTER_VOLUME);
+    alxGetIntegerv(mixer, ALX_MASTER_VOLUME, 0, &raw);
+
+    failures += check(run(argv[1], "dump -o 0 > " SNAPSHOT_FILE) == 0,
+        "alxctl dumps the device");
+
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, volume < 0.5f ? 0.75f : 0.25f);
+
+    failures += check(run(argv[1], "load " SNAPSHOT_FILE) == 0,
+        "alxctl loads the snapshot");
+    alxGetIntegerv(mixer, ALX_MASTER_VOLUME, 0, &restored);
+    failures += check(alxGetFloat(mixer, ALX_MASTER_VOLUME) == volume,
+        "the volume reads the float it was saved with");
+    failures += check(restored == raw,
+        "the volume holds the driver value it was saved with");
+
+    failures += check(run(argv[1], "dump -o 0 > " SECOND_FILE) == 0
+        && readFile(SNAPSHOT_FILE) == readFile(SECOND_FILE),
+        "a second dump matches the first");
+
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, original);
+    alxCloseDevice(mixer);
+    remove(SNAPSHOT_FILE);
+    remove(SECOND_FILE);
+
+    return failures ? 1 : 0;
+}
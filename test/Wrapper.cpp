@@ -0,0 +1,148 @@
+/*
+ * C++ wrapper testing
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * Builds alx.hpp as C++17, instantiating get, set, read and write for
+ * every parameter, then checks the error paths, which need no mixer:
+ * an empty device reports ALX_INVALID_DEVICE and opening an unknown
+ * device throws. With a mixer device, the master volume and the first
+ * output are read back through the wrapper as well, and the typed
+ * getters of alx.h report a NULL 'value' instead of writing to it.
+ *
+ * Exits with 0 on success and 1 on failure.
+ */
+
+#include <stdio.h>
+#include <type_traits>
+
+#include <alx.hpp>
+
+static_assert(!std::is_copy_constructible<alx::device>::value, "devices are not copied");
+static_assert(std::is_nothrow_move_constructible<alx::device>::value, "devices move");
+static_assert(std::is_same<alx::OutputMute::value_type, bool>::value, "mutes are bool");
+
+static int check(bool condition, const char *what)
+{
+    printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    return condition ? 0 : 1;
+}
+
+template<typename P>
+static ALXenum roundTrip(alx::device &dev)
+{
+    typename P::value_type value{};
+    ALXenum status = dev.template read<P>(value);
+    return status != ALX_NO_ERROR ? status : dev.template write<P>(value);
+}
+
+template<typename P>
+static ALXenum roundTrip(alx::device &dev, int index)
+{
+    typename P::value_type value{};
+    ALXenum status = dev.template read<P>(index, value);
+    return status != ALX_NO_ERROR ? status : dev.template write<P>(index, value);
+}
+
+static bool rejectsNullValue(ALXdevice *mixer)
+{
+    return alxGetMasterVolume(mixer, NULL) == ALX_INVALID_VALUE
+        && alxGetMasterMute(mixer, NULL) == ALX_INVALID_VALUE
+        && alxGetPCMOutputVolume(mixer, NULL) == ALX_INVALID_VALUE
+        && alxGetPCMOutputMute(mixer, NULL) == ALX_INVALID_VALUE
+        && alxGetInputVolume(mixer, NULL) == ALX_INVALID_VALUE
+        && alxGetInputSource(mixer, NULL) == ALX_INVALID_VALUE
+        && alxGetOutputVolume(mixer, 0, NULL) == ALX_INVALID_VALUE
+        && alxGetOutputMute(mixer, 0, NULL) == ALX_INVALID_VALUE;
+}
+
+static bool throwsOnGet(alx::device &dev)
+{
+    try {
+        (void) dev.get<alx::MasterVolume>();
+    }
+    catch (const alx::error &e) {
+        return e.code() == ALX_INVALID_DEVICE;
+    }
+    return false;
+}
+
+static bool throwsOnOpen()
+{
+    try {
+        alx::device dev = alx::device::open("no such mixer device");
+    }
+    catch (const alx::error &e) {
+        return e.code() != ALX_NO_ERROR;
+    }
+    return false;
+}
+
+int main()
+{
+    const ALXchar *names = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+    alx::device empty;
+    alx::device dev;
+    int failures = 0;
+
+    failures += check(!empty, "an empty device is false");
+    failures += check(roundTrip<alx::MasterVolume>(empty) == ALX_INVALID_DEVICE
+        && roundTrip<alx::MasterMute>(empty) == ALX_INVALID_DEVICE
+        && roundTrip<alx::PCMVolume>(empty) == ALX_INVALID_DEVICE
+        && roundTrip<alx::PCMMute>(empty) == ALX_INVALID_DEVICE
+        && roundTrip<alx::InputVolume>(empty) == ALX_INVALID_DEVICE
+        && roundTrip<alx::InputSource>(empty) == ALX_INVALID_DEVICE
+        && roundTrip<alx::OutputVolume>(empty, 0) == ALX_INVALID_DEVICE
+        && roundTrip<alx::OutputMute>(empty, 0) == ALX_INVALID_DEVICE,
+        "an empty device reports invalid device");
+    failures += check(throwsOnGet(empty), "get throws alx::error");
+    failures += check(throwsOnOpen(), "opening an unknown device throws");
+    failures += check(empty.output_name(0).empty(), "no name without a device");
+
+    if (names && *names) {
+        dev = alx::device::open(names);
+        failures += check(roundTrip<alx::MasterVolume>(dev) == ALX_NO_ERROR,
+            "master volume read back");
+        failures += check(rejectsNullValue(dev.handle()), "a NULL value is invalid");
+        if (dev.outputs() > 0) {
+            failures += check(roundTrip<alx::OutputVolume>(dev, 0) == ALX_NO_ERROR,
+                "output volume read back");
+            failures += check(!dev.output_name(0).empty(), "output name");
+        }
+    }
+    else {
+        printf("no mixer device, device checks skipped\n");
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Redundant write testing
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * Asks for the notifications of the first mixer device, as alxd does,
+ * then counts in a driver trace the calls that repeated writes and
+ * reads of the master volume make: once the library watches a control,
+ * writing the value it holds or reading it back is not sent to the
+ * driver.
+ *
+ * Exits with 0 on success, 1 on failure and SKIP_RETURN_CODE when there
+ * is no mixer device or it has no notifications.
+ */
+
+#include <stdio.h>
+
+#include <alx.h>
+#include <alxtrace.h>
+
+#define TRACE_FILE          "ALx_writes.trace"
+#define TRACE_RECORDS       256
+#define SKIP_RETURN_CODE    77
+
+static int check(bool condition, const char *what)
+{
+    printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    return condition ? 0 : 1;
+}
+
+/*
+    Driver calls of type 'call' in the trace, -1 when it cannot be read
+*/
+static int countCalls(unsigned short call)
+{
+    ALXtraceHeader header;
+    ALXtraceRecord record;
+    FILE *file = fopen(TRACE_FILE, "rb");
+    int count = 0, i;
+
+    if (file == NULL)
+        return -1;
+
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != ALX_TRACE_MAGIC
+        || header.count > header.capacity) {
+        fclose(file);
+        return -1;
+    }
+
+    for (i = 0; i < header.count; ++i) {
+        if (fread(&record, sizeof(record), 1, file) != 1)
+            break;
+        if (record.call == call)
+            ++count;
+    }
+
+    fclose(file);
+    return count;
+}
+
+int main()
+{
+    const ALXchar *names = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+    ALXdevice *mixer;
+    ALXpollfd fd;
+    ALXfloat volume, other;
+    ALXboolean mute;
+    int failures = 0, i;
+
+    mixer = names && *names ? alxOpenDevice(names) : NULL;
+    if (mixer == NULL) {
+        printf("no mixer device, skipping\n");
+        return SKIP_RETURN_CODE;
+    }
+
+    if (alxGetPollDescriptors(mixer, &fd, 1) == 0) {
+        printf("no notifications, skipping\n");
+        alxCloseDevice(mixer);
+        return SKIP_RETURN_CODE;
+    }
+
+    volume = alxGetFloat(mixer, ALX_MASTER_VOLUME);
+    mute = alxGetBoolean(mixer, ALX_MASTER_VOLUME);
+    other = volume < 0.5f ? 0.75f : 0.25f;
+
+    alxStartTrace(TRACE_FILE, TRACE_RECORDS);
+    for (i = 0; i < 3; ++i)
+        alxSetFloat(mixer, ALX_MASTER_VOLUME, other);
+    alxStopTrace();
+    failures += check(countCalls(ALX_TRACE_SET_CONTROL_DETAILS) == 1,
+        "three writes of a new volume make one driver call");
+
+    alxStartTrace(TRACE_FILE, TRACE_RECORDS);
+    for (i = 0; i < 3; ++i)
+        alxSetBoolean(mixer, ALX_MASTER_VOLUME, mute);
+    alxStopTrace();
+    failures += check(countCalls(ALX_TRACE_SET_CONTROL_DETAILS) == 0,
+        "writes of the mute it holds make no driver call");
+
+    alxStartTrace(TRACE_FILE, TRACE_RECORDS);
+    for (i = 0; i < 3; ++i)
+        alxGetFloat(mixer, ALX_MASTER_VOLUME);
+    alxStopTrace();
+    failures += check(countCalls(ALX_TRACE_GET_CONTROL_DETAILS) == 0,
+        "reads of a known volume make no driver call");
+
+    alxSetFloat(mixer, ALX_MASTER_VOLUME, volume);
+    alxCloseDevice(mixer);
+    remove(TRACE_FILE);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,839 @@
+/*
+ * ALx
+ * Command line mixer control
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * alxctl runs any number of mixer operations in one process and prints
+ * their results as JSON. Operations apply to the device most recently
+ * selected with -o (output) or -i (capture), by name or by position in
+ * the device list, and each device is opened only once.
+ *
+ *   alxctl list
+ *   alxctl get -o 0 master-volume output-volume -i 0 input-volume
+ *   alxctl set -o Speakers master-volume=0.5 output-mute[1]=true
+ *   alxctl dump [-o DEV] [-i DEV] > snapshot.json
+ *   alxctl load snapshot.json
+ *   alxctl watch [-o DEV] [-i DEV] [-t milliseconds]
+ *
+ * Keys: master-volume, master-mute, pcm-volume, pcm-mute, input-volume,
+ * input-source, output-volume[N] and output-mute[N]. Indexed keys given
+ * without an index stand for all of their lines.
+ *
+ * load applies the values of each device together, through its command
+ * queue, so the device moves to the snapshot in one step rather than
+ * value by value, and none of them is applied when they cannot all be
+ * read.
+ */
+
+#ifndef __MINGW32__
+#define _CRT_SECURE_NO_DEPRECATE // get rid of sprintf security warnings on VS2005
+#define _CRT_NONSTDC_NO_DEPRECATE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <al.h>
+#include <alc.h>
+#include <alx.h>
+
+#if defined(_WIN32)
+ #include <windows.h>
+ #define sleepMs(ms) Sleep(ms)
+#else
+ #include <unistd.h>
+ #define sleepMs(ms) usleep((ms) * 1000)
+#endif
+
+enum Kind {
+    Float,
+    Boolean,
+    IndexedFloat,
+    IndexedBoolean,
+    Source
+};
+
+struct Param
+{
+    const char *key;
+    ALXenum     param;
+    Kind        kind;
+    bool        capture;
+};
+
+/*
+    Values are saved, and so restored, in this order. The input volume
+    belongs to the selected input source, so the source comes first.
+*/
+static const Param Params[] = {
+    { "master-volume",  ALX_MASTER_VOLUME,      Float,          false },
+    { "master-mute",    ALX_MASTER_VOLUME,      Boolean,        false },
+    { "pcm-volume",     ALX_PCM_OUTPUT_VOLUME,  Float,          false },
+    { "pcm-mute",       ALX_PCM_OUTPUT_VOLUME,  Boolean,        false },
+    { "output-volume",  ALX_OUTPUT_VOLUME,      IndexedFloat,   false },
+    { "output-mute",    ALX_OUTPUT_VOLUME,      IndexedBoolean, false },
+    { "input-source",   ALX_INPUT_SOURCE,       Source,         true  },
+    { "input-volume",   ALX_INPUT_VOLUME,       Float,          true  },
+    { NULL,             0,                      Float,          false }
+};
+
+struct Device
+{
+    std::string name;
+    bool        capture;
+    ALXdevice  *mixer;
+};
+
+static std::vector<Device *> devices;
+static int errors = 0;
+
+///////////////////////////////////////////////////////
+// JSON output
+
+static void printString(const char *s)
+{
+    putchar('"');
+    for (; *s; ++s) {
+        switch (*s) {
+        case '"':  fputs("\\\"", stdout); break;
+        case '\\': fputs("\\\\", stdout); break;
+        case '\n': fputs("\\n", stdout);  break;
+        case '\t': fputs("\\t", stdout);  break;
+        default:
+            if ((unsigned char) *s < 0x20)
+                printf("\\u%04x", *s);
+            else
+                putchar(*s);
+        }
+    }
+    putchar('"');
+}
+
+static void printError(const char *device, const char *what, const char *message)
+{
+    printf("{\"error\":");
+    printString(message);
+    if (device) {
+        printf(",\"device\":");
+        printString(device);
+    }
+    if (what) {
+        printf(",\"key\":");
+        printString(what);
+    }
+    printf("}\n");
+    ++errors;
+}
+
+///////////////////////////////////////////////////////
+// Devices
+
+static const Param *findParam(const char *key, size_t len)
+{
+    for (int i = 0; Params[i].key; i++) {
+        if (strlen(Params[i].key) == len && !strncmp(Params[i].key, key, len))
+            return &Params[i];
+    }
+    return NULL;
+}
+
+static Device *openDevice(const char *spec, bool capture)
+{
+    const ALXchar *list = alxGetString(NULL,
+        capture ? ALX_CAPTURE_DEVICE_SPECIFIER : ALX_DEVICE_SPECIFIER);
+    const ALXchar *name;
+    char *end;
+    long n = strtol(spec, &end, 10);
+    size_t i;
+
+    if (list == NULL)
+        return NULL;
+
+    // a number selects a device by its position in the list
+    for (name = list; *name; name += strlen(name) + 1, --n) {
+        if (*end == '\0' ? n == 0 : !strcmp(name, spec))
+            break;
+    }
+    if (*name == '\0')
+        return NULL;
+
+    for (i = 0; i < devices.size(); i++) {
+        if (devices[i]->capture == capture && devices[i]->name == name)
+            return devices[i];
+    }
+
+    ALXdevice *mixer = capture ? alxOpenCaptureDevice(name) : alxOpenDevice(name);
+    if (mixer == NULL)
+        return NULL;
+
+    Device *device = new Device;
+    device->name = name;
+    device->capture = capture;
+    device->mixer = mixer;
+    devices.push_back(device);
+    return device;
+}
+
+static void closeDevices()
+{
+    for (size_t i = 0; i < devices.size(); i++) {
+        alxCloseDevice(devices[i]->mixer);
+        delete devices[i];
+    }
+    devices.clear();
+}
+
+static int countOf(Device &device, const Param &param)
+{
+    if (param.kind == IndexedFloat || param.kind == IndexedBoolean)
+        return alxGetInteger(device.mixer, ALX_OUTPUT_VOLUME_SPECIFIER);
+    return 1;
+}
+
+static int currentSource(Device &device)
+{
+    ALXint i, n = alxGetInteger(device.mixer, ALX_INPUT_SOURCE_SPECIFIER);
+
+    for (i = 0; i < n; i++) {
+        if (!alxGetIndexedBoolean(device.mixer, ALX_INPUT_SOURCE, i))
+            return i;
+    }
+    return -1;
+}
+
+/*
+    Reads a value as a double; booleans read 0 or 1.
+*/
+static double readValue(Device &device, const Param &param, int index)
+{
+    switch (param.kind) {
+    case Float:          return alxGetFloat(device.mixer, param.param);
+    case Boolean:        return alxGetBoolean(device.mixer, param.param);
+    case IndexedFloat:   return alxGetIndexedFloat(device.mixer, param.param, index);
+    case IndexedBoolean: return alxGetIndexedBoolean(device.mixer, param.param, index);
+    case Source:         return currentSource(device);
+    }
+    return 0;
+}
+
+static void writeValue(Device &device, const Param &param, int index, double value)
+{
+    switch (param.kind) {
+    case Float:
+        alxSetFloat(device.mixer, param.param, (ALXfloat) value);
+        break;
+    case Boolean:
+        alxSetBoolean(device.mixer, param.param, value != 0 ? ALX_TRUE : ALX_FALSE);
+        break;
+    case IndexedFloat:
+        alxSetIndexedFloat(device.mixer, param.param, index, (ALXfloat) value);
+        break;
+    case IndexedBoolean:
+        alxSetIndexedBoolean(device.mixer, param.param, index, value != 0 ? ALX_TRUE : ALX_FALSE);
+        break;
+    case Source:
+        alxSetInteger(device.mixer, param.param, (ALXint) value);
+        break;
+    }
+}
+
+/*
+    Queues a value for alxProcessQueue, false when it was dropped. The
+    input source is kept in 'source' and queued with the input volume
+    that follows it, as alxSetIndexedFloat selects a source and sets
+    its volume in one call.
+*/
+static bool queueValue(Device &device, const Param &param, int index, double value, int &source)
+{
+    switch (param.kind) {
+    case Float:
+        if (param.param == ALX_INPUT_VOLUME && source >= 0) {
+            index = source;
+            source = -1;
+            return alxQueueFloat(device.mixer, ALX_INPUT_SOURCE, index, (ALXfloat) value) != ALX_FALSE;
+        }
+        return alxQueueFloat(device.mixer, param.param, -1, (ALXfloat) value) != ALX_FALSE;
+    case Boolean:
+        return alxQueueBoolean(device.mixer, param.param, -1, value != 0 ? ALX_TRUE : ALX_FALSE) != ALX_FALSE;
+    case IndexedFloat:
+        return alxQueueFloat(device.mixer, param.param, index, (ALXfloat) value) != ALX_FALSE;
+    case IndexedBoolean:
+        return alxQueueBoolean(device.mixer, param.param, index, value != 0 ? ALX_TRUE : ALX_FALSE) != ALX_FALSE;
+    case Source:
+        source = (int) value;
+        return true;
+    }
+    return false;
+}
+
+/*
+    Floats are printed with the 9 significant digits that read back as
+    the same float, so a snapshot restores exactly what it saved.
+*/
+static void printValue(const Param &param, double value)
+{
+    if (param.kind == Boolean || param.kind == IndexedBoolean)
+        printf(value != 0 ? "true" : "false");
+    else if (param.kind == Source)
+        printf("%d", (int) value);
+    else
+        printf("%.9g", value);
+}
+
+static bool available(Device &device, const Param &param)
+{
+    if (param.capture != device.capture)
+        return false;
+    if (param.param == ALX_PCM_OUTPUT_VOLUME)
+        return alxGetBoolean(device.mixer, ALX_PCM_OUTPUT) != ALX_FALSE;
+    return true;
+}
+
+/*
+    Print every value of a device as the members of a JSON object.
+*/
+static void printValues(Device &device)
+{
+    bool first = true;
+
+    for (int i = 0; Params[i].key; i++) {
+        const Param &param = Params[i];
+        int n;
+
+        if (!available(device, param))
+            continue;
+
+        printf("%s\"%s\":", first ? "" : ",", param.key);
+        first = false;
+
+        if (param.kind == IndexedFloat || param.kind == IndexedBoolean) {
+            n = countOf(device, param);
+            putchar('[');
+            for (int j = 0; j < n; j++) {
+                if (j)
+                    putchar(',');
+                printValue(param, readValue(device, param, j));
+            }
+            putchar(']');
+        }
+        else {
+            printValue(param, readValue(device, param, 0));
+        }
+    }
+}
+
+static void printDevice(Device &device)
+{
+    printf("{\"name\":");
+    printString(device.name.c_str());
+    printf(",\"capture\":%s,\"values\":{", device.capture ? "true" : "false");
+    printValues(device);
+    printf("}}");
+}
+
+///////////////////////////////////////////////////////
+// Operations
+
+/*
+    Parse "key", "key[N]", "key=value" or "key[N]=value".
+*/
+static const Param *parseOperation(const char *op, int &index, const char *&value)
+{
+    const char *bracket = strchr(op, '[');
+    const char *equal = strchr(op, '=');
+    size_t len = equal ? (size_t)(equal - op) : strlen(op);
+    const Param *param;
+
+    index = -1;
+    value = equal ? equal + 1 : NULL;
+
+    if (bracket && (!equal || bracket < equal)) {
+        index = atoi(bracket + 1);
+        len = bracket - op;
+    }
+
+    param = findParam(op, len);
+    if (param && index >= 0 && param->kind != IndexedFloat && param->kind != IndexedBoolean)
+        return NULL;
+    return param;
+}
+
+static double parseValue(const char *value)
+{
+    if (!strcmp(value, "true") || !strcmp(value, "on"))
+        return 1;
+    if (!strcmp(value, "false") || !strcmp(value, "off"))
+        return 0;
+    return atof(value);
+}
+
+/*
+    Handle -o/-i device selections and the operations that follow them.
+    'set' tells whether operations are assignments.
+*/
+static int runOperations(int argc, char *argv[], bool set)
+{
+    Device *device = NULL;
+    bool first = true;
+
+    printf("[");
+    for (int i = 0; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") || !strcmp(argv[i], "-i")) {
+            if (++i == argc)
+                break;
+            device = openDevice(argv[i], argv[i - 1][1] == 'i');
+            if (device == NULL)
+                printError(argv[i], NULL, "no such device");
+            continue;
+        }
+
+        if (device == NULL) {
+            printError(NULL, argv[i], "no device selected");
+            continue;
+        }
+
+        int index;
+        const char *value;
+        const Param *param = parseOperation(argv[i], index, value);
+
+        if (param == NULL || !available(*device, *param) || (value == NULL) == set) {
+            printError(device->name.c_str(), argv[i], "invalid operation");
+            continue;
+        }
+
+        int from = index < 0 ? 0 : index;
+        int to = index < 0 ? countOf(*device, *param) : index + 1;
+
+        for (int j = from; j < to; j++) {
+            if (set)
+                writeValue(*device, *param, j, parseValue(value));
+
+            printf("%s{\"device\":", first ? "" : ",");
+            printString(device->name.c_str());
+            printf(",\"key\":\"%s", param->key);
+            if (param->kind == IndexedFloat || param->kind == IndexedBoolean)
+                printf("[%d]", j);
+            printf("\",\"value\":");
+            printValue(*param, readValue(*device, *param, j));
+            if (alxGetError(device->mixer) != ALX_NO_ERROR) {
+                printf(",\"error\":true");
+                ++errors;
+            }
+            printf("}");
+            first = false;
+        }
+    }
+    printf("]\n");
+
+    return errors ? 1 : 0;
+}
+
+/*
+    Open the devices selected with -o and -i, or all of them when none
+    was selected.
+*/
+static void selectDevices(int argc, char *argv[])
+{
+    bool selected = false;
+
+    for (int i = 0; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "-o") && strcmp(argv[i], "-i"))
+            continue;
+        if (openDevice(argv[i + 1], argv[i][1] == 'i') == NULL)
+            printError(argv[i + 1], NULL, "no such device");
+        selected = true;
+        i++;
+    }
+
+    if (!selected) {
+        const ALXchar *name;
+        for (name = alxGetString(NULL, ALX_DEVICE_SPECIFIER); name && *name; name += strlen(name) + 1)
+            openDevice(name, false);
+        for (name = alxGetString(NULL, ALX_CAPTURE_DEVICE_SPECIFIER); name && *name; name += strlen(name) + 1)
+            openDevice(name, true);
+    }
+}
+
+static int list()
+{
+    bool first = true;
+
+    selectDevices(0, NULL);
+
+    printf("[");
+    for (size_t i = 0; i < devices.size(); i++) {
+        Device &device = *devices[i];
+        bool capture = device.capture;
+        ALXenum names = capture ? ALX_INPUT_SOURCE_SPECIFIER : ALX_OUTPUT_VOLUME_SPECIFIER;
+        ALXint n = alxGetInteger(device.mixer, names);
+
+        printf("%s{\"name\":", first ? "" : ",");
+        printString(device.name.c_str());
+        printf(",\"capture\":%s,\"%s\":[", capture ? "true" : "false",
+            capture ? "sources" : "outputs");
+        for (ALXint j = 0; j < n; j++) {
+            const ALXchar *name = alxGetIndexedString(device.mixer, names, j);
+            if (j)
+                putchar(',');
+            printString(name ? name : "");
+        }
+        printf("],\"keys\":[");
+        bool firstKey = true;
+        for (int k = 0; Params[k].key; k++) {
+            if (!available(device, Params[k]))
+                continue;
+            printf("%s\"%s\"", firstKey ? "" : ",", Params[k].key);
+            firstKey = false;
+        }
+        printf("]}");
+        first = false;
+    }
+    printf("]\n");
+
+    return 0;
+}
+
+static int dump(int argc, char *argv[])
+{
+    selectDevices(argc, argv);
+
+    printf("{\"devices\":[");
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (i)
+            printf(",\n");
+        printDevice(*devices[i]);
+    }
+    printf("]}\n");
+
+    return errors ? 1 : 0;
+}
+
+static int watch(int argc, char *argv[])
+{
+    std::vector< std::vector<double> > last;
+    int interval = 250;
+
+    for (int i = 0; i + 1 < argc; i++) {
+        if (!strcmp(argv[i], "-t"))
+            interval = atoi(argv[i + 1]);
+    }
+
+    selectDevices(argc, argv);
+    last.resize(devices.size());
+
+    for (;;) {
+        for (size_t d = 0; d < devices.size(); d++) {
+            Device &device = *devices[d];
+            size_t k = 0;
+
+            for (int i = 0; Params[i].key; i++) {
+                const Param &param = Params[i];
+                if (!available(device, param))
+                    continue;
+
+                int n = countOf(device, param);
+                for (int j = 0; j < n; j++, k++) {
+                    double value = readValue(device, param, j);
+
+                    if (k < last[d].size() && last[d][k] == value)
+                        continue;
+
+                    if (k >= last[d].size())
+                        last[d].resize(k + 1, value);
+                    else {
+                        printf("{\"device\":");
+                        printString(device.name.c_str());
+                        printf(",\"key\":\"%s", param.key);
+                        if (param.kind == IndexedFloat || param.kind == IndexedBoolean)
+                            printf("[%d]", j);
+                        printf("\",\"value\":");
+                        printValue(param, value);
+                        printf("}\n");
+                    }
+                    last[d][k] = value;
+                }
+            }
+        }
+
+        fflush(stdout);
+        sleepMs(interval);
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////
+// Snapshots
+//
+// Just enough JSON to read back what dump writes.
+
+struct Parser
+{
+    const char *p;
+
+    void skip() {
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+            ++p;
+    }
+
+    bool expect(char c) {
+        skip();
+        if (*p != c)
+            return false;
+        ++p;
+        return true;
+    }
+
+    bool peek(char c) {
+        skip();
+        return *p == c;
+    }
+
+    bool string(std::string &out) {
+        out.clear();
+        if (!expect('"'))
+            return false;
+        while (*p && *p != '"') {
+            if (*p == '\\' && p[1]) {
+                ++p;
+                switch (*p) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'u': out += (char) strtol(std::string(p + 1, 4).c_str(), NULL, 16); p += 4; break;
+                default:  out += *p;   break;
+                }
+            }
+            else {
+                out += *p;
+            }
+            ++p;
+        }
+        return expect('"');
+    }
+
+    bool value(double &out) {
+        char *end;
+        skip();
+        if (!strncmp(p, "true", 4))  { p += 4; out = 1; return true; }
+        if (!strncmp(p, "false", 5)) { p += 5; out = 0; return true; }
+        out = strtod(p, &end);
+        if (end == p)
+            return false;
+        p = end;
+        return true;
+    }
+};
+
+/*
+    Values that printValues writes for a device, which is as many
+    commands as loading them back can queue.
+*/
+static int countValues(Device &device)
+{
+    int count = 0;
+
+    for (int i = 0; Params[i].key; i++) {
+        if (available(device, Params[i]))
+            count += countOf(device, Params[i]);
+    }
+    return count;
+}
+
+/*
+    The values of a device are queued as they are read, then applied
+    together by one alxProcessQueue, so a snapshot is restored at once.
+*/
+static bool loadValues(Parser &json, Device *device)
+{
+    std::string key;
+    double value;
+    bool queued;
+    int source = -1;
+
+    if (!json.expect('{'))
+        return false;
+
+    if (device)
+        alxSetInteger(device->mixer, ALX_QUEUE_SIZE, countValues(*device));
+
+    while (!json.peek('}')) {
+        if (!json.string(key) || !json.expect(':'))
+            return false;
+
+        const Param *param = findParam(key.c_str(), key.size());
+
+        queued = true;
+
+        if (json.peek('[')) {
+            json.expect('[');
+            for (int j = 0; !json.peek(']'); j++) {
+                if (!json.value(value))
+                    return false;
+                if (device && param && !queueValue(*device, *param, j, value, source))
+                    queued = false;
+                json.expect(',');
+            }
+            json.expect(']');
+        }
+        else {
+            if (!json.value(value))
+                return false;
+            if (device && param && !queueValue(*device, *param, 0, value, source))
+                queued = false;
+        }
+
+        if (device && (param == NULL || !queued))
+            printError(device->name.c_str(), key.c_str(), "cannot restore value");
+
+        json.expect(',');
+    }
+
+    if (device) {
+        (void) alxGetError(device->mixer);
+        // a source saved without its volume is selected on its own
+        if (source >= 0)
+            alxSetInteger(device->mixer, ALX_INPUT_SOURCE, source);
+        alxProcessQueue(device->mixer);
+        if (alxGetError(device->mixer) != ALX_NO_ERROR)
+            printError(device->name.c_str(), NULL, "cannot restore values");
+        alxSetInteger(device->mixer, ALX_QUEUE_SIZE, 0);
+    }
+
+    return json.expect('}');
+}
+
+static int load(const char *filename)
+{
+    std::string text, key, name;
+    char buffer[4096];
+    size_t n;
+    double capture;
+    Parser json;
+    FILE *file = strcmp(filename, "-") ? fopen(filename, "rb") : stdin;
+
+    if (file == NULL) {
+        printError(NULL, filename, "cannot open snapshot");
+        return 1;
+    }
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, n);
+    if (file != stdin)
+        fclose(file);
+
+    json.p = text.c_str();
+    if (!json.expect('{') || !json.string(key) || key != "devices"
+        || !json.expect(':') || !json.expect('[')) {
+        printError(NULL, filename, "not a snapshot");
+        return 1;
+    }
+
+    while (!json.peek(']')) {
+        Device *device = NULL;
+
+        name.clear();
+        capture = 0;
+
+        if (!json.expect('{'))
+            break;
+        while (!json.peek('}')) {
+            if (!json.string(key) || !json.expect(':'))
+                break;
+            if (key == "name") {
+                json.string(name);
+            }
+            else if (key == "capture") {
+                json.value(capture);
+            }
+            else if (key == "values") {
+                device = openDevice(name.c_str(), capture != 0);
+                if (device == NULL)
+                    printError(name.c_str(), NULL, "no such device");
+                if (!loadValues(json, device))
+                    break;
+            }
+            json.expect(',');
+        }
+        if (!json.expect('}')) {
+            printError(NULL, filename, "not a snapshot");
+            return 1;
+        }
+        json.expect(',');
+    }
+
+    printf("{\"devices\":%u,\"errors\":%d}\n", (unsigned) devices.size(), errors);
+    return errors ? 1 : 0;
+}
+
+///////////////////////////////////////////////////////
+
+static int usage(const char *program)
+{
+    fprintf(stderr,
+        "usage: %s list\n"
+        "       %s get  (-o|-i DEVICE) KEY[N]...\n"
+        "       %s set  (-o|-i DEVICE) KEY[N]=VALUE...\n"
+        "       %s dump [-o|-i DEVICE]...\n"
+        "       %s load FILE\n"
+        "       %s watch [-o|-i DEVICE]... [-t MILLISECONDS]\n",
+        program, program, program, program, program, program);
+    return 2;
+}
+
+int main(int argc, char *argv[])
+{
+    int result;
+
+    if (argc < 2)
+        return usage(argv[0]);
+
+    if (!strcmp(argv[1], "list"))
+        result = list();
+    else if (!strcmp(argv[1], "get"))
+        result = runOperations(argc - 2, argv + 2, false);
+    else if (!strcmp(argv[1], "set"))
+        result = runOperations(argc - 2, argv + 2, true);
+    else if (!strcmp(argv[1], "dump"))
+        result = dump(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "load") && argc == 3)
+        result = load(argv[2]);
+    else if (!strcmp(argv[1], "watch"))
+        result = watch(argc - 2, argv + 2);
+    else
+        return usage(argv[0]);
+
+    closeDevices();
+    return result;
+}
@@ -0,0 +1,378 @@
+/*
+ * ALx
+ * Driver trace replay
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * alxreplay reads a driver trace written by alxStartTrace and runs its
+ * calls again against an in-process fake mixer, which keeps the value
+ * of every control the trace touched. It prints, for each kind of call,
+ * how many were made, how many failed and their recorded latencies.
+ * The fake mixer only looks values up, so timing it would say nothing
+ * about the driver or the library; the latencies are the recorded ones.
+ * With -l the fake mixer takes as long as the driver did on every call,
+ * and with -t the calls are as far apart as they were recorded, so the
+ * replay runs for as long as the traced process spent on the driver.
+ *
+ *   alxreplay [-l] [-t] [-n COUNT] [-v] TRACE
+ *
+ *   -l  inject the recorded driver latency into every call
+ *   -t  keep the recorded time between calls
+ *   -n  replay the trace COUNT times
+ *   -v  print every call
+ *
+ * A get that reads something else than what was recorded means the
+ * value was changed outside of the traced process; those are counted
+ * as divergent and the fake mixer takes the recorded value.
+ */
+
+#ifndef __MINGW32__
+#define _CRT_SECURE_NO_DEPRECATE // get rid of sprintf security warnings on VS2005
+#define _CRT_NONSTDC_NO_DEPRECATE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <alxtrace.h>
+
+#if defined(_WIN32)
+ #include <windows.h>
+#else
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+#define NUM_CALLS   (ALX_TRACE_SET_CONTROL_DETAILS + 1)
+
+static const char *CallNames[NUM_CALLS] = {
+    NULL,
+    "open",
+    "close",
+    "get-dev-caps",
+    "get-line-info",
+    "get-line-controls",
+    "get-control-details",
+    "set-control-details"
+};
+
+///////////////////////////////////////////////////////
+// Clock
+
+static double nowUs()
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart * 1000000.0 / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+#endif
+}
+
+/*
+    Sleep most of the way, then spin, so short waits stay accurate.
+*/
+static void waitUntil(double deadline)
+{
+    double left;
+
+    while ((left = deadline - nowUs()) > 0) {
+        if (left > 2000) {
+#if defined(_WIN32)
+            Sleep((DWORD) (left / 1000) - 1);
+#else
+            usleep((useconds_t) left - 1000);
+#endif
+        }
+    }
+}
+
+///////////////////////////////////////////////////////
+// Fake mixer
+
+class FakeMixer
+{
+public:
+    FakeMixer(bool latency)
+        : divergent(0)
+        , _latency(latency)
+    {}
+
+    /*
+        With latency, a call returns only once the recorded duration of
+        the driver call has passed.
+    */
+    unsigned int call(const ALXtraceRecord &r) {
+        Key key(r.mixer, r.id);
+        double begin = nowUs();
+
+        switch (r.call) {
+        case ALX_TRACE_GET_CONTROL_DETAILS:
+            if (r.result == 0) {
+                std::map<Key, unsigned int>::iterator i = _values.find(key);
+                if (i != _values.end() && i->second != r.value) {
+                    ++divergent;
+                    i->second = r.value;
+                }
+                else if (i == _values.end()) {
+                    _values[key] = r.value;
+                }
+            }
+            break;
+
+        case ALX_TRACE_SET_CONTROL_DETAILS:
+            if (r.result == 0)
+                _values[key] = r.value;
+            break;
+
+        case ALX_TRACE_CLOSE:
+            forget(r.mixer);
+            break;
+
+        default:
+            break;
+        }
+
+        if (_latency)
+            waitUntil(begin + r.duration);
+        return r.result;
+    }
+
+    unsigned long divergent;
+
+private:
+    typedef std::pair<unsigned int, unsigned int> Key;
+
+    void forget(unsigned int mixer) {
+        std::map<Key, unsigned int>::iterator i = _values.begin();
+        while (i != _values.end()) {
+            if (i->first.first == mixer)
+                _values.erase(i++);
+            else
+                ++i;
+        }
+    }
+
+    std::map<Key, unsigned int> _values;
+    bool _latency;
+};
+
+///////////////////////////////////////////////////////
+// Statistics
+
+struct Stats
+{
+    unsigned long errors;
+    std::vector<double> recorded;
+
+    Stats() : errors(0) {}
+};
+
+static double percentile(std::vector<double> &samples, double p)
+{
+    size_t i;
+
+    if (samples.empty())
+        return 0;
+
+    std::sort(samples.begin(), samples.end());
+    i = (size_t) (p * (samples.size() - 1) + 0.5);
+    return samples[i];
+}
+
+static double total(const std::vector<double> &samples)
+{
+    double sum = 0;
+    for (size_t i = 0; i < samples.size(); i++)
+        sum += samples[i];
+    return sum;
+}
+
+static void printStats(Stats *stats, double elapsed, unsigned long divergent)
+{
+    int c;
+
+    printf("%-20s %8s %7s %10s %10s %10s\n", "call", "count", "errors",
+        "rec p50", "rec p99", "rec max");
+
+    for (c = 1; c < NUM_CALLS; c++) {
+        Stats &s = stats[c];
+        if (s.recorded.empty())
+            continue;
+        printf("%-20s %8lu %7lu %10.1f %10.1f %10.1f\n",
+            CallNames[c], (unsigned long) s.recorded.size(), s.errors,
+            percentile(s.recorded, 0.5), percentile(s.recorded, 0.99),
+            percentile(s.recorded, 1.0));
+    }
+
+    double driver = 0;
+    for (c = 1; c < NUM_CALLS; c++)
+        driver += total(stats[c].recorded);
+
+    printf("\nrecorded driver time %.3f ms, replay %.3f ms, %lu divergent gets\n",
+        driver / 1000, elapsed / 1000, divergent);
+}
+
+///////////////////////////////////////////////////////
+
+static bool readTrace(const char *filename, std::vector<ALXtraceRecord> &records)
+{
+    ALXtraceHeader header;
+    ALXtraceRecord record;
+    unsigned int count, first, i;
+    long size;
+    FILE *f;
+
+    f = fopen(filename, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "alxreplay: cannot open %s\n", filename);
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    // the records the header claims must fit in the file
+    if (fread(&header, sizeof(header), 1, f) != 1
+        || header.magic != ALX_TRACE_MAGIC || header.version != ALX_TRACE_VERSION
+        || header.recordSize != sizeof(ALXtraceRecord) || header.capacity <= 0
+        || (unsigned long) header.capacity > (size - sizeof(header)) / sizeof(ALXtraceRecord)) {
+        fprintf(stderr, "alxreplay: %s is not a trace file\n", filename);
+        fclose(f);
+        return false;
+    }
+
+    // once the ring wrapped, the oldest record follows the newest
+    count = (unsigned int) header.count;
+    first = 0;
+    if (count > (unsigned int) header.capacity) {
+        first = count % header.capacity;
+        count = header.capacity;
+    }
+
+    records.reserve(count);
+    for (i = 0; i < count; i++) {
+        fseek(f, (long) (sizeof(header) + ((first + i) % header.capacity) * sizeof(record)), SEEK_SET);
+        if (fread(&record, sizeof(record), 1, f) != 1)
+            break;
+        records.push_back(record);
+    }
+
+    fclose(f);
+    return true;
+}
+
+static int usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [-l] [-t] [-n COUNT] [-v] TRACE\n", program);
+    return 2;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<ALXtraceRecord> records;
+    Stats stats[NUM_CALLS];
+    bool latency = false, paced = false, verbose = false;
+    const char *filename = NULL;
+    double started, base;
+    int rounds = 1;
+    int i, n;
+    size_t r;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-l"))
+            latency = true;
+        else if (!strcmp(argv[i], "-t"))
+            paced = true;
+        else if (!strcmp(argv[i], "-v"))
+            verbose = true;
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            rounds = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && filename == NULL)
+            filename = argv[i];
+        else
+            return usage(argv[0]);
+    }
+
+    if (filename == NULL || rounds <= 0)
+        return usage(argv[0]);
+
+    if (!readTrace(filename, records))
+        return 1;
+
+    if (records.empty()) {
+        printf("empty trace\n");
+        return 0;
+    }
+
+    FakeMixer mixer(latency);
+
+    started = nowUs();
+    for (n = 0; n < rounds; n++) {
+        base = nowUs() - (double) records[0].start;
+
+        for (r = 0; r < records.size(); r++) {
+            const ALXtraceRecord &record = records[r];
+            if (record.call == 0 || record.call >= NUM_CALLS)
+                continue;
+
+            if (paced)
+                waitUntil(base + (double) record.start);
+
+            if (mixer.call(record) != 0)
+                stats[record.call].errors++;
+
+            stats[record.call].recorded.push_back(record.duration);
+
+            if (verbose) {
+                printf("%12.0f %-20s mixer=%08x id=%08x flags=%08x items=%u value=%u result=%u %uus\n",
+                    (double) record.start, CallNames[record.call], record.mixer, record.id,
+                    record.flags, record.items, record.value, record.result, record.duration);
+            }
+        }
+    }
+
+    printStats(stats, nowUs() - started, mixer.divergent);
+    return 0;
+}
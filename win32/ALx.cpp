@@ -42,9 +42,17 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 #include <memory.h>
+#include <time.h>
+#include <new>
 #include <al.h>
 #include <alx.h>
+#include <alxtrace.h>
+
+#include "Levels.h"
+#include "Queue.h"
+#include "Shared.h"
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -52,17 +60,530 @@
 
 #pragma warning (disable: 4290)
 
+///////////////////////////////////////////////////////
+// Memory
+
+namespace alx {
+
+void * ALX_APIENTRY defaultAlloc(size_t size, void *)
+{
+    return malloc(size);
+}
+
+void ALX_APIENTRY defaultFree(void *ptr, void *)
+{
+    free(ptr);
+}
+
+LPALXALLOC AllocFunc = defaultAlloc;
+LPALXFREE FreeFunc = defaultFree;
+void *AllocData = NULL;
+
+void *allocate(size_t size, LPALXFREE *freeFunc, void **data)
+{
+    *freeFunc = FreeFunc;
+    *data = AllocData;
+    return AllocFunc(size, AllocData);
+}
+
+#define ALX_ARENA_SIZE 4096
+
+/*
+    Everything a device owns is carved out of its arena, which grows by
+    chunks taken from the user allocator and is given back all at once
+    when the device is closed. The arena remembers the allocator it was
+    created with, so devices outlive a later alxSetAllocator call.
+*/
+class Arena
+{
+public:
+    static Arena *create() {
+        char *block = (char *) AllocFunc(sizeof(Arena) + sizeof(Chunk) + ALX_ARENA_SIZE, AllocData);
+        if (block == NULL)
+            return NULL;
+
+        Arena *arena = new (block) Arena;
+        arena->_chunks = reinterpret_cast<Chunk *>(block + sizeof(Arena));
+        arena->_chunks->next = NULL;
+        arena->_chunks->size = ALX_ARENA_SIZE;
+        arena->_chunks->used = 0;
+        return arena;
+    }
+
+    static void destroy(Arena *arena) {
+        Chunk *chunk, *next;
+
+        if (arena == NULL)
+            return;
+
+        // the first chunk lives in the arena block, at the list tail
+        for (chunk = arena->_chunks; chunk->next != NULL; chunk = next) {
+            next = chunk->next;
+            arena->_free(chunk, arena->_data);
+        }
+        arena->_free(arena, arena->_data);
+    }
+
+    void *alloc(size_t size) {
+        Chunk *chunk = _chunks;
+
+        size = (size + 7) & ~(size_t) 7;
+        if (chunk->size - chunk->used < size) {
+            size_t chunkSize = size > ALX_ARENA_SIZE ? size : ALX_ARENA_SIZE;
+
+            chunk = (Chunk *) _alloc(sizeof(Chunk) + chunkSize, _data);
+            if (chunk == NULL)
+                return NULL;
+
+            chunk->next = _chunks;
+            chunk->size = chunkSize;
+            chunk->used = 0;
+            _chunks = chunk;
+        }
+
+        void *ptr = reinterpret_cast<char *>(chunk + 1) + chunk->used;
+        chunk->used += size;
+        return ptr;
+    }
+
+    ALXchar *strdup(const ALXchar *s) {
+        size_t size = strlen(s) + 1;
+        ALXchar *copy = (ALXchar *) alloc(size);
+        if (copy != NULL)
+            memcpy(copy, s, size);
+        return copy;
+    }
+
+private:
+    // sized so that chunk data stays 8 byte aligned
+    struct Chunk
+    {
+        Chunk      *next;
+        size_t      size;
+        size_t      used;
+        size_t      reserved;
+    };
+
+    Arena()
+        : _chunks(NULL), _alloc(AllocFunc), _free(FreeFunc), _data(AllocData)
+    {}
+
+    Chunk      *_chunks;
+    LPALXALLOC  _alloc;
+    LPALXFREE   _free;
+    void       *_data;
+};
+
+} // namespace alx
+
+///////////////////////////////////////////////////////
+// Driver
+
+namespace alx {
+
+/*
+    Every call to the mixer driver goes through 'driver', which points
+    either straight to winmm or to the tracing wrappers below.
+*/
+struct Driver
+{
+    MMRESULT (WINAPI *open)(LPHMIXER, UINT, DWORD_PTR, DWORD_PTR, DWORD);
+    MMRESULT (WINAPI *close)(HMIXER);
+    MMRESULT (WINAPI *getDevCaps)(UINT_PTR, LPMIXERCAPS, UINT);
+    MMRESULT (WINAPI *getLineInfo)(HMIXEROBJ, LPMIXERLINE, DWORD);
+    MMRESULT (WINAPI *getLineControls)(HMIXEROBJ, LPMIXERLINECONTROLS, DWORD);
+    MMRESULT (WINAPI *getControlDetails)(HMIXEROBJ, LPMIXERCONTROLDETAILS, DWORD);
+    MMRESULT (WINAPI *setControlDetails)(HMIXEROBJ, LPMIXERCONTROLDETAILS, DWORD);
+};
+
+const Driver Winmm = {
+    mixerOpen,
+    mixerClose,
+    mixerGetDevCaps,
+    mixerGetLineInfo,
+    mixerGetLineControls,
+    mixerGetControlDetails,
+    mixerSetControlDetails
+};
+
+const Driver *driver = &Winmm;
+
+/*
+    Ring of driver call records in a memory-mapped file, see alxtrace.h.
+    Writers reserve their record with an interlocked increment, so
+    devices used from several threads are traced too.
+*/
+class Trace
+{
+public:
+    Trace()
+        : _file(INVALID_HANDLE_VALUE), _mapping(NULL), _header(NULL), _records(NULL)
+    {}
+
+    bool open(const char *filename, ALXint capacity) {
+        DWORD size;
+
+        // the whole ring is mapped at once, so it must fit a DWORD
+        if (capacity <= 0 || (DWORD) capacity > (MAXDWORD - sizeof(ALXtraceHeader)) / sizeof(ALXtraceRecord))
+            return false;
+        size = (DWORD) (sizeof(ALXtraceHeader) + capacity * sizeof(ALXtraceRecord));
+
+        _file = CreateFile(filename, GENERIC_READ|GENERIC_WRITE, FILE_SHARE_READ,
+            NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        _mapping = CreateFileMapping(_file, NULL, PAGE_READWRITE, 0, size, NULL);
+        if (_mapping == NULL) {
+            close();
+            return false;
+        }
+
+        _header = (ALXtraceHeader *) MapViewOfFile(_mapping, FILE_MAP_WRITE, 0, 0, size);
+        if (_header == NULL) {
+            close();
+            return false;
+        }
+
+        memset(_header, 0, sizeof(ALXtraceHeader));
+        _header->magic = ALX_TRACE_MAGIC;
+        _header->version = ALX_TRACE_VERSION;
+        _header->capacity = capacity;
+        _header->recordSize = sizeof(ALXtraceRecord);
+        _header->started = (ALXint64) time(NULL);
+        _records = reinterpret_cast<ALXtraceRecord *>(_header + 1);
+
+        QueryPerformanceFrequency(&_frequency);
+        QueryPerformanceCounter(&_base);
+        return true;
+    }
+
+    void close() {
+        if (_header != NULL)
+            UnmapViewOfFile(_header);
+        if (_mapping != NULL)
+            CloseHandle(_mapping);
+        if (_file != INVALID_HANDLE_VALUE)
+            CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+        _mapping = NULL;
+        _header = NULL;
+        _records = NULL;
+    }
+
+    LONGLONG now() const {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    void record(unsigned short call, LONGLONG start, UINT_PTR mixer, DWORD id,
+                DWORD flags, DWORD items, DWORD value, MMRESULT result) {
+        LONGLONG end = now();
+        LONG n = InterlockedIncrement((volatile LONG *) &_header->count) - 1;
+        ALXtraceRecord &r = _records[(ULONG) n % (ULONG) _header->capacity];
+
+        r.start = (ALXint64) ((start - _base.QuadPart) * 1000000 / _frequency.QuadPart);
+        r.duration = (unsigned int) ((end - start) * 1000000 / _frequency.QuadPart);
+        r.call = call;
+        r.items = (unsigned short) items;
+        r.mixer = (unsigned int) mixer;
+        r.id = id;
+        r.flags = flags;
+        r.value = value;
+        r.result = result;
+        r.reserved = 0;
+    }
+
+private:
+    HANDLE          _file;
+    HANDLE          _mapping;
+    ALXtraceHeader *_header;
+    ALXtraceRecord *_records;
+    LARGE_INTEGER   _base;
+    LARGE_INTEGER   _frequency;
+};
+
+Trace Tracer;
+
+DWORD detailsValue(const MIXERCONTROLDETAILS *details, DWORD flags)
+{
+    const MIXERCONTROLDETAILS_BOOLEAN *list;
+    DWORD i;
+
+    if ((flags & MIXER_GETCONTROLDETAILSF_QUERYMASK) != MIXER_GETCONTROLDETAILSF_VALUE
+        || details->paDetails == NULL)
+        return 0;
+
+    if (details->cMultipleItems == 0)
+        return *(const DWORD *) details->paDetails;
+
+    list = (const MIXERCONTROLDETAILS_BOOLEAN *) details->paDetails;
+    for (i = 0; i < details->cMultipleItems; i++) {
+        if (list[i].fValue)
+            return i;
+    }
+    return (DWORD) -1;
+}
+
+MMRESULT WINAPI tracedOpen(LPHMIXER phmx, UINT uMxId, DWORD_PTR dwCallback, DWORD_PTR dwInstance, DWORD fdwOpen)
+{
+    LONGLONG start = Tracer.now();
+    MMRESULT res = Winmm.open(phmx, uMxId, dwCallback, dwInstance, fdwOpen);
+    Tracer.record(ALX_TRACE_OPEN, start, res == MMSYSERR_NOERROR ? (UINT_PTR) *phmx : 0,
+        uMxId, fdwOpen, 0, 0, res);
+    return res;
+}
+
+MMRESULT WINAPI tracedClose(HMIXER hmx)
+{
+    LONGLONG start = Tracer.now();
+    MMRESULT res = Winmm.close(hmx);
+    Tracer.record(ALX_TRACE_CLOSE, start, (UINT_PTR) hmx, 0, 0, 0, 0, res);
+    return res;
+}
+
+MMRESULT WINAPI tracedGetDevCaps(UINT_PTR uMxId, LPMIXERCAPS caps, UINT cbmxcaps)
+{
+    LONGLONG start = Tracer.now();
+    MMRESULT res = Winmm.getDevCaps(uMxId, caps, cbmxcaps);
+    Tracer.record(ALX_TRACE_GET_DEV_CAPS, start, uMxId, 0, 0, 0,
+        res == MMSYSERR_NOERROR ? caps->vDriverVersion : 0, res);
+    return res;
+}
+
+MMRESULT WINAPI tracedGetLineInfo(HMIXEROBJ hmx, LPMIXERLINE line, DWORD flags)
+{
+    DWORD id;
+
+    switch (flags & MIXER_GETLINEINFOF_QUERYMASK) {
+    case MIXER_GETLINEINFOF_COMPONENTTYPE: id = line->dwComponentType; break;
+    case MIXER_GETLINEINFOF_SOURCE:        id = (line->dwDestination << 16) | line->dwSource; break;
+    case MIXER_GETLINEINFOF_DESTINATION:   id = line->dwDestination; break;
+    default:                               id = line->dwLineID; break;
+    }
+
+    LONGLONG start = Tracer.now();
+    MMRESULT res = Winmm.getLineInfo(hmx, line, flags);
+    Tracer.record(ALX_TRACE_GET_LINE_INFO, start, (UINT_PTR) hmx, id, flags, 0,
+        res == MMSYSERR_NOERROR ? line->dwLineID : 0, res);
+    return res;
+}
+
+MMRESULT WINAPI tracedGetLineControls(HMIXEROBJ hmx, LPMIXERLINECONTROLS controls, DWORD flags)
+{
+    DWORD id;
+
+    switch (flags & MIXER_GETLINECONTROLSF_QUERYMASK) {
+    case MIXER_GETLINECONTROLSF_ONEBYID:   id = controls->dwControlID; break;
+    case MIXER_GETLINECONTROLSF_ONEBYTYPE: id = controls->dwControlType; break;
+    default:                               id = controls->dwLineID; break;
+    }
+
+    LONGLONG start = Tracer.now();
+    MMRESULT res = Winmm.getLineControls(hmx, controls, flags);
+    Tracer.record(ALX_TRACE_GET_LINE_CONTROLS, start, (UINT_PTR) hmx, id, flags, 0,
+        res == MMSYSERR_NOERROR ? controls->pamxctrl->dwControlID : 0, res);
+    return res;
+}
+
+MMRESULT WINAPI tracedGetControlDetails(HMIXEROBJ hmx, LPMIXERCONTROLDETAILS details, DWORD flags)
+{
+    LONGLONG start = Tracer.now();
+    MMRESULT res = Winmm.getControlDetails(hmx, details, flags);
+    Tracer.record(ALX_TRACE_GET_CONTROL_DETAILS, start, (UINT_PTR) hmx, details->dwControlID,
+        flags, details->cMultipleItems, res == MMSYSERR_NOERROR ? detailsValue(details, flags) : 0, res);
+    return res;
+}
+
+MMRESULT WINAPI tracedSetControlDetails(HMIXEROBJ hmx, LPMIXERCONTROLDETAILS details, DWORD flags)
+{
+    LONGLONG start = Tracer.now();
+    MMRESULT res = Winmm.setControlDetails(hmx, details, flags);
+    Tracer.record(ALX_TRACE_SET_CONTROL_DETAILS, start, (UINT_PTR) hmx, details->dwControlID,
+        flags, details->cMultipleItems, detailsValue(details, flags), res);
+    return res;
+}
+
+const Driver Traced = {
+    tracedOpen,
+    tracedClose,
+    tracedGetDevCaps,
+    tracedGetLineInfo,
+    tracedGetLineControls,
+    tracedGetControlDetails,
+    tracedSetControlDetails
+};
+
+} // namespace alx
+
+///////////////////////////////////////////////////////
+// Trace events
+
+namespace alx {
+
+/*
+    Scoped events written as a Chrome trace event JSON array, which
+    chrome://tracing and the Perfetto UI both load, even when the process
+    died before closing the array. Timestamps are QueryPerformanceCounter
+    microseconds, so the events line up with spans an application takes
+    from the same clock. While disabled, a span costs one flag test.
+*/
+class EventTrace
+{
+public:
+    EventTrace()
+        : enabled(false), _file(NULL), _first(true), _initialized(false)
+    {}
+
+    bool open(const char *filename) {
+        if (!_initialized) {
+            InitializeCriticalSection(&_lock);
+            QueryPerformanceFrequency(&_frequency);
+            _initialized = true;
+        }
+
+        EnterCriticalSection(&_lock);
+        _file = fopen(filename, "w");
+        if (_file != NULL) {
+            fputs("[\n", _file);
+            _first = true;
+            enabled = true;
+        }
+        LeaveCriticalSection(&_lock);
+
+        return _file != NULL;
+    }
+
+    void close() {
+        if (!_initialized)
+            return;
+
+        enabled = false;
+        EnterCriticalSection(&_lock);
+        if (_file != NULL) {
+            fputs("\n]\n", _file);
+            fclose(_file);
+            _file = NULL;
+        }
+        LeaveCriticalSection(&_lock);
+    }
+
+    LONGLONG now() const {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    void complete(const char *name, LONGLONG start, LONGLONG end, bool hasId, DWORD id) {
+        double ts = start * 1000000.0 / _frequency.QuadPart;
+        double dur = (end - start) * 1000000.0 / _frequency.QuadPart;
+
+        EnterCriticalSection(&_lock);
+        if (_file != NULL) {
+            fprintf(_file, "%s{\"name\":\"%s\",\"cat\":\"alx\",\"ph\":\"X\","
+                "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu",
+                _first ? "" : ",\n", name, ts, dur,
+                (unsigned long) GetCurrentProcessId(), (unsigned long) GetCurrentThreadId());
+            if (hasId)
+                fprintf(_file, ",\"args\":{\"id\":%lu}", (unsigned long) id);
+            fputc('}', _file);
+            _first = false;
+        }
+        LeaveCriticalSection(&_lock);
+    }
+
+    volatile bool       enabled;
+
+private:
+    FILE               *_file;
+    bool                _first;
+    bool                _initialized;
+    CRITICAL_SECTION    _lock;
+    LARGE_INTEGER       _frequency;
+};
+
+EventTrace Events;
+
+class Span
+{
+public:
+    Span(const char *name)
+        : _name(Events.enabled ? name : NULL), _hasId(false), _id(0)
+    {
+        if (_name)
+            _start = Events.now();
+    }
+
+    Span(const char *name, DWORD id)
+        : _name(Events.enabled ? name : NULL), _hasId(true), _id(id)
+    {
+        if (_name)
+            _start = Events.now();
+    }
+
+    ~Span() {
+        if (_name)
+            Events.complete(_name, _start, Events.now(), _hasId, _id);
+    }
+
+private:
+    const char *_name;
+    bool        _hasId;
+    DWORD       _id;
+    LONGLONG    _start;
+};
+
+} // namespace alx
+
 ///////////////////////////////////////////////////////
 // ALMix Related helper functions
 
-struct ALXctrl
+// Every line found under a mixer destination is kept in a single block:
+// the header below is followed by the parallel id arrays and by a pool
+// holding each distinct line name once. Volume and mute ids of a line
+// are stored side by side, so both are found with a single lookup.
+
+struct ALXlineControls
+{
+    DWORD       volumeID;
+    DWORD       muteID;
+};
+
+struct ALXlines
 {
-    ALXchar    *name;
-    DWORD       lineID;
-    DWORD       controlID;
+    UINT             count;
+    DWORD           *lineID;
+    ALXlineControls *controls;
+    UINT            *nameOffset;
+    ALXchar         *names;
+
+    const ALXchar *name(UINT i) const {
+        return names + nameOffset[i];
+    }
 
-    ALXctrl() : name(0), lineID(0), controlID(0) {}
-    ~ALXctrl() { free(name); }
+    static ALXlines *create(alx::Arena *arena, UINT count, UINT poolSize) {
+        size_t size = sizeof(ALXlines)
+                    + count * sizeof(DWORD)
+                    + count * sizeof(ALXlineControls)
+                    + count * sizeof(UINT)
+                    + poolSize;
+        char *block = (char *) arena->alloc(size);
+        if (block == NULL)
+            return NULL;
+
+        ALXlines *lines = reinterpret_cast<ALXlines *>(block);
+        block += sizeof(ALXlines);
+        lines->count = count;
+        lines->lineID = reinterpret_cast<DWORD *>(block);
+        block += count * sizeof(DWORD);
+        lines->controls = reinterpret_cast<ALXlineControls *>(block);
+        block += count * sizeof(ALXlineControls);
+        lines->nameOffset = reinterpret_cast<UINT *>(block);
+        block += count * sizeof(UINT);
+        lines->names = block;
+        return lines;
+    }
 };
 
 namespace alx {
@@ -194,6 +715,23 @@ private:
     DWORD _controlType;
 };
 
+struct ControlID
+{
+public:
+    explicit ControlID(DWORD dwControlID)
+        : _controlID(dwControlID)
+    {}
+    DWORD operator()() const {
+        return MIXER_GETLINECONTROLSF_ONEBYID;
+    }
+    void operator()(MIXERLINECONTROLS &ctrls) const {
+        ctrls.dwControlID = _controlID;
+    }
+
+private:
+    DWORD _controlID;
+};
+
 template<typename T>
 MMRESULT getLineInfo(HMIXEROBJ hMixer, T &what, MIXERLINE &line)
 {
@@ -201,7 +739,7 @@ MMRESULT getLineInfo(HMIXEROBJ hMixer, T &what, MIXERLINE &line)
     line.cbStruct = sizeof(MIXERLINE);
     what(line);
 
-    return mixerGetLineInfo(hMixer, &line, MIXER_OBJECTF_HMIXER|what());
+    return driver->getLineInfo(hMixer, &line, MIXER_OBJECTF_HMIXER|what());
 }
 
 template<typename T>
@@ -220,7 +758,7 @@ MMRESULT getLineControl(HMIXEROBJ hMixer, DWORD dwLineID, T &what, MIXERCONTROL
     memset(&control, 0, sizeof(control));
     control.cbStruct = sizeof(MIXERCONTROL);
 
-    return mixerGetLineControls(hMixer, &controls, MIXER_OBJECTF_HMIXER|what());
+    return driver->getLineControls(hMixer, &controls, MIXER_OBJECTF_HMIXER|what());
 }
 
 template<typename T>
@@ -283,120 +821,370 @@ DWORD findControl(HMIXEROBJ hMixer, T &whatLine1, T &whatLine2, U &whatControl)
     return -1;
 }
 
-template<typename T, typename U>
-UINT getControls(HMIXEROBJ hMixer, T &whatLine, U &whatControl, ALXctrl **pctrls)
+/*
+    Returns the offset of 'name' in 'pool', appending it only when an
+    identical name was not stored before.
+*/
+inline UINT internName(ALXchar *pool, UINT &poolSize, const UINT *offsets, UINT num, const ALXchar *name)
+{
+    UINT k;
+
+    for (k = 0; k < num; k++) {
+        if (!strcmp(pool + offsets[k], name))
+            return offsets[k];
+    }
+
+    k = poolSize;
+    strcpy(pool + poolSize, name);
+    poolSize += strlen(name) + 1;
+    return k;
+}
+
+/*
+    The table is sized for every line of the destination, with room in
+    the pool for all of their names to be distinct.
+*/
+template<typename T>
+ALXlines *getControls(Arena *arena, HMIXEROBJ hMixer, T &whatLine)
 {
     MMRESULT res;
     MIXERLINE line;
-    ALXctrl *ctrls = 0;
+    ALXlines *lines;
+    DWORD dwDestination;
+    UINT poolSize = 0;
     UINT num;
     UINT s;
 
-    do {
-        res = getLineInfo(hMixer, whatLine, line);
-        if (res != MMSYSERR_NOERROR)
-            break;
-
-        num = (UINT) line.cConnections;
-
-        ctrls = new ALXctrl[num];
-        if (ctrls == NULL)
-            break;
+    res = getLineInfo(hMixer, whatLine, line);
+    if (res != MMSYSERR_NOERROR)
+        return NULL;
 
-        for (s = 0; s < num; s++) {
-            res = getLineInfo(hMixer, Source(line.dwDestination, s), line);
-            if (res != MMSYSERR_NOERROR)
-                break;
+    num = (UINT) line.cConnections;
+    if (num == 0)
+        return NULL;
 
-            ctrls[s].lineID    = line.dwLineID;
-            ctrls[s].name      = strdup(line.szName);
-            ctrls[s].controlID = getLineControlID(hMixer, line.dwLineID, whatControl);
-        }
+    lines = ALXlines::create(arena, num, num * MIXER_LONG_NAME_CHARS);
+    if (lines == NULL)
+        return NULL;
 
-        if (s != num)
-            break;
+    dwDestination = line.dwDestination;
 
-        *pctrls = ctrls;
-        return num;
+    for (s = 0; s < num; s++) {
+        res = getLineInfo(hMixer, Source(dwDestination, s), line);
+        if (res != MMSYSERR_NOERROR)
+            return NULL;
 
-    } while (FALSE);
+        line.szName[MIXER_LONG_NAME_CHARS - 1] = '\0';
 
-    delete [] ctrls;
+        lines->lineID[s]             = line.dwLineID;
+        lines->controls[s].volumeID  = getLineControlID(hMixer, line.dwLineID, ControlType(Volume));
+        lines->controls[s].muteID    = getLineControlID(hMixer, line.dwLineID, ControlType(Mute));
+        lines->nameOffset[s]         = internName(lines->names, poolSize, lines->nameOffset, s, line.szName);
+    }
 
-    return 0;
+    return lines;
 }
 
-template<typename T, typename U>
-UINT getControls(HMIXEROBJ hMixer, T &whatLine1, T &whatLine2, U &whatControl, ALXctrl **pctrls)
+template<typename T>
+ALXlines *getControls(Arena *arena, HMIXEROBJ hMixer, T &whatLine1, T &whatLine2)
 {
-    UINT num;
+    ALXlines *lines;
 
-    num = getControls(hMixer, whatLine1, whatControl, pctrls);
-    if (num > 0)
-        return num;
+    lines = getControls(arena, hMixer, whatLine1);
+    if (lines != NULL)
+        return lines;
 
-    num = getControls(hMixer, whatLine2, whatControl, pctrls);
-    if (num > 0)
-        return num;
-
-    return 0;
+    return getControls(arena, hMixer, whatLine2);
 }
 
-class Control
+/*
+    What is known of a control: its range, how many steps the hardware
+    has in it, and the raw value last read from or written to it.
+*/
+struct ControlInfo
 {
-public:
-    Control(HMIXEROBJ hMixer, DWORD dwControlID)
-        : _hMixer(hMixer)
-    {
-        memset(&_details, 0, sizeof(_details));
-        _details.cbStruct = sizeof(MIXERCONTROLDETAILS);
-        _details.dwControlID = dwControlID;
-        _details.cChannels = 1; /* all channels */
-        _details.cMultipleItems = 0;
-    }
+    DWORD       id;
+    DWORD       minimum;
+    DWORD       maximum;
+    DWORD       steps;
+    DWORD       items;
+    DWORD       value;
+    bool        known;
+
+    ControlInfo()
+        : id(-1), minimum(0), maximum(65535), steps(65536), items(0), value(0), known(false)
+    {}
 
-    ALXfloat getVolume() {
-        MMRESULT result;
-        MIXERCONTROLDETAILS_UNSIGNED value;
+    /*
+        Nearest step to 'volume', which must be in [0, 1].
+    */
+    DWORD toRaw(ALXfloat volume) const {
+        double span = (double) (maximum - minimum);
+        DWORD k;
 
-        result = getValue(value);
-        if (result != MMSYSERR_NOERROR)
-            return -1.0;
+        if (steps < 2)
+            return minimum + (DWORD) (volume * span + 0.5);
 
-        return (ALXfloat)(value.dwValue / 65535.0);
+        k = (DWORD) (volume * (steps - 1) + 0.5);
+        return minimum + (DWORD) (k * span / (steps - 1) + 0.5);
     }
 
-    MMRESULT setVolume(ALXfloat volume) {
-        if (volume < 0.0f || volume > 1.0f)
-            return MMSYSERR_INVALPARAM;
+    /*
+        Units between two steps, at least 1.
+    */
+    DWORD stepSize() const {
+        if (steps < 2 || maximum - minimum < steps - 1)
+            return 1;
+        return (maximum - minimum) / (steps - 1);
+    }
 
-        MIXERCONTROLDETAILS_UNSIGNED value = { 0 };
-        value.dwValue = (unsigned short)(volume * 65535.0);
+    ALXfloat fromRaw(DWORD raw) const {
+        if (maximum <= minimum || raw <= minimum)
+            return 0.0f;
+        if (raw >= maximum)
+            return 1.0f;
+        return (ALXfloat) ((double) (raw - minimum) / (maximum - minimum));
+    }
+};
 
-        return setValue(value);
+/*
+    The ControlInfo of every control of a device, taken from the arena
+    when the device is opened. A control's range is asked to the driver
+    the first time it is used. Known values are only trusted once the
+    table is watched, that is, once driver notifications forget those
+    that change.
+*/
+class ControlTable
+{
+public:
+    ControlTable() : _infos(NULL), _count(0), _capacity(0), _watched(false) {}
+
+    bool create(Arena *arena, int capacity) {
+        _infos = (ControlInfo *) arena->alloc(capacity * sizeof(ControlInfo));
+        if (_infos == NULL)
+            return false;
+        _count = 0;
+        _capacity = capacity;
+        return true;
     }
 
-    ALXboolean disabled() {
-        MMRESULT result;
-        MIXERCONTROLDETAILS_BOOLEAN value;
+    /*
+        NULL when 'id' is no control, or the table is full.
+    */
+    ControlInfo *find(HMIXEROBJ hMixer, DWORD id) {
+        MIXERCONTROL control;
+        ControlInfo *info;
+        int i;
 
-        result = getValue(value);
-        if (result != MMSYSERR_NOERROR)
-            return ALX_TRUE;
+        if (id == (DWORD) -1)
+            return NULL;
+
+        for (i = 0; i < _count; i++) {
+            if (_infos[i].id == id)
+                return &_infos[i];
+        }
 
-        return value.fValue ? ALX_TRUE : ALX_FALSE;
+        if (_count == _capacity)
+            return NULL;
+
+        info = new (&_infos[_count++]) ControlInfo;
+        info->id = id;
+        if (getLineControl(hMixer, 0, ControlID(id), control) == MMSYSERR_NOERROR
+            && control.Bounds.dwMaximum > control.Bounds.dwMinimum) {
+            info->minimum = control.Bounds.dwMinimum;
+            info->maximum = control.Bounds.dwMaximum;
+            info->steps = control.Metrics.cSteps;
+            info->items = control.cMultipleItems;
+        }
+        return info;
     }
 
-    MMRESULT disable(ALXboolean flag) {
-        MIXERCONTROLDETAILS_BOOLEAN value = { 0 };
-        value.fValue = flag ? TRUE : FALSE;
+    void forget(DWORD id) {
+        int i;
 
-        return setValue(value);
+        for (i = 0; i < _count; i++) {
+            if (_infos[i].id == id)
+                _infos[i].known = false;
+        }
     }
 
-private:
-    HMIXEROBJ                    _hMixer;
+    /*
+        Forget the cached values, when the controls may have been
+        changed behind our back.
+    */
+    void invalidate() {
+        int i;
+
+        for (i = 0; i < _count; i++)
+            _infos[i].known = false;
+    }
+
+    /*
+        Notifications started; what was known before may be stale.
+    */
+    void watch() {
+        invalidate();
+        _watched = true;
+    }
+
+    bool watched() const {
+        return _watched;
+    }
+
+private:
+    ControlInfo    *_infos;
+    int             _count;
+    int             _capacity;
+    bool            _watched;
+};
+
+/*
+    Reads and writes a control. Volumes are snapped to the control's
+    steps. With 'skipKnown', a read of a control whose value is known,
+    or a write of that same value, is not sent to the driver; only
+    watched controls can tell, since anyone else may change a control.
+*/
+class Control
+{
+public:
+    Control(HMIXEROBJ hMixer, DWORD dwControlID, ControlInfo *info = NULL, bool skipKnown = false)
+        : _hMixer(hMixer), _info(info), _skipKnown(skipKnown)
+    {
+        memset(&_details, 0, sizeof(_details));
+        _details.cbStruct = sizeof(MIXERCONTROLDETAILS);
+        _details.dwControlID = dwControlID;
+        _details.cChannels = 1; /* all channels */
+        _details.cMultipleItems = 0;
+    }
+
+    MMRESULT getRaw(DWORD &raw) {
+        MMRESULT result;
+        MIXERCONTROLDETAILS_UNSIGNED value;
+
+        if (_skipKnown && info()->known) {
+            raw = info()->value;
+            return MMSYSERR_NOERROR;
+        }
+
+        result = getValue(value);
+        if (result == MMSYSERR_NOERROR) {
+            remember(value.dwValue);
+            raw = value.dwValue;
+        }
+
+        return result;
+    }
+
+    MMRESULT setRaw(DWORD raw) {
+        if (raw < info()->minimum || raw > info()->maximum)
+            return MMSYSERR_INVALPARAM;
+
+        MIXERCONTROLDETAILS_UNSIGNED value = { 0 };
+        value.dwValue = raw;
+
+        return setCached(value, raw);
+    }
+
+    const ControlInfo &range() {
+        return *info();
+    }
+
+    MMRESULT getVolume(ALXfloat &volume) {
+        MMRESULT result;
+        DWORD raw;
+
+        result = getRaw(raw);
+        if (result == MMSYSERR_NOERROR)
+            volume = info()->fromRaw(raw);
+
+        return result;
+    }
+
+    ALXfloat getVolume() {
+        ALXfloat volume = -1.0;
+        getVolume(volume);
+        return volume;
+    }
+
+    /*
+        On success 'volume' becomes the level the control holds, that
+        is, snapped to its steps.
+    */
+    MMRESULT setVolume(ALXfloat &volume) {
+        MMRESULT result;
+        DWORD raw;
+
+        if (volume < 0.0f || volume > 1.0f)
+            return MMSYSERR_INVALPARAM;
+
+        raw = info()->toRaw(volume);
+        result = setRaw(raw);
+        if (result == MMSYSERR_NOERROR)
+            volume = info()->fromRaw(raw);
+        return result;
+    }
+
+    MMRESULT getDisabled(ALXboolean &flag) {
+        MMRESULT result;
+        MIXERCONTROLDETAILS_BOOLEAN value;
+
+        if (_skipKnown && info()->known) {
+            flag = info()->value ? ALX_TRUE : ALX_FALSE;
+            return MMSYSERR_NOERROR;
+        }
+
+        result = getValue(value);
+        if (result == MMSYSERR_NOERROR) {
+            remember(value.fValue ? 1 : 0);
+            flag = value.fValue ? ALX_TRUE : ALX_FALSE;
+        }
+
+        return result;
+    }
+
+    ALXboolean disabled() {
+        ALXboolean flag = ALX_TRUE;
+        getDisabled(flag);
+        return flag;
+    }
+
+    MMRESULT disable(ALXboolean flag) {
+        MIXERCONTROLDETAILS_BOOLEAN value = { 0 };
+        value.fValue = flag ? TRUE : FALSE;
+
+        return setCached(value, flag ? 1 : 0);
+    }
+
+private:
+    HMIXEROBJ                    _hMixer;
     MIXERCONTROLDETAILS          _details;
+    ControlInfo                 *_info;
+    ControlInfo                  _default;
+    bool                         _skipKnown;
+
+    ControlInfo *info() {
+        return _info ? _info : &_default;
+    }
+
+    void remember(DWORD raw) {
+        info()->value = raw;
+        info()->known = true;
+    }
+
+    template<typename T>
+    MMRESULT setCached(T &value, DWORD raw) {
+        MMRESULT result;
+
+        if (_skipKnown && info()->known && info()->value == raw)
+            return MMSYSERR_NOERROR;
+
+        result = setValue(value);
+        if (result == MMSYSERR_NOERROR)
+            remember(raw);
+        else
+            info()->known = false;
+        return result;
+    }
 
     template<typename T>
     MMRESULT getValue(T &value) {
@@ -404,17 +1192,19 @@ private:
         _details.paDetails = &value;
         memset(&value, 0, sizeof(value));
 
-        return mixerGetControlDetails(
+        return driver->getControlDetails(
             _hMixer, &_details,
             MIXER_OBJECTF_HMIXER|MIXER_GETCONTROLDETAILSF_VALUE);
     }
 
     template<typename T>
     MMRESULT setValue(T &value) {
+        Span span("setControlDetails", _details.dwControlID);
+
         _details.cbDetails = sizeof(value);
         _details.paDetails = &value;
 
-        return mixerSetControlDetails(
+        return driver->setControlDetails(
             _hMixer, &_details,
             MIXER_OBJECTF_HMIXER|MIXER_GETCONTROLDETAILSF_VALUE);
     }
@@ -466,1042 +1256,4478 @@ MMRESULT getControlDetails(HMIXEROBJ hMixer, DWORD dwControlID, T &what)
 
     memset(&details, 0, sizeof(details));
     details.cbStruct = sizeof(MIXERCONTROLDETAILS);
+    details.dwControlID = dwControlID;
     what(details);
 
-    return mixerGetControlDetails(hMixer,
+    return driver->getControlDetails(hMixer,
         &details, MIXER_OBJECTF_HMIXER|what.getFlag());
 }
 
 template<typename T>
 MMRESULT setControlDetails(HMIXEROBJ hMixer, DWORD dwControlID, T &what)
 {
+    Span span("setControlDetails", dwControlID);
     MIXERCONTROLDETAILS details;
 
     memset(&details, 0, sizeof(details));
     details.cbStruct = sizeof(MIXERCONTROLDETAILS);
+    details.dwControlID = dwControlID;
     what(details);
 
-    return mixerGetControlDetails(hMixer,
+    return driver->setControlDetails(hMixer,
         &details, MIXER_OBJECTF_HMIXER|what.setFlag());
 }
 
-} // namespace alx
-
-//////////////////////////////////////////////////////////////////////////////
+#ifndef AL_FORMAT_MONO_FLOAT32
+#define AL_FORMAT_MONO_FLOAT32      0x10010
+#define AL_FORMAT_STEREO_FLOAT32    0x10011
+#endif
 
-struct ALXdevice_struct
+/*
+    Ring of captured frames with a single writer, the thread pumping the
+    capture device, and any number of readers, which get windows of up
+    to 'window' frames by pointer. The first 'window' frames of the ring
+    are mirrored past its end, so every window is contiguous.
+
+    Positions count frames since the tap was set, modulo 2^32. Before
+    writing, the writer publishes how far it is about to write; frames
+    a whole ring behind that may be overwritten already, so a reader
+    checks that its window is still valid once it is done with it.
+*/
+class CaptureTap
 {
-    HMIXEROBJ   hmx;
-    int         numInputs;
-    int         numOutputs;
-    ALXctrl    *src;
-    ALXctrl    *srcBoolean;
-    ALXctrl    *dst;
-    ALXctrl    *dstBoolean;
-
-    HWAVEIN     hWaveIn;
-    HWAVEOUT    hWaveOut;
-
-    bool        inputMux;
-    DWORD       muxID;
-    DWORD       speakerID;
-    DWORD       speakerID_boolean;
-    DWORD       waveID;
-    DWORD       waveID_boolean;
-
-    ALXchar    *szDeviceName;
-
-    ALXdevice_struct()
-        : hmx(0), numInputs(0), numOutputs(0),
-          src(0), srcBoolean(0), dst(0), dstBoolean(0),
-          hWaveIn(0), hWaveOut(0), muxID(-1), speakerID(-1),
-          speakerID_boolean(-1), waveID(-1), waveID_boolean(-1),
-          szDeviceName(0), inputMux(false)
+public:
+    CaptureTap(char *frames, LONG size, LONG window, ALXenum format)
+        : _frames(frames), _mask(size - 1), _window(window),
+          _frameSize(frameSize(format)), _format(format), _written(0),
+          _reserved(0)
     {}
 
-    ~ALXdevice_struct() {
-        if (hWaveIn)
-            waveInClose(hWaveIn);
-        if (hWaveOut)
-            waveOutClose(hWaveOut);
-        if (hmx)
-            mixerClose((HMIXER) hmx);
-        delete [] src;
-        delete [] srcBoolean;
-        delete [] dst;
-        delete [] dstBoolean;
-        free(szDeviceName);
+    static int frameSize(ALXenum format) {
+        switch (format) {
+        case AL_FORMAT_MONO8:           return 1;
+        case AL_FORMAT_MONO16:          return 2;
+        case AL_FORMAT_STEREO8:         return 2;
+        case AL_FORMAT_STEREO16:        return 4;
+        case AL_FORMAT_MONO_FLOAT32:    return 4;
+        case AL_FORMAT_STEREO_FLOAT32:  return 8;
+        default:                        return 0;
+        }
     }
 
-    ALXfloat getMasterVolume() {
-        return alx::Control(hmx, speakerID).getVolume();
+    /*
+        Sample type and channels of the 16 bit and float formats
+    */
+    static bool sampleFormat(ALXenum format, ALXenum &type, int &channels) {
+        switch (format) {
+        case AL_FORMAT_MONO16:          type = ALX_SAMPLE_INT16;   channels = 1; return true;
+        case AL_FORMAT_STEREO16:        type = ALX_SAMPLE_INT16;   channels = 2; return true;
+        case AL_FORMAT_MONO_FLOAT32:    type = ALX_SAMPLE_FLOAT32; channels = 1; return true;
+        case AL_FORMAT_STEREO_FLOAT32:  type = ALX_SAMPLE_FLOAT32; channels = 2; return true;
+        default:                        return false;
+        }
     }
 
-    void setMasterVolume(ALXfloat level) {
-        (void) alx::Control(hmx, speakerID).setVolume(level);
+    static size_t bytes(LONG size, LONG window, int frameSize) {
+        return sizeof(CaptureTap) + (size_t) (size + window) * frameSize;
     }
 
-    ALXfloat getPCMOutputVolume() {
-        return alx::Control(hmx, waveID).getVolume();
-    }
+    /*
+        Moves every captured frame into the ring, returning how many.
+        A gate processes them in place before they are published.
+    */
+    ALXint pump(ALCdevice *device, NoiseGate *gate, int rate) {
+        ALCint available = 0;
+        ALXint count = 0;
+        LONG slot, n, mirrored;
+        ULONG position;
+        ALXenum type;
+        int channels;
+
+        if (gate != NULL && !sampleFormat(_format, type, channels))
+            gate = NULL;
+
+        alcGetIntegerv(device, ALC_CAPTURE_SAMPLES, 1, &available);
+
+        while (available > 0) {
+            position = (ULONG) _written;
+            slot = (LONG) (position & _mask);
+            n = _mask + 1 - slot;
+            if (n > available)
+                n = available;
+
+            InterlockedExchange(&_reserved, (LONG) (position + n));
+            alcCaptureSamples(device, _frames + slot * _frameSize, n);
+            if (gate != NULL)
+                gate->process(type, channels, rate, _frames + slot * _frameSize, n);
+
+            if (slot < _window) {
+                mirrored = (slot + n < _window ? slot + n : _window) - slot;
+                memcpy(_frames + (_mask + 1 + slot) * _frameSize,
+                       _frames + slot * _frameSize, mirrored * _frameSize);
+            }
 
-    void setPCMOutputVolume(ALXfloat level) {
-        (void) alx::Control(hmx, waveID).setVolume(level);
+            InterlockedExchange(&_written, (LONG) (position + n));
+            available -= n;
+            count += n;
+        }
+        return count;
     }
 
-    bool hasPCMOutputVolume() {
-        return waveID != -1;
+    ULONG position() const {
+        MemoryBarrier();
+        return (ULONG) _written;
     }
 
-    int getNumOutputVolumes() {
-        return numOutputs;
-    }
+    /*
+        NULL unless frames 'position' to 'position' + 'frames' are all
+        written and not being overwritten
+    */
+    const void *window(ULONG position, LONG frames) const {
+        ULONG written, reserved;
 
-    const char *getOutputVolumeName(int i) {
-        if (i >= 0 && i < numOutputs)
-            return dst[i].name;
-        return NULL;
-    }
+        if (frames <= 0 || frames > _window)
+            return NULL;
 
-    ALXfloat getOutputVolume(int i) {
-        if (i >= 0 && i < numOutputs)
-            return alx::Control(hmx, dst[i].controlID).getVolume();
-        return -1.0;
+        written = (ULONG) _written;
+        reserved = (ULONG) _reserved;
+        MemoryBarrier();
+
+        if ((LONG) (written - position) < frames || (LONG) (reserved - position) > _mask + 1)
+            return NULL;
+        return _frames + (position & _mask) * _frameSize;
     }
 
-    void setOutputVolume(int i, ALXfloat level) {
-        if (i >= 0 && i < numOutputs)
-            (void) alx::Control(hmx, dst[i].controlID).setVolume(level);
+    bool valid(ULONG position) const {
+        MemoryBarrier();
+        return (LONG) ((ULONG) _reserved - position) <= _mask + 1;
     }
 
-    ALXfloat getInputVolume() {
+    ALXenum format() const { return _format; }
+    LONG windowSize() const { return _window; }
+    LONG size() const { return _mask + 1; }
+
+private:
+    char           *_frames;
+    LONG            _mask;
+    LONG            _window;
+    int             _frameSize;
+    ALXenum         _format;
+    volatile LONG   _written;
+    volatile LONG   _reserved;
+};
+
+/*
+    Published state. Each device writes its own slot of the segment, so
+    there is a single writer per slot and a sequence lock is enough:
+    the sequence is odd while the slot is written. A second device of
+    the same name is not published, and closing a device empties its
+    slot for the next one. Publishing again under another name bumps
+    the generation, which detaches the slots of devices opened before.
+*/
+ALXsharedState *Shared = NULL;
+LONG SharedGeneration = 0;
+
+#define ALX_CHANGE_LOG_SIZE_DEFAULT 64
+#define ALX_CHANGE_LOG_SIZE_MAX     65536
+
+/*
+    Last known value of every control of a device. A value read from or
+    written to the driver that differs from the known one is a change:
+    it takes the next generation number, goes to the ring log of
+    changes, and to the device slot of the published state if there is
+    one. Unchanged values cost a compare.
+*/
+class ControlState
+{
+public:
+    ControlState()
+        : _slot(NULL), _sharedGeneration(0), _log(NULL), _logSize(0), _first(1),
+          _generation(0)
+    {
         int i;
 
-        if (hmx) {
-            if (inputMux) {
-                i = getCurrentInputSource();
-                if (i >= 0 && i < numInputs)
-                    return alx::Control(hmx, src[i].controlID).getVolume();
-            }
-            else {
-                return alx::Control(hmx, muxID).getVolume();
-            }
+        memset(&_known, 0, sizeof(_known));
+        _known.masterVolume = _known.pcmVolume = _known.inputVolume = -1.0f;
+        _known.masterMute = _known.pcmMute = -1;
+        _known.inputSource = -1;
+        for (i = 0; i < ALX_SHARED_MAX_LINES; i++) {
+            _known.outputVolume[i] = -1.0f;
+            _known.outputMute[i] = -1;
+            _known.equalizer[i] = -1.0f;
         }
+    }
 
-        return -1.0;
+    ALXsharedDevice *slot() const {
+        return _slot != NULL && _sharedGeneration == SharedGeneration ? _slot : NULL;
     }
 
-    void setInputVolume(ALXfloat level) {
-        int i;
+    bool claim(const ALXchar *name, bool capture, int numOutputs) {
+        ALXsharedDevice *slot;
+        ALXint i, empty = -1;
 
-        if (hmx) {
-            if (inputMux) {
-                i = getCurrentInputSource();
-                if (i >= 0 && i < numInputs)
-                    (void) alx::Control(hmx, src[i].controlID).setVolume(level);
+        if (Shared == NULL)
+            return false;
+
+        for (i = 0; i < Shared->numDevices; i++) {
+            slot = &Shared->devices[i];
+            if (slot->name[0] == '\0') {
+                if (empty < 0)
+                    empty = i;
             }
-            else {
-                (void) alx::Control(hmx, muxID).setVolume(level);
+            else if (slot->capture == (capture ? 1 : 0)
+                && !strncmp(slot->name, name, ALX_SHARED_NAME_SIZE - 1)) {
+                // another open device already writes it
+                return false;
             }
         }
-    }
 
-    ALXboolean isDisabledOutputVolume(int i) {
-        if (i < numOutputs)
-            return alx::Control(hmx, dstBoolean[i].controlID).disabled();
-        return ALX_TRUE;
+        if (empty >= 0)
+            i = empty;
+        if (i == ALX_SHARED_MAX_DEVICES)
+            return false;
+
+        slot = &Shared->devices[i];
+        _known.capture = capture ? 1 : 0;
+        strncpy(_known.name, name, ALX_SHARED_NAME_SIZE - 1);
+        _known.numOutputs = numOutputs < ALX_SHARED_MAX_LINES ? numOutputs : ALX_SHARED_MAX_LINES;
+
+        begin(slot);
+        _known.sequence = slot->sequence;
+        memcpy(slot, &_known, sizeof(ALXsharedDevice));
+        end(slot);
+
+        if (i == Shared->numDevices)
+            InterlockedIncrement((volatile LONG *) &Shared->numDevices);
+
+        _slot = slot;
+        _sharedGeneration = SharedGeneration;
+        return true;
     }
 
-    ALXboolean isDisabledInputVolume(int i) {
-        if (i < numInputs) {
-            if (inputMux) {
-                return i == getCurrentInputSource() ? ALX_FALSE : ALX_TRUE;
-            }
-            else {
-                return alx::Control(hmx, srcBoolean[i].controlID).disabled()
-                    ? ALX_FALSE : ALX_TRUE;
-            }
+    /*
+        Empty the slot, if the device still has one.
+    */
+    void release() {
+        ALXsharedDevice *slot = this->slot();
+
+        if (slot != NULL) {
+            begin(slot);
+            slot->name[0] = '\0';
+            slot->numOutputs = 0;
+            end(slot);
         }
-        return ALX_TRUE;
+        _slot = NULL;
     }
 
-    void disableOutputVolume(int i, ALXboolean flag) {
-        if (i >= 0 && i < numOutputs)
-            (void) alx::Control(hmx, dstBoolean[i].controlID).disable(flag);
+    void setLog(ALXchange *log, ALXint size) {
+        _log = log;
+        _logSize = log != NULL ? size : 0;
+        _first = _generation + 1;
     }
 
-    ALXboolean isDisabledMasterVolume() {
-        return alx::Control(hmx, speakerID_boolean).disabled();
+    ALXint logSize() const {
+        return _logSize;
     }
 
-    void disableMasterVolume(ALXboolean flag) {
-        (void) alx::Control(hmx, speakerID_boolean).disable(flag);
+    ALXint generation() const {
+        return _generation;
     }
 
-    ALXboolean isDisabledPCMOutputVolume() {
-        return alx::Control(hmx, waveID_boolean).disabled();
+    /*
+        Changes after 'generation', oldest first, or -1 when the log no
+        longer holds all of them.
+    */
+    ALXint changesSince(ALXint generation, ALXchange *changes, ALXint count) const {
+        ALXint n = 0;
+
+        if (generation < 0)
+            generation = 0;
+        if (generation >= _generation)
+            return 0;
+        if (_logSize == 0 || generation + 1 < _first || _generation - generation > _logSize)
+            return -1;
+
+        while (++generation <= _generation && n < count)
+            changes[n++] = _log[generation % _logSize];
+        return n;
     }
 
-    void disablePCMOutputVolume(ALXboolean flag) {
-        (void) alx::Control(hmx, waveID_boolean).disable(flag);
+    template<typename T>
+    T track(T ALXsharedDevice::*field, ALXenum param, bool isBoolean, T value) {
+        ALXsharedDevice *slot;
+
+        if (_known.*field != value) {
+            changed(param, -1, isBoolean, (ALXfloat) (_known.*field), (ALXfloat) value);
+            _known.*field = value;
+
+            if ((slot = this->slot()) != NULL) {
+                begin(slot);
+                slot->*field = value;
+                end(slot);
+            }
+        }
+        return value;
     }
 
-    int getNumInputSources() {
-        return numInputs;
+    template<typename T>
+    T track(T (ALXsharedDevice::*field)[ALX_SHARED_MAX_LINES], ALXenum param, bool isBoolean,
+            int index, T value) {
+        ALXsharedDevice *slot;
+
+        if (index >= 0 && index < ALX_SHARED_MAX_LINES && (_known.*field)[index] != value) {
+            changed(param, index, isBoolean, (ALXfloat) (_known.*field)[index], (ALXfloat) value);
+            (_known.*field)[index] = value;
+
+            if ((slot = this->slot()) != NULL) {
+                begin(slot);
+                (slot->*field)[index] = value;
+                end(slot);
+            }
+        }
+        return value;
     }
 
-    const char *getInputSourceName(int i) {
-        if (i >= 0 && i < numInputs)
-            return src[i].name;
-        return NULL;
+private:
+    void changed(ALXenum param, ALXint index, bool isBoolean, ALXfloat oldValue, ALXfloat newValue) {
+        ++_generation;
+        if (_logSize > 0) {
+            ALXchange &change = _log[_generation % _logSize];
+            change.generation = _generation;
+            change.param = param;
+            change.index = index;
+            change.isBoolean = isBoolean ? ALX_TRUE : ALX_FALSE;
+            change.oldValue = oldValue;
+            change.newValue = newValue;
+        }
     }
 
-    int getCurrentInputSource() {
-        int j;
-        int i = 0;
-        MMRESULT res;
-        MIXERCONTROLDETAILS_LISTTEXT *list = 0;
-        MIXERCONTROLDETAILS_BOOLEAN *flags = 0;
+    static void begin(ALXsharedDevice *slot) {
+        InterlockedIncrement((volatile LONG *) &slot->sequence);
+    }
 
-        if (numInputs <= 0)
-            return -1;
+    static void end(ALXsharedDevice *slot) {
+        InterlockedIncrement((volatile LONG *) &slot->sequence);
+    }
 
-        list = new MIXERCONTROLDETAILS_LISTTEXT[numInputs];
-        flags = new MIXERCONTROLDETAILS_BOOLEAN[numInputs];
+    ALXsharedDevice     _known;
+    ALXsharedDevice    *_slot;
+    LONG                _sharedGeneration;
+    ALXchange          *_log;
+    ALXint              _logSize;
+    ALXint              _first;
+    ALXint              _generation;
+};
 
-        res = alx::getControlDetails(hmx, muxID,
-            alx::ListTextDetails(list, numInputs));
 
-        if (res == MMSYSERR_NOERROR) {
+///////////////////////////////////////////////////////
+// Buses
 
-            res = alx::getControlDetails(hmx, muxID,
-                alx::BooleanDetails(flags, numInputs));
+#define ALX_BUS_HASH_SIZE       1024    /* power of two */
+#define ALX_BUS_MAX_CONTEXTS    8
 
-            if (res == MMSYSERR_NOERROR) {
+struct Bus;
 
-                for (j = 0; j < numInputs; j++) {
-                    if (flags[j].fValue) {
-                        i = j;
-                        break;
-                    }
-                }
+/*
+    OpenAL source attached to a bus. Source names are per context, so
+    the context current when it was attached is part of its identity.
+*/
+struct BusSource
+{
+    ALuint          name;
+    ALCcontext     *context;
+    ALfloat         target;
+    ALfloat         applied;        // -1 until the first push
+    bool            queued;
+    Bus            *bus;
+    BusSource      *prev;
+    BusSource      *next;           // in the bus, or in the free list
+    BusSource      *hashNext;
+    BusSource      *queueNext;
+};
 
-                for (j = 0; j < numInputs; j++) {
-                    if (src[j].lineID == list[i].dwParam1) {
-                        i = j;
-                        break;
-                    }
-                }
-            }
-        }
+struct Bus
+{
+    ALXint          id;
+    ALXfloat        gain;
+    ALXboolean      mute;
+    ALfloat         effective;
+    bool            dirty;
+    Bus            *parent;
+    Bus            *children;
+    Bus            *sibling;
+    Bus            *next;           // in the graph, or in the free list
+    BusSource      *sources;
+};
+
+/*
+    Tree of buses rooted at bus 0. The gain of a source is the product
+    of the gains of the buses above it, or zero under a muted one.
+
+    Setting a bus marks it dirty; flush recomputes the effective gains
+    below the topmost dirty buses only, and sets AL_GAIN on the sources
+    whose gain changed, in one suspended batch per context. Nodes come
+    from the device arena and are recycled, so once a graph reaches its
+    size moving faders never allocates.
+*/
+class BusGraph
+{
+public:
+    static BusGraph *create(Arena *arena) {
+        BusGraph *graph;
+        void *block = arena->alloc(sizeof(BusGraph));
+        void *hash = arena->alloc(ALX_BUS_HASH_SIZE * sizeof(BusSource *));
 
-        delete list;
-        delete flags;
+        if (block == NULL || hash == NULL)
+            return NULL;
 
-        return i;
+        graph = new (block) BusGraph(arena, (BusSource **) hash);
+        graph->_root = graph->newBus(NULL);
+        return graph->_root != NULL ? graph : NULL;
     }
 
-    void setCurrentInputSource(int i) {
-        int j;
-        MMRESULT res;
-        MIXERCONTROLDETAILS_LISTTEXT *list = 0;
-        MIXERCONTROLDETAILS_BOOLEAN *flags = 0;
-
-        if (numInputs <= 0)
-            return;
+    Bus *find(ALXint id) const {
+        Bus *bus;
 
-        list = new MIXERCONTROLDETAILS_LISTTEXT[numInputs];
-        flags = new MIXERCONTROLDETAILS_BOOLEAN[numInputs];
+        for (bus = _root; bus != NULL; bus = bus->next) {
+            if (bus->id == id)
+                return bus;
+        }
+        return NULL;
+    }
 
-        res = alx::getControlDetails(hmx, muxID,
-            alx::ListTextDetails(list, numInputs));
+    /*
+        Id of the new bus, or 0 when out of memory.
+    */
+    ALXint add(Bus *parent) {
+        Bus *bus = newBus(parent);
+        return bus != NULL ? bus->id : 0;
+    }
 
-        if (res == MMSYSERR_NOERROR) {
+    /*
+        Children and sources of a removed bus go to its parent.
+    */
+    void remove(Bus *bus) {
+        Bus *parent = bus->parent, **slot;
+        BusSource *source, *next;
+
+        while (bus->children != NULL) {
+            Bus *child = bus->children;
+            bus->children = child->sibling;
+            child->parent = parent;
+            child->sibling = parent->children;
+            parent->children = child;
+        }
 
-            for (j = 0; j < numInputs; j++) {
-                if (list[j].dwParam1 == src[i].lineID)
-                    flags[j].fValue = TRUE;
-                else
-                    flags[j].fValue = FALSE;
-            }
+        for (source = bus->sources; source != NULL; source = next) {
+            next = source->next;
+            link(source, parent);
+        }
+        bus->sources = NULL;
+        parent->dirty = true;
+
+        for (slot = &parent->children; *slot != bus; slot = &(*slot)->sibling)
+            ;
+        *slot = bus->sibling;
+        for (slot = &_root->next; *slot != bus; slot = &(*slot)->next)
+            ;
+        *slot = bus->next;
+
+        bus->next = _freeBuses;
+        _freeBuses = bus;
+    }
 
-            (void) alx::setControlDetails(hmx, muxID,
-                alx::BooleanDetails(flags, numInputs));
+    /*
+        Attaches 'name' of the current context to 'bus', moving it there
+        when it is already on another.
+    */
+    bool attach(Bus *bus, ALuint name) {
+        ALCcontext *context = alcGetCurrentContext();
+        BusSource *source = lookup(name, context);
+
+        if (source == NULL) {
+            if ((source = newSource()) == NULL)
+                return false;
+
+            source->name = name;
+            source->context = context;
+            source->target = 1.0f;
+            source->applied = -1.0f;
+            source->queued = false;
+            source->bus = NULL;
+            source->queueNext = NULL;
+            source->hashNext = _hash[hash(name, context)];
+            _hash[hash(name, context)] = source;
         }
+        else
+            unlink(source);
 
-        delete list;
-        delete flags;
+        link(source, bus);
+        update(source, bus->effective);
+        return true;
     }
-};
 
-namespace alx {
+    /*
+        The source keeps the last gain set on it.
+    */
+    bool detach(ALuint name) {
+        BusSource *source = lookup(name, alcGetCurrentContext());
 
-///////////////////////////////////////////////////////
-// STRING and EXTENSIONS
+        if (source == NULL)
+            return false;
 
-typedef struct ALXextension_struct
-{
-    ALCchar       *extName;
-    ALvoid        *address;
-} ALXextension;
+        if (source->queued)
+            push();
 
-typedef struct ALXfunction_struct
-{
-    ALCchar       *funcName;
-    ALvoid        *address;
-} ALXfunction;
+        forget(source);
+        return true;
+    }
 
-static ALXextension Extensions[] = {
-    { NULL,                           (ALvoid *) NULL                     } };
+    void setGain(Bus *bus, ALXfloat gain) {
+        if (bus->gain != gain) {
+            bus->gain = gain;
+            bus->dirty = true;
+        }
+    }
 
-static ALXfunction  Functions[] = {
-    { "alxOpenDevice",                (ALvoid *) alxOpenDevice            },
-    { "alxOpenCaptureDevice",         (ALvoid *) alxOpenCaptureDevice     },
-    { "alxMapDevice",                 (ALvoid *) alxMapDevice             },
-    { "alxMapCaptureDevice",          (ALvoid *) alxMapCaptureDevice      },
-    { "alxCloseDevice",               (ALvoid *) alxCloseDevice           },
-    { "alxGetFloat",                  (ALvoid *) alxGetFloat              },
-    { "alxSetFloat",                  (ALvoid *) alxSetFloat              },
-    { "alxGetBoolean",                (ALvoid *) alxGetBoolean            },
-    { "alxSetBoolean",                (ALvoid *) alxSetBoolean            },
-    { "alxGetString",                 (ALvoid *) alxGetString             },
-    { "alxGetInteger",                (ALvoid *) alxGetInteger            },
-    { "alxSetInteger",                (ALvoid *) alxSetInteger            },
-    { "alxGetIndexedString",          (ALvoid *) alxGetIndexedString      },
-    { "alxGetIndexedFloat",           (ALvoid *) alxGetIndexedFloat       },
-    { "alxGetIndexedBoolean",         (ALvoid *) alxGetIndexedBoolean     },
-    { "alxSetIndexedFloat",           (ALvoid *) alxSetIndexedFloat       },
-    { "alxSetIndexedBoolean",         (ALvoid *) alxSetIndexedBoolean     },
-    { "alxGetError",                  (ALvoid *) alxGetError              },
-    { NULL,                           (ALvoid *) NULL                     } };
+    void setMute(Bus *bus, ALXboolean flag) {
+        if (bus->mute != flag) {
+            bus->mute = flag;
+            bus->dirty = true;
+        }
+    }
 
-///////////////////////////////////////////////////////
-// Global Variables
+    void flush() {
+        Bus *bus, *top, *up;
 
-// Mixer Error
-ALXenum LastError = ALX_NO_ERROR;
+        for (bus = _root; bus != NULL; bus = bus->next) {
+            if (!bus->dirty)
+                continue;
 
-// Device strings
-ALXchar DeviceList[2048] = { 0 };
-ALXchar CaptureDeviceList[2048] = { 0 };
+            // a dirty ancestor recomputes this bus on its way down
+            for (top = bus, up = bus->parent; up != NULL; up = up->parent) {
+                if (up->dirty)
+                    top = up;
+            }
+            walk(top);
+        }
+        push();
+    }
 
-ALXint MajorVersion = 1;
-ALXint MinorVersion = 1;
+private:
+    BusGraph(Arena *arena, BusSource **hash)
+        : _arena(arena), _root(NULL), _freeBuses(NULL), _freeSources(NULL),
+          _hash(hash), _nextId(0), _numPending(0)
+    {
+        memset(_hash, 0, ALX_BUS_HASH_SIZE * sizeof(BusSource *));
+    }
 
-///////////////////////////////////////////////////////
+    struct Pending
+    {
+        ALCcontext     *context;
+        BusSource      *head;
+    };
 
-ALXboolean match_device_name(const char *name1, const char *name2)
-{
-    int name1len, name2len, prefix;
-    struct {
-        const char *s;
-        int len;
-    } g, l;
+    static unsigned hash(ALuint name, ALCcontext *context) {
+        return (unsigned) ((name * 2654435761u) ^ ((size_t) context >> 4)) & (ALX_BUS_HASH_SIZE - 1);
+    }
 
-    name1len = strlen(name1);
-    name2len = strlen(name2);
-    prefix = name1len - name2len;
+    BusSource *lookup(ALuint name, ALCcontext *context) const {
+        BusSource *source;
 
-    if (prefix >= 0) {
-        g.s = name1;
-        g.len = name1len;
-        l.s = name2;
-        l.len = name2len;
-    }
-    else {
-        g.s = name2;
-        g.len = name2len;
-        l.s = name1;
-        l.len = name1len;
-        prefix = -prefix;
+        for (source = _hash[hash(name, context)]; source != NULL; source = source->hashNext) {
+            if (source->name == name && source->context == context)
+                return source;
+        }
+        return NULL;
     }
 
-    while (prefix >= 0) {
-        if (!strncmp(g.s + prefix, l.s, l.len))
-            return ALX_TRUE;
-        --prefix;
+    Bus *newBus(Bus *parent) {
+        Bus *bus = _freeBuses;
+
+        if (bus != NULL)
+            _freeBuses = bus->next;
+        else if ((bus = (Bus *) _arena->alloc(sizeof(Bus))) == NULL)
+            return NULL;
+
+        bus->id = _nextId++;
+        bus->gain = 1.0f;
+        bus->mute = ALX_FALSE;
+        bus->effective = parent != NULL ? parent->effective : 1.0f;
+        bus->dirty = false;
+        bus->parent = parent;
+        bus->children = NULL;
+        bus->sibling = NULL;
+        bus->next = NULL;
+        bus->sources = NULL;
+
+        if (parent != NULL) {
+            bus->sibling = parent->children;
+            parent->children = bus;
+            bus->next = _root->next;
+            _root->next = bus;
+        }
+        return bus;
     }
 
-    return ALX_FALSE;
-}
+    BusSource *newSource() {
+        BusSource *source = _freeSources;
 
-/*
-    alx::setError
+        if (source != NULL)
+            _freeSources = source->next;
+        else
+            source = (BusSource *) _arena->alloc(sizeof(BusSource));
+        return source;
+    }
 
-    Store latest ALC Error
-*/
-void setError(ALXenum errorCode)
-{
-    LastError = errorCode;
-}
+    static void link(BusSource *source, Bus *bus) {
+        source->bus = bus;
+        source->prev = NULL;
+        source->next = bus->sources;
+        if (bus->sources != NULL)
+            bus->sources->prev = source;
+        bus->sources = source;
+    }
 
-} // namespace alx
+    static void unlink(BusSource *source) {
+        if (source->prev != NULL)
+            source->prev->next = source->next;
+        else
+            source->bus->sources = source->next;
+        if (source->next != NULL)
+            source->next->prev = source->prev;
+        source->bus = NULL;
+    }
 
-///////////////////////////////////////////////////////
+    /*
+        Take a source that is not queued out of the graph.
+    */
+    void forget(BusSource *source) {
+        BusSource **slot;
 
+        for (slot = &_hash[hash(source->name, source->context)]; *slot != source; slot = &(*slot)->hashNext)
+            ;
+        *slot = source->hashNext;
 
-///////////////////////////////////////////////////////
-// ALMix Functions calls
+        unlink(source);
+        source->next = _freeSources;
+        _freeSources = source;
+    }
 
-#define ALXAPI
-#define ALXAPIENTRY
+    void walk(Bus *bus) {
+        BusSource *source;
+        Bus *child;
 
-extern "C" {
+        bus->dirty = false;
+        bus->effective = (bus->parent != NULL ? bus->parent->effective : 1.0f)
+                       * (bus->mute ? 0.0f : bus->gain);
 
-ALXAPI ALXdevice * ALXAPIENTRY alxOpenDevice(const ALXchar *devicename)
-{
-    HMIXER hmx = NULL;
-    ALXdevice *pMixer = NULL;
-    UINT i, numDevs;
-    HWAVEOUT hWaveOut = NULL;
-    WAVEFORMATEX OutputType;
-    MMRESULT mmres;
-    const ALCchar *mixerDevice;
+        for (source = bus->sources; source != NULL; source = source->next)
+            update(source, bus->effective);
+        for (child = bus->children; child != NULL; child = child->sibling)
+            walk(child);
+    }
 
-    memset(&OutputType,0,sizeof(WAVEFORMATEX));
-    OutputType.wFormatTag=WAVE_FORMAT_PCM;
-    OutputType.nChannels=1;
-    OutputType.wBitsPerSample=16;
-    OutputType.nBlockAlign=OutputType.nChannels*OutputType.wBitsPerSample/8;
-    OutputType.nSamplesPerSec=8000;
-    OutputType.nAvgBytesPerSec=OutputType.nSamplesPerSec*OutputType.nBlockAlign;
-    OutputType.cbSize=0;
+    void update(BusSource *source, ALfloat gain) {
+        int i;
 
-    if ((devicename)) {
-        mixerDevice = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+        source->target = gain;
+        if (source->queued || gain == source->applied)
+            return;
 
-        i = 0;
-        while (*mixerDevice) {
-            if (!strcmp(devicename, mixerDevice))
+        for (i = 0; i < _numPending; i++) {
+            if (_pending[i].context == source->context)
                 break;
-            mixerDevice += strlen(mixerDevice) + 1;
-            ++i;
+        }
+        if (i == ALX_BUS_MAX_CONTEXTS) {
+            push();
+            i = 0;
+        }
+        if (i == _numPending) {
+            _pending[i].context = source->context;
+            _pending[i].head = NULL;
+            _numPending++;
         }
 
-        if (*mixerDevice) {
-            numDevs = waveOutGetNumDevs();
-            if (i < numDevs) {
-                waveOutOpen(&hWaveOut, i, &OutputType, 0, 0, CALLBACK_NULL);
-                mmres = mixerOpen((LPHMIXER)&hmx,(UINT)hWaveOut,0,0,MIXER_OBJECTF_HWAVEOUT);
-            }
+        source->queued = true;
+        source->queueNext = _pending[i].head;
+        _pending[i].head = source;
+    }
 
-            if (mmres==MMSYSERR_NOERROR) {
-                pMixer = new ALXdevice;
-                if ((pMixer))
-                {
-                    pMixer->hmx = reinterpret_cast<HMIXEROBJ&>(hmx);
-                    pMixer->hWaveOut = hWaveOut;
-                    pMixer->szDeviceName = strdup(mixerDevice);
-
-                    pMixer->speakerID = alx::findControl(pMixer->hmx,
-                        alx::ComponentType(alx::DstSpeakers),
-                        alx::ComponentType(alx::DstHeadphones),
-                        alx::ControlType(alx::Volume));
-                    if (pMixer->speakerID != -1) {
-                        pMixer->speakerID_boolean = alx::findControl(pMixer->hmx,
-                            alx::ComponentType(alx::DstSpeakers),
-                            alx::ComponentType(alx::DstHeadphones),
-                            alx::ControlType(alx::Mute));
-                    }
-                    pMixer->numOutputs = alx::getControls(pMixer->hmx,
-                        alx::ComponentType(alx::DstSpeakers),
-                        alx::ComponentType(alx::DstHeadphones),
-                        alx::ControlType(alx::Volume),
-                        &pMixer->dst);
-                    if (pMixer->numOutputs > 0) {
-                        (void) alx::getControls(pMixer->hmx,
-                            alx::ComponentType(alx::DstSpeakers),
-                            alx::ComponentType(alx::DstHeadphones),
-                            alx::ControlType(alx::Mute),
-                            &pMixer->dstBoolean);
-                    }
-                    pMixer->waveID = alx::findControl(pMixer->hmx,
-                        alx::ComponentType(alx::SrcWaveOut),
-                        alx::ControlType(alx::Volume));
-                    if (pMixer->waveID != -1) {
-                        pMixer->waveID_boolean = alx::findControl(pMixer->hmx,
-                            alx::ComponentType(alx::SrcWaveOut),
-                            alx::ControlType(alx::Mute));
-                    }
-                }
-                else {
-                    mixerClose(hmx);
-                    alx::setError(ALX_OUT_OF_MEMORY);
+    void push() {
+        ALCcontext *current = alcGetCurrentContext(), *context;
+        BusSource *source, *next;
+        int i;
+
+        for (i = 0; i < _numPending; i++) {
+            context = _pending[i].context;
+            if (alcGetCurrentContext() != context)
+                alcMakeContextCurrent(context);
+
+            alcSuspendContext(context);
+            for (source = _pending[i].head; source != NULL; source = next) {
+                next = source->queueNext;
+                source->queueNext = NULL;
+                source->queued = false;
+                // sources deleted by the application leave the graph
+                if (!alIsSource(source->name))
+                    forget(source);
+                else if (source->target != source->applied) {
+                    alSourcef(source->name, AL_GAIN, source->target);
+                    source->applied = source->target;
                 }
             }
-            else {
-                alx::setError(ALX_INVALID_DEVICE);
-            }
-        }
-        else {
-            alx::setError(ALX_INVALID_DEVICE);
+            alcProcessContext(context);
         }
-    }
-    else {
-        alx::setError(ALX_INVALID_DEVICE);
+        _numPending = 0;
+
+        if (alcGetCurrentContext() != current)
+            alcMakeContextCurrent(current);
     }
 
-    return pMixer;
-}
+    Arena      *_arena;
+    Bus        *_root;
+    Bus        *_freeBuses;
+    BusSource  *_freeSources;
+    BusSource **_hash;
+    ALXint      _nextId;
+    Pending     _pending[ALX_BUS_MAX_CONTEXTS];
+    int         _numPending;
+};
 
+} // namespace alx
 
-ALXAPI ALXdevice * ALXAPIENTRY alxOpenCaptureDevice(const ALXchar *devicename)
+//////////////////////////////////////////////////////////////////////////////
+
+// Window class of the notification windows
+#define ALX_NOTIFY_CLASS        "ALxNotify"
+
+struct ALXdevice_struct
 {
-    HMIXER hmx = NULL;
-    ALXdevice *pMixer = NULL;
-    UINT i, numDevs;
-    HWAVEIN hWaveIn = NULL;
-    WAVEFORMATEX InputType;
-    MMRESULT mmres;
-    const ALCchar *mixerDevice;
+    HMIXEROBJ   hmx;
+    int         numInputs;
+    int         numOutputs;
+    ALXlines   *src;
+    ALXlines   *dst;
 
-    memset(&InputType,0,sizeof(WAVEFORMATEX));
-    InputType.wFormatTag=WAVE_FORMAT_PCM;
-    InputType.nChannels=1;
-    InputType.wBitsPerSample=16;
-    InputType.nBlockAlign=InputType.nChannels*InputType.wBitsPerSample/8;
-    InputType.nSamplesPerSec=8000;
-    InputType.nAvgBytesPerSec=InputType.nSamplesPerSec*InputType.nBlockAlign;
-    InputType.cbSize=0;
+    HWAVEIN     hWaveIn;
+    HWAVEOUT    hWaveOut;
 
-    if ((devicename)) {
-        mixerDevice = alxGetString(NULL, ALX_CAPTURE_DEVICE_SPECIFIER);
+    bool        inputMux;
+    DWORD       muxID;
+    DWORD       muxItems;
+    DWORD       peakID;
+    DWORD       inputMuteID;
+    MIXERCONTROLDETAILS_BOOLEAN *muxFlags;
+    int        *muxSource;
+    int        *sourceItem;
+    DWORD       speakerID;
+    DWORD       speakerID_boolean;
+    DWORD       waveID;
+    DWORD       waveID_boolean;
+    DWORD       bassID;
+    DWORD       trebleID;
+    DWORD       equalizerID;
 
-        i = 0;
-        while (*mixerDevice) {
-            if (!strcmp(devicename, mixerDevice))
-                break;
-            mixerDevice += strlen(mixerDevice) + 1;
-            ++i;
+    ALXchar    *szDeviceName;
+
+    alx::CommandQueue *queue;
+    void       *queueBlock;
+    LONG        queueSlots;
+
+    alx::Arena *arena;
+
+    alx::ControlState state;
+    ALXchange  *changeLog;
+    ALXint      changeLogSlots;
+    alx::ControlTable controlInfo;
+
+    HWND        notifyWindow;
+    HMIXER      notifyMixer;
+
+    ALCdevice  *alcDevice;
+    ALXenum     backend;
+    ALXfloat    listenerGain;
+    ALXboolean  listenerMute;
+    ALCcontext *listenerContext;
+    ALfloat     listenerApplied;
+    int         batch;
+
+    alx::BusGraph *buses;
+
+    ALCdevice  *alcCaptureDevice;
+    alx::CaptureTap *tap;
+    void       *tapBlock;
+    size_t      tapBytes;
+    ALCint      tapRate;
+    ALXducker  *ducker;
+
+    alx::ToneFilter * volatile tone;
+
+    alx::NoiseGate * volatile gate;
+    volatile bool gateMuted;
+    // raised by the pump for the control thread to mute or unmute
+    volatile alx::QueueIndex gateDue;
+
+    /*
+        The device is the first thing allocated from its own arena.
+    */
+    static ALXdevice_struct *create() {
+        alx::Arena *arena = alx::Arena::create();
+        if (arena == NULL)
+            return NULL;
+        return new (arena->alloc(sizeof(ALXdevice_struct))) ALXdevice_struct(arena);
+    }
+
+    static void destroy(ALXdevice_struct *device) {
+        alx::Arena *arena;
+
+        if (device == NULL)
+            return;
+
+        arena = device->arena;
+        device->~ALXdevice_struct();
+        alx::Arena::destroy(arena);
+    }
+
+    ALXdevice_struct(alx::Arena *arena_)
+        : hmx(0), numInputs(0), numOutputs(0),
+          src(0), dst(0),
+          hWaveIn(0), hWaveOut(0), muxID(-1), muxItems(0), peakID(-1),
+          inputMuteID(-1), muxFlags(0), muxSource(0), sourceItem(0), speakerID(-1),
+          speakerID_boolean(-1), waveID(-1), waveID_boolean(-1),
+          bassID(-1), trebleID(-1), equalizerID(-1),
+          szDeviceName(0), inputMux(false), queue(0), queueBlock(0),
+          queueSlots(0), arena(arena_), changeLog(0), changeLogSlots(0),
+          notifyWindow(0), notifyMixer(0),
+          alcDevice(0), backend(ALX_BACKEND_DRIVER), listenerGain(1.0f),
+          listenerMute(ALX_FALSE), listenerContext(0), listenerApplied(1.0f),
+          batch(0), buses(0), alcCaptureDevice(0), tap(0), tapBlock(0),
+          tapBytes(0), tapRate(0), ducker(0), tone(0), gate(0), gateMuted(false),
+          gateDue(0)
+    {}
+
+    ~ALXdevice_struct() {
+        state.release();
+        if (ducker)
+            alx::linkDucker(ducker, NULL);
+        if (backend == ALX_BACKEND_OPENAL)
+            resetListenerGain();
+        if (gateMuted)
+            (void) control(inputMuteID).disable(ALX_FALSE);
+        if (notifyMixer)
+            alx::driver->close(notifyMixer);
+        if (notifyWindow)
+            DestroyWindow(notifyWindow);
+        if (hWaveIn)
+            waveInClose(hWaveIn);
+        if (hWaveOut)
+            waveOutClose(hWaveOut);
+        if (hmx)
+            alx::driver->close((HMIXER) hmx);
+    }
+
+    void discoverOutputs() {
+        alx::Span span("discoverOutputs");
+
+        {
+            alx::Span step("findControl speaker");
+            speakerID = alx::findControl(hmx,
+                alx::ComponentType(alx::DstSpeakers),
+                alx::ComponentType(alx::DstHeadphones),
+                alx::ControlType(alx::Volume));
+        }
+        if (speakerID != -1) {
+            alx::Span step("findControl speaker mute");
+            speakerID_boolean = alx::findControl(hmx,
+                alx::ComponentType(alx::DstSpeakers),
+                alx::ComponentType(alx::DstHeadphones),
+                alx::ControlType(alx::Mute));
+        }
+        {
+            alx::Span step("getControls dst");
+            dst = alx::getControls(arena, hmx,
+                alx::ComponentType(alx::DstSpeakers),
+                alx::ComponentType(alx::DstHeadphones));
+            if (dst != NULL)
+                numOutputs = dst->count;
+        }
+        {
+            alx::Span step("findControl wave");
+            waveID = alx::findControl(hmx,
+                alx::ComponentType(alx::SrcWaveOut),
+                alx::ControlType(alx::Volume));
         }
+        if (waveID != -1) {
+            alx::Span step("findControl wave mute");
+            waveID_boolean = alx::findControl(hmx,
+                alx::ComponentType(alx::SrcWaveOut),
+                alx::ControlType(alx::Mute));
+        }
+        {
+            alx::Span step("findControl tone");
+            bassID = alx::findControl(hmx,
+                alx::ComponentType(alx::DstSpeakers),
+                alx::ComponentType(alx::DstHeadphones),
+                alx::ControlType(alx::Bass));
+            trebleID = alx::findControl(hmx,
+                alx::ComponentType(alx::DstSpeakers),
+                alx::ComponentType(alx::DstHeadphones),
+                alx::ControlType(alx::Treble));
+            equalizerID = alx::findControl(hmx,
+                alx::ComponentType(alx::DstSpeakers),
+                alx::ComponentType(alx::DstHeadphones),
+                alx::ControlType(alx::Equalizer));
+        }
+    }
 
-        if (*mixerDevice) {
-            numDevs = waveInGetNumDevs();
-            if (i < numDevs) {
-                waveInOpen(&hWaveIn, i, &InputType, 0, 0, CALLBACK_NULL);
-                mmres = mixerOpen((LPHMIXER)&hmx,(UINT)hWaveIn,0,0,MIXER_OBJECTF_HWAVEIN);
+    void discoverInputs() {
+        alx::Span span("discoverInputs");
+        UINT i;
+        struct {
+            alx::ComponentType_Type component;
+            alx::ControlType_Type   control;
+        } tries[] = {
+            { alx::DstWaveIn, alx::Mux   },
+            { alx::DstWaveIn, alx::Mixer },
+        };
+
+        for (i = 0; i < sizeof(tries) / sizeof(tries[0]); ++i) {
+            alx::Span step("findControl mux");
+            muxID = alx::findControl(hmx,
+                alx::ComponentType(tries[i].component),
+                alx::ControlType(tries[i].control));
+            if (muxID != -1) {
+                inputMux = true;
+                break;
             }
+        }
 
-            if (mmres==MMSYSERR_NOERROR) {
-                pMixer = new ALXdevice;
-                if ((pMixer))
-                {
-                    pMixer->hmx = reinterpret_cast<HMIXEROBJ&>(hmx);
-                    pMixer->hWaveIn = hWaveIn;
-                    pMixer->szDeviceName = strdup(mixerDevice);
-
-                    struct {
-                        alx::ComponentType_Type component;
-                        alx::ControlType_Type   control;
-                    } tries[] = {
-                        { alx::DstWaveIn, alx::Mux   },
-                        { alx::DstWaveIn, alx::Mixer },
-                    };
-
-                    for (i = 0; i < sizeof(tries) / sizeof(tries[0]); ++i) {
-                        pMixer->muxID = alx::findControl(pMixer->hmx,
-                            alx::ComponentType(tries[i].component),
-                            alx::ControlType(tries[i].control));
-                        if (pMixer->muxID != -1) {
-                            pMixer->inputMux = true;
-                            break;
-                        }
-                    }
+        if (muxID == -1) {
+            alx::Span step("findControl input volume");
+            inputMux = false;
+            muxID = alx::findControl(hmx,
+                alx::ComponentType(alx::DstWaveIn),
+                alx::ControlType(alx::Volume));
+        }
 
-                    if (pMixer->muxID == -1) {
-                        pMixer->inputMux = false;
-                        pMixer->muxID = alx::findControl(pMixer->hmx,
-                            alx::ComponentType(alx::DstWaveIn),
-                            alx::ControlType(alx::Volume));
-                    }
+        {
+            alx::Span step("findControl input peak meter");
+            peakID = alx::findControl(hmx,
+                alx::ComponentType(alx::DstWaveIn),
+                alx::ControlType(alx::PeakMeter));
+        }
 
-                    pMixer->numInputs = alx::getControls(pMixer->hmx,
-                        alx::ComponentType(alx::DstWaveIn),
-                        alx::ControlType(alx::Volume),
-                        &pMixer->src);
-                    if (pMixer->numInputs > 0) {
-                        (void) alx::getControls(pMixer->hmx,
-                            alx::ComponentType(alx::DstWaveIn),
-                            alx::ControlType(alx::Mute),
-                            &pMixer->srcBoolean);
-                    }
-                }
-                else {
-                    mixerClose(hmx);
-                    alx::setError(ALX_OUT_OF_MEMORY);
-                }
+        {
+            alx::Span step("findControl input mute");
+            inputMuteID = alx::findControl(hmx,
+                alx::ComponentType(alx::DstWaveIn),
+                alx::ControlType(alx::Mute));
+        }
+
+        {
+            alx::Span step("getControls src");
+            src = alx::getControls(arena, hmx,
+                alx::ComponentType(alx::DstWaveIn));
+            if (src != NULL)
+                numInputs = src->count;
+        }
+    }
+
+    /*
+        (Re)create the command queue. Must not be called while another
+        thread may push commands. The slots are reused when they are
+        large enough; a larger queue takes new slots from the arena.
+    */
+    bool setQueueSize(ALXint size) {
+        ALXenum policy = queue ? queue->policy() : ALX_QUEUE_DROP_NEWEST;
+        LONG capacity;
+
+        queue = NULL;
+
+        if (size <= 0)
+            return true;
+
+        capacity = alx::CommandQueue::roundCapacity(size);
+        if (capacity > queueSlots) {
+            queueBlock = arena->alloc(sizeof(alx::CommandQueue) + capacity * sizeof(alx::Command));
+            if (queueBlock == NULL) {
+                queueSlots = 0;
+                return false;
             }
-            else {
-                alx::setError(ALX_INVALID_DEVICE);
+            queueSlots = capacity;
+        }
+
+        queue = new (queueBlock) alx::CommandQueue(reinterpret_cast<alx::Command *>(
+            (char *) queueBlock + sizeof(alx::CommandQueue)), capacity);
+        queue->setPolicy(policy);
+        return true;
+    }
+
+    /*
+        (Re)create the capture tap, of at least 'frames' frames. Must not
+        be called while another thread pumps or reads it. Like the queue
+        slots, the ring is reused when it is large enough.
+    */
+    bool setCaptureTap(ALXenum format, ALXint frames, ALXint window) {
+        int frameSize = alx::CaptureTap::frameSize(format);
+        LONG size;
+        size_t bytes;
+
+        tap = NULL;
+
+        if (frames <= 0)
+            return true;
+
+        size = alx::CommandQueue::roundCapacity(frames);
+        bytes = alx::CaptureTap::bytes(size, window, frameSize);
+        if (bytes > tapBytes) {
+            tapBlock = arena->alloc(bytes);
+            if (tapBlock == NULL) {
+                tapBytes = 0;
+                return false;
             }
+            tapBytes = bytes;
         }
-        else {
-            alx::setError(ALX_INVALID_DEVICE);
+
+        tap = new (tapBlock) alx::CaptureTap((char *) tapBlock + sizeof(alx::CaptureTap),
+            size, window, format);
+
+        // the gate's time constants need it
+        tapRate = 0;
+        alcGetIntegerv(alcCaptureDevice, ALC_FREQUENCY, 1, &tapRate);
+        if (tapRate <= 0)
+            tapRate = 44100;
+        return true;
+    }
+
+    /*
+        Moves the captured frames into the tap through the gate, then
+        gives them to the ducker a window at a time, skipping those the
+        pump itself overwrote. Frames captured while the gate keeps the
+        line muted are silent, so it is left out. Muting calls the
+        driver, so the pump only asks the control thread to see to it.
+    */
+    ALXint pumpCaptureTap() {
+        ULONG position = tap->position();
+        ALXint count = tap->pump(alcCaptureDevice, gateMuted ? NULL : gate, tapRate), left, n;
+        ALXenum type;
+        int channels;
+
+        if (gate != NULL && (gateMuted || gate->active()))
+            alx::publish(&gateDue, 1);
+
+        if (ducker == NULL || !alx::CaptureTap::sampleFormat(tap->format(), type, channels))
+            return count;
+
+        left = count;
+        if (left > tap->size()) {
+            position += left - tap->size();
+            left = tap->size();
         }
+
+        for (; left > 0; left -= n, position += n) {
+            n = left < tap->windowSize() ? left : tap->windowSize();
+            alxProcessDucker(ducker, type, channels, tap->window(position, n), n);
+        }
+        return count;
+    }
+
+    /*
+        Noise gate of the capture tap, made when a parameter is first set.
+    */
+    alx::NoiseGate *noiseGate() {
+        void *block;
+
+        if (gate == NULL && (block = arena->alloc(sizeof(alx::NoiseGate))) != NULL)
+            gate = new (block) alx::NoiseGate;
+        return gate;
+    }
+
+    /*
+        Once the gate stayed shut for its mute delay, the recording line
+        is muted and the peak meter, which the driver keeps running,
+        tells when to unmute it. Devices without both are only gated.
+        A line someone else muted is left alone. Runs on the control
+        thread, from alxProcessQueue; the gate is reopened before the
+        pump sees the line unmuted.
+    */
+    void muteGate() {
+        ALXfloat delay = gate->get(alx::NoiseGate::MuteDelay), peak;
+        ALXboolean muted;
+        bool wanted;
+
+        if (inputMuteID == -1 || peakID == -1)
+            return;
+
+        if (gateMuted) {
+            wanted = gate->active() && delay > 0.0f
+                && getInputLevel(ALX_LEVEL_PEAK, peak) == MMSYSERR_NOERROR
+                && 20.0 * log10(peak + 1e-10) <= gate->get(alx::NoiseGate::Threshold);
+            if (!wanted && control(inputMuteID).disable(ALX_FALSE) == MMSYSERR_NOERROR) {
+                gate->reopen();
+                alx::fullBarrier();
+                gateMuted = false;
+            }
+        }
+        else if (gate->active() && delay > 0.0f && gate->silence() >= delay) {
+            if (control(inputMuteID).getDisabled(muted) == MMSYSERR_NOERROR && !muted
+                && control(inputMuteID).disable(ALX_TRUE) == MMSYSERR_NOERROR)
+                gateMuted = true;
+        }
+    }
+
+    MMRESULT getGate(int param, ALXfloat &value) {
+        if (hWaveIn == NULL && alcCaptureDevice == NULL)
+            return MMSYSERR_NOTSUPPORTED;
+        value = gate ? gate->get(param) : alx::NoiseGate::initial(param);
+        return MMSYSERR_NOERROR;
+    }
+
+    MMRESULT setGate(int param, ALXfloat value) {
+        if (hWaveIn == NULL && alcCaptureDevice == NULL)
+            return MMSYSERR_NOTSUPPORTED;
+        if (noiseGate() == NULL)
+            return MMSYSERR_NOMEM;
+        return gate->set(param, value) ? MMSYSERR_NOERROR : MMSYSERR_INVALPARAM;
+    }
+
+    /*
+        ALX_LEVEL_PEAK or ALX_LEVEL_RMS of the recording line. Meters
+        change all the time, so their values are not kept.
+    */
+    MMRESULT getInputLevel(ALXint what, ALXfloat &level) {
+        ALXlevel levels[2];
+        ALXenum type;
+        const void *frames;
+        ULONG position;
+        DWORD raw;
+        MMRESULT res;
+        int channels, i;
+
+        if (what == ALX_LEVEL_PEAK && peakID != -1) {
+            res = alx::Control(hmx, peakID).getRaw(raw);
+            if (res == MMSYSERR_NOERROR) {
+                level = abs((LONG) raw) / 32768.0f;
+                if (level > 1.0f)
+                    level = 1.0f;
+            }
+            return res;
+        }
+
+        if (tap == NULL || !alx::CaptureTap::sampleFormat(tap->format(), type, channels))
+            return MMSYSERR_NOTSUPPORTED;
+
+        position = tap->position() - tap->windowSize();
+        frames = tap->window(position, tap->windowSize());
+        level = 0.0f;
+        if (frames == NULL)
+            return MMSYSERR_NOERROR;
+
+        memset(levels, 0, sizeof(levels));
+        alxMeasureLevels(type, channels, frames, tap->windowSize(), what, levels);
+        if (!tap->valid(position))
+            return MMSYSERR_NOERROR;
+
+        for (i = 0; i < channels; i++) {
+            ALXfloat value = what == ALX_LEVEL_PEAK ? levels[i].peak : levels[i].rms;
+            if (value > level)
+                level = value;
+        }
+        return MMSYSERR_NOERROR;
+    }
+
+    /*
+        Restart the change log with room for 'size' changes, at most
+        ALX_CHANGE_LOG_SIZE_MAX. Like the queue slots, the log is reused
+        when it is large enough.
+    */
+    bool setChangeLogSize(ALXint size) {
+        if (size <= 0) {
+            state.setLog(NULL, 0);
+            return true;
+        }
+
+        if (size > changeLogSlots) {
+            changeLog = (ALXchange *) arena->alloc(size * sizeof(ALXchange));
+            if (changeLog == NULL) {
+                changeLogSlots = 0;
+                state.setLog(NULL, 0);
+                return false;
+            }
+            changeLogSlots = size;
+        }
+
+        state.setLog(changeLog, size);
+        return true;
+    }
+
+    /*
+        Room for the speaker, wave, tone and input controls, and the
+        volume and mute of every line.
+    */
+    void mapControls() {
+        (void) controlInfo.create(arena, 9 + 2 * (numInputs + numOutputs));
+    }
+
+    alx::Control control(DWORD id) {
+        return alx::Control(hmx, id, controlInfo.find(hmx, id), controlInfo.watched());
+    }
+
+    /*
+        Start the change log and, when publishing, claim a slot in the
+        published state and read every value into it.
+    */
+    void trackState() {
+        (void) setChangeLogSize(ALX_CHANGE_LOG_SIZE_DEFAULT);
+
+        if (state.claim(szDeviceName, hWaveIn != NULL, numOutputs))
+            readAll();
+    }
+
+    /*
+        Read every value of the device, which logs and publishes those
+        that changed.
+    */
+    void readAll() {
+        int i;
+
+        if (hWaveIn != NULL) {
+            (void) getInputVolume();
+            (void) getCurrentInputSource();
+            return;
+        }
+
+        (void) getMasterVolume();
+        (void) isDisabledMasterVolume();
+        if (hasPCMOutputVolume()) {
+            (void) getPCMOutputVolume();
+            (void) isDisabledPCMOutputVolume();
+        }
+        for (i = 0; i < numOutputs; i++) {
+            (void) getOutputVolume(i);
+            (void) isDisabledOutputVolume(i);
+        }
+    }
+
+    /*
+        The OpenAL backend sets the listener gain of the current
+        context, when it is one of the mapped device's. OpenAL cannot
+        list the contexts of a device, so the gain follows the
+        application to the others as they are made current and ALx is
+        called. Changes made between beginBatch and endBatch are applied
+        once, at the end.
+    */
+    void applyListenerGain() {
+        ALCcontext *context;
+        ALfloat gain = listenerMute ? 0.0f : listenerGain;
+
+        if (backend != ALX_BACKEND_OPENAL || batch > 0)
+            return;
+
+        context = alcGetCurrentContext();
+        if (context == NULL || alcGetContextsDevice(context) != alcDevice)
+            return;
+        if (context == listenerContext && gain == listenerApplied)
+            return;
+
+        alcSuspendContext(context);
+        alListenerf(AL_GAIN, gain);
+        alcProcessContext(context);
+
+        listenerContext = context;
+        listenerApplied = gain;
+    }
+
+    /*
+        Give the listener of the context last written its full gain back,
+        so leaving the OpenAL backend, or closing the device while on it,
+        does not leave it attenuated. The context is made current for
+        that when it is not, then restored; a context destroyed since
+        fails to become current and is skipped.
+    */
+    void resetListenerGain() {
+        ALCcontext *current;
+
+        if (listenerContext == NULL || listenerApplied == 1.0f)
+            return;
+
+        current = alcGetCurrentContext();
+        if (current == listenerContext || alcMakeContextCurrent(listenerContext)) {
+            alcSuspendContext(listenerContext);
+            alListenerf(AL_GAIN, 1.0f);
+            alcProcessContext(listenerContext);
+            if (current != listenerContext)
+                alcMakeContextCurrent(current);
+        }
+
+        listenerContext = NULL;
+        listenerApplied = 1.0f;
+    }
+
+    void beginBatch() {
+        ++batch;
+    }
+
+    void endBatch() {
+        if (--batch == 0) {
+            applyListenerGain();
+            flushBuses();
+        }
+    }
+
+    /*
+        Software tone filter, made when a level is first set.
+    */
+    alx::ToneFilter *toneFilter() {
+        void *block;
+
+        if (tone == NULL && (block = arena->alloc(sizeof(alx::ToneFilter))) != NULL)
+            tone = new (block) alx::ToneFilter;
+        return tone;
+    }
+
+    /*
+        Bass and treble use the controls of the speakers when the
+        driver has them, and the software filter otherwise.
+    */
+    MMRESULT getTone(int stage, ALXfloat &level) {
+        DWORD id = stage == alx::ToneFilter::Bass ? bassID : trebleID;
+
+        if (id != -1)
+            return control(id).getVolume(level);
+        level = tone ? tone->level(stage) : 0.5f;
+        return MMSYSERR_NOERROR;
+    }
+
+    MMRESULT setTone(int stage, ALXfloat level) {
+        DWORD id = stage == alx::ToneFilter::Bass ? bassID : trebleID;
+
+        if (level < 0.0f || level > 1.0f)
+            return MMSYSERR_INVALPARAM;
+        if (id != -1)
+            return control(id).setVolume(level);
+        if (toneFilter() == NULL)
+            return MMSYSERR_NOMEM;
+        tone->setLevel(stage, level);
+        return MMSYSERR_NOERROR;
+    }
+
+    int getNumEqualizerBands() {
+        alx::ControlInfo *info;
+
+        if (equalizerID == -1)
+            return ALX_TONE_BANDS;
+        info = controlInfo.find(hmx, equalizerID);
+        if (info == NULL)
+            return 0;
+        return info->items < ALX_MAX_EQUALIZER_BANDS ? (int) info->items : ALX_MAX_EQUALIZER_BANDS;
+    }
+
+    /*
+        Every band of the driver's equalizer, which is a fader with one
+        item per band
+    */
+    MMRESULT equalizerDetails(MIXERCONTROLDETAILS_UNSIGNED *values, int count, bool set) {
+        MIXERCONTROLDETAILS details;
+
+        memset(&details, 0, sizeof(details));
+        details.cbStruct = sizeof(MIXERCONTROLDETAILS);
+        details.dwControlID = equalizerID;
+        details.cChannels = 1;
+        details.cMultipleItems = count;
+        details.cbDetails = sizeof(MIXERCONTROLDETAILS_UNSIGNED);
+        details.paDetails = values;
+
+        if (set) {
+            alx::Span span("setControlDetails", equalizerID);
+            return alx::driver->setControlDetails(hmx, &details,
+                MIXER_OBJECTF_HMIXER|MIXER_SETCONTROLDETAILSF_VALUE);
+        }
+        return alx::driver->getControlDetails(hmx, &details,
+            MIXER_OBJECTF_HMIXER|MIXER_GETCONTROLDETAILSF_VALUE);
+    }
+
+    MMRESULT getEqualizer(int band, ALXfloat &level) {
+        MIXERCONTROLDETAILS_UNSIGNED values[ALX_MAX_EQUALIZER_BANDS];
+        int count = getNumEqualizerBands();
+        MMRESULT res;
+
+        if (band < 0 || band >= count)
+            return MMSYSERR_INVALPARAM;
+
+        if (equalizerID == -1) {
+            level = tone ? tone->level(alx::ToneFilter::FirstBand + band) : 0.5f;
+            return MMSYSERR_NOERROR;
+        }
+
+        res = equalizerDetails(values, count, false);
+        if (res == MMSYSERR_NOERROR) {
+            level = controlInfo.find(hmx, equalizerID)->fromRaw(values[band].dwValue);
+            state.track(&ALXsharedDevice::equalizer, ALX_EQUALIZER, false, band, level);
+        }
+        return res;
+    }
+
+    MMRESULT setEqualizer(int band, ALXfloat level) {
+        MIXERCONTROLDETAILS_UNSIGNED values[ALX_MAX_EQUALIZER_BANDS];
+        int count = getNumEqualizerBands();
+        MMRESULT res;
+
+        if (band < 0 || band >= count || level < 0.0f || level > 1.0f)
+            return MMSYSERR_INVALPARAM;
+
+        if (equalizerID == -1) {
+            if (toneFilter() == NULL)
+                return MMSYSERR_NOMEM;
+            tone->setLevel(alx::ToneFilter::FirstBand + band, level);
+            return MMSYSERR_NOERROR;
+        }
+
+        res = equalizerDetails(values, count, false);
+        if (res == MMSYSERR_NOERROR) {
+            values[band].dwValue = controlInfo.find(hmx, equalizerID)->toRaw(level);
+            res = equalizerDetails(values, count, true);
+        }
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::equalizer, ALX_EQUALIZER, false, band, level);
+        return res;
+    }
+
+    ALXint getToneHardware() const {
+        return (bassID != -1 ? ALX_TONE_BASS : 0) | (trebleID != -1 ? ALX_TONE_TREBLE : 0)
+            | (equalizerID != -1 ? ALX_TONE_EQUALIZER : 0);
+    }
+
+    /*
+        Bus graph of the device, made on first use.
+    */
+    alx::BusGraph *busGraph() {
+        if (buses == NULL)
+            buses = alx::BusGraph::create(arena);
+        return buses;
+    }
+
+    void flushBuses() {
+        if (buses != NULL && batch == 0)
+            buses->flush();
+    }
+
+    /*
+        NULL when 'id' is no bus. Only 'create' makes the graph, so gets
+        on a device that never used buses stay free.
+    */
+    alx::Bus *findBus(ALXint id, bool create = false) {
+        alx::BusGraph *graph = create ? busGraph() : buses;
+        return graph != NULL ? graph->find(id) : NULL;
+    }
+
+    bool setBackend(ALXenum value) {
+        if (value == ALX_BACKEND_OPENAL && alcDevice == NULL)
+            return false;
+        if (value == ALX_BACKEND_DRIVER && hmx == 0)
+            return false;
+
+        if (backend == ALX_BACKEND_OPENAL && value != ALX_BACKEND_OPENAL)
+            resetListenerGain();
+
+        backend = value;
+        listenerContext = NULL;
+        applyListenerGain();
+        return true;
+    }
+
+    MMRESULT getMasterVolume(ALXfloat &level) {
+        if (backend == ALX_BACKEND_OPENAL) {
+            applyListenerGain();
+            level = listenerGain;
+            state.track(&ALXsharedDevice::masterVolume, ALX_MASTER_VOLUME, false, level);
+            return MMSYSERR_NOERROR;
+        }
+
+        MMRESULT res = control(speakerID).getVolume(level);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::masterVolume, ALX_MASTER_VOLUME, false, level);
+        return res;
+    }
+
+    ALXfloat getMasterVolume() {
+        ALXfloat level = -1.0;
+        getMasterVolume(level);
+        return level;
+    }
+
+    MMRESULT setMasterVolume(ALXfloat level) {
+        if (backend == ALX_BACKEND_OPENAL) {
+            if (level < 0.0f || level > 1.0f)
+                return MMSYSERR_INVALPARAM;
+            listenerGain = level;
+            applyListenerGain();
+            state.track(&ALXsharedDevice::masterVolume, ALX_MASTER_VOLUME, false, level);
+            return MMSYSERR_NOERROR;
+        }
+
+        MMRESULT res = control(speakerID).setVolume(level);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::masterVolume, ALX_MASTER_VOLUME, false, level);
+        return res;
+    }
+
+    MMRESULT getPCMOutputVolume(ALXfloat &level) {
+        MMRESULT res = control(waveID).getVolume(level);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::pcmVolume, ALX_PCM_OUTPUT_VOLUME, false, level);
+        return res;
+    }
+
+    ALXfloat getPCMOutputVolume() {
+        ALXfloat level = -1.0;
+        getPCMOutputVolume(level);
+        return level;
+    }
+
+    MMRESULT setPCMOutputVolume(ALXfloat level) {
+        MMRESULT res = control(waveID).setVolume(level);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::pcmVolume, ALX_PCM_OUTPUT_VOLUME, false, level);
+        return res;
+    }
+
+    bool hasPCMOutputVolume() {
+        return waveID != -1;
+    }
+
+    int getNumOutputVolumes() {
+        return numOutputs;
+    }
+
+    const char *getOutputVolumeName(int i) {
+        if (i >= 0 && i < numOutputs)
+            return dst->name(i);
+        return NULL;
+    }
+
+    MMRESULT getOutputVolume(int i, ALXfloat &level) {
+        MMRESULT res;
+
+        if (i < 0 || i >= numOutputs)
+            return MMSYSERR_INVALPARAM;
+
+        res = control(dst->controls[i].volumeID).getVolume(level);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::outputVolume, ALX_OUTPUT_VOLUME, false, i, level);
+        return res;
+    }
+
+    ALXfloat getOutputVolume(int i) {
+        ALXfloat level = -1.0;
+        getOutputVolume(i, level);
+        return level;
+    }
+
+    MMRESULT setOutputVolume(int i, ALXfloat level) {
+        MMRESULT res;
+
+        if (i < 0 || i >= numOutputs)
+            return MMSYSERR_INVALPARAM;
+
+        res = control(dst->controls[i].volumeID).setVolume(level);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::outputVolume, ALX_OUTPUT_VOLUME, false, i, level);
+        return res;
+    }
+
+    MMRESULT getInputVolume(ALXfloat &level) {
+        MMRESULT res = MMSYSERR_INVALPARAM;
+        int i;
+
+        if (hmx) {
+            if (inputMux) {
+                i = getCurrentInputSource();
+                if (i >= 0 && i < numInputs)
+                    res = control(src->controls[i].volumeID).getVolume(level);
+            }
+            else {
+                res = control(muxID).getVolume(level);
+            }
+        }
+
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::inputVolume, ALX_INPUT_VOLUME, false, level);
+        return res;
+    }
+
+    ALXfloat getInputVolume() {
+        ALXfloat level = -1.0;
+        getInputVolume(level);
+        return level;
+    }
+
+    MMRESULT setInputVolume(ALXfloat level) {
+        MMRESULT res = MMSYSERR_INVALPARAM;
+        int i;
+
+        if (hmx) {
+            if (inputMux) {
+                i = getCurrentInputSource();
+                if (i >= 0 && i < numInputs)
+                    res = control(src->controls[i].volumeID).setVolume(level);
+            }
+            else {
+                res = control(muxID).setVolume(level);
+            }
+        }
+
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::inputVolume, ALX_INPUT_VOLUME, false, level);
+        return res;
+    }
+
+    MMRESULT isDisabledOutputVolume(int i, ALXboolean &flag) {
+        MMRESULT res;
+
+        if (i < 0 || i >= numOutputs)
+            return MMSYSERR_INVALPARAM;
+
+        res = control(dst->controls[i].muteID).getDisabled(flag);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::outputMute, ALX_OUTPUT_VOLUME, true, i, (ALXint) flag);
+        return res;
+    }
+
+    ALXboolean isDisabledOutputVolume(int i) {
+        ALXboolean flag = ALX_TRUE;
+        isDisabledOutputVolume(i, flag);
+        return flag;
+    }
+
+    ALXboolean isDisabledInputVolume(int i) {
+        if (i < numInputs) {
+            if (inputMux) {
+                return i == getCurrentInputSource() ? ALX_FALSE : ALX_TRUE;
+            }
+            else {
+                return control(src->controls[i].muteID).disabled()
+                    ? ALX_FALSE : ALX_TRUE;
+            }
+        }
+        return ALX_TRUE;
+    }
+
+    MMRESULT disableOutputVolume(int i, ALXboolean flag) {
+        MMRESULT res;
+
+        if (i < 0 || i >= numOutputs)
+            return MMSYSERR_INVALPARAM;
+
+        res = control(dst->controls[i].muteID).disable(flag);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::outputMute, ALX_OUTPUT_VOLUME, true, i,
+                (ALXint) (flag ? 1 : 0));
+        return res;
+    }
+
+    MMRESULT isDisabledMasterVolume(ALXboolean &flag) {
+        if (backend == ALX_BACKEND_OPENAL) {
+            applyListenerGain();
+            flag = listenerMute;
+            state.track(&ALXsharedDevice::masterMute, ALX_MASTER_VOLUME, true, (ALXint) flag);
+            return MMSYSERR_NOERROR;
+        }
+
+        MMRESULT res = control(speakerID_boolean).getDisabled(flag);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::masterMute, ALX_MASTER_VOLUME, true, (ALXint) flag);
+        return res;
+    }
+
+    ALXboolean isDisabledMasterVolume() {
+        ALXboolean flag = ALX_TRUE;
+        isDisabledMasterVolume(flag);
+        return flag;
+    }
+
+    MMRESULT disableMasterVolume(ALXboolean flag) {
+        if (backend == ALX_BACKEND_OPENAL) {
+            listenerMute = flag ? ALX_TRUE : ALX_FALSE;
+            applyListenerGain();
+            state.track(&ALXsharedDevice::masterMute, ALX_MASTER_VOLUME, true,
+                (ALXint) listenerMute);
+            return MMSYSERR_NOERROR;
+        }
+
+        MMRESULT res = control(speakerID_boolean).disable(flag);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::masterMute, ALX_MASTER_VOLUME, true,
+                (ALXint) (flag ? 1 : 0));
+        return res;
+    }
+
+    MMRESULT isDisabledPCMOutputVolume(ALXboolean &flag) {
+        MMRESULT res = control(waveID_boolean).getDisabled(flag);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::pcmMute, ALX_PCM_OUTPUT_VOLUME, true, (ALXint) flag);
+        return res;
+    }
+
+    ALXboolean isDisabledPCMOutputVolume() {
+        ALXboolean flag = ALX_TRUE;
+        isDisabledPCMOutputVolume(flag);
+        return flag;
+    }
+
+    MMRESULT disablePCMOutputVolume(ALXboolean flag) {
+        MMRESULT res = control(waveID_boolean).disable(flag);
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::pcmMute, ALX_PCM_OUTPUT_VOLUME, true,
+                (ALXint) (flag ? 1 : 0));
+        return res;
+    }
+
+    /*
+        Volume control behind 'param', or -1.
+    */
+    DWORD volumeID(ALXenum param, int index) {
+        int i;
+
+        switch (param) {
+        case ALX_MASTER_VOLUME:
+            // the listener gain has no raw value
+            return backend == ALX_BACKEND_OPENAL ? -1 : speakerID;
+
+        case ALX_PCM_OUTPUT_VOLUME:
+            return waveID;
+
+        case ALX_OUTPUT_VOLUME:
+            if (index >= 0 && index < numOutputs)
+                return dst->controls[index].volumeID;
+            return -1;
+
+        case ALX_INPUT_VOLUME:
+            if (!inputMux)
+                return muxID;
+            i = getCurrentInputSource();
+            if (i >= 0 && i < numInputs)
+                return src->controls[i].volumeID;
+            return -1;
+
+        default:
+            return -1;
+        }
+    }
+
+    void trackVolume(ALXenum param, int index, ALXfloat level) {
+        switch (param) {
+        case ALX_MASTER_VOLUME:
+            state.track(&ALXsharedDevice::masterVolume, param, false, level);
+            break;
+        case ALX_PCM_OUTPUT_VOLUME:
+            state.track(&ALXsharedDevice::pcmVolume, param, false, level);
+            break;
+        case ALX_OUTPUT_VOLUME:
+            state.track(&ALXsharedDevice::outputVolume, param, false, index, level);
+            break;
+        case ALX_INPUT_VOLUME:
+            state.track(&ALXsharedDevice::inputVolume, param, false, level);
+            break;
+        }
+    }
+
+    MMRESULT getRawVolume(ALXenum param, int index, DWORD &raw) {
+        DWORD id = volumeID(param, index);
+        MMRESULT res;
+
+        if (hmx == 0 || id == (DWORD) -1)
+            return MMSYSERR_INVALPARAM;
+
+        alx::Control c = control(id);
+        res = c.getRaw(raw);
+        if (res == MMSYSERR_NOERROR)
+            trackVolume(param, index, c.range().fromRaw(raw));
+        return res;
+    }
+
+    MMRESULT setRawVolume(ALXenum param, int index, DWORD raw) {
+        DWORD id = volumeID(param, index);
+        MMRESULT res;
+
+        if (hmx == 0 || id == (DWORD) -1)
+            return MMSYSERR_INVALPARAM;
+
+        alx::Control c = control(id);
+        res = c.setRaw(raw);
+        if (res == MMSYSERR_NOERROR)
+            trackVolume(param, index, c.range().fromRaw(raw));
+        return res;
+    }
+
+    MMRESULT getVolumeRange(ALXenum param, int index, DWORD &minimum, DWORD &maximum,
+                            DWORD &step) {
+        DWORD id = volumeID(param, index);
+
+        if (hmx == 0 || id == (DWORD) -1)
+            return MMSYSERR_INVALPARAM;
+
+        alx::Control c = control(id);
+        const alx::ControlInfo &range = c.range();
+        minimum = range.minimum;
+        maximum = range.maximum;
+        step = range.stepSize();
+        return MMSYSERR_NOERROR;
+    }
+
+    int getNumInputSources() {
+        return numInputs;
+    }
+
+    const char *getInputSourceName(int i) {
+        if (i >= 0 && i < numInputs)
+            return src->name(i);
+        return NULL;
+    }
+
+    /*
+        Bytes of the block holding the mux values, the source line of
+        each of 'items' mux items and the mux item of each source line
+    */
+    size_t inputMuxSize(DWORD items) const {
+        return items * (sizeof(MIXERCONTROLDETAILS_BOOLEAN) + sizeof(int)) + numInputs * sizeof(int);
+    }
+
+    /*
+        Lay the mux out in 'block', with no item linked to a source line
+        yet.
+    */
+    void setInputMux(char *block, DWORD items) {
+        DWORD j;
+        int i;
+
+        muxItems = items;
+        muxFlags = reinterpret_cast<MIXERCONTROLDETAILS_BOOLEAN *>(block);
+        muxSource = reinterpret_cast<int *>(muxFlags + muxItems);
+        sourceItem = muxSource + muxItems;
+
+        for (i = 0; i < numInputs; i++)
+            sourceItem[i] = -1;
+        for (j = 0; j < muxItems; j++)
+            muxSource[j] = -1;
+    }
+
+    void linkInputMux(DWORD item, int source) {
+        muxSource[item] = source;
+        if (source >= 0)
+            sourceItem[source] = (int) item;
+    }
+
+    /*
+        Read the items of the input mux once, so that switching sources
+        later is a single set call on a preallocated value array. The
+        item texts follow the mux in the block, and are only read here.
+        A mux the topology cache laid out already is left alone.
+    */
+    void mapInputMux() {
+        alx::Span span("mapInputMux");
+        MIXERCONTROL control;
+        MIXERCONTROLDETAILS_LISTTEXT *list;
+        MMRESULT res;
+        DWORD j;
+        int i;
+
+        if (!inputMux || numInputs <= 0 || muxFlags != NULL)
+            return;
+
+        res = alx::getLineControl(hmx, 0, alx::ControlID(muxID), control);
+        if (res != MMSYSERR_NOERROR)
+            return;
+
+        if (control.cMultipleItems == 0)
+            return;
+
+        size_t size = inputMuxSize(control.cMultipleItems);
+        char *block = (char *) arena->alloc(
+            size + control.cMultipleItems * sizeof(MIXERCONTROLDETAILS_LISTTEXT));
+        if (block == NULL)
+            return;
+        list = reinterpret_cast<MIXERCONTROLDETAILS_LISTTEXT *>(block + size);
+
+        res = alx::getControlDetails(hmx, muxID,
+            alx::ListTextDetails(list, control.cMultipleItems));
+        if (res != MMSYSERR_NOERROR)
+            return;
+
+        setInputMux(block, control.cMultipleItems);
+        for (j = 0; j < muxItems; j++) {
+            for (i = 0; i < numInputs; i++) {
+                if (src->lineID[i] == list[j].dwParam1) {
+                    linkInputMux(j, i);
+                    break;
+                }
+            }
+        }
+    }
+
+    int getCurrentInputSource() {
+        DWORD j;
+        MMRESULT res;
+
+        if (muxFlags == NULL)
+            return -1;
+
+        res = alx::getControlDetails(hmx, muxID,
+            alx::BooleanDetails(muxFlags, muxItems));
+        if (res != MMSYSERR_NOERROR)
+            return -1;
+
+        for (j = 0; j < muxItems; j++) {
+            if (muxFlags[j].fValue)
+                return state.track(&ALXsharedDevice::inputSource, ALX_INPUT_SOURCE, false,
+                    muxSource[j]);
+        }
+
+        return -1;
+    }
+
+    MMRESULT setCurrentInputSource(int i) {
+        DWORD j;
+
+        if (muxFlags == NULL || i < 0 || i >= numInputs || sourceItem[i] < 0)
+            return MMSYSERR_INVALPARAM;
+
+        for (j = 0; j < muxItems; j++)
+            muxFlags[j].fValue = (j == (DWORD) sourceItem[i]) ? TRUE : FALSE;
+
+        MMRESULT res = alx::setControlDetails(hmx, muxID,
+            alx::BooleanDetails(muxFlags, muxItems));
+        if (res == MMSYSERR_NOERROR)
+            state.track(&ALXsharedDevice::inputSource, ALX_INPUT_SOURCE, false, i);
+        return res;
+    }
+
+    /*
+        Switch to source 'i' with the given volume. The volume is set
+        before the switch, so the source is never heard at its old level,
+        and set back when the switch fails.
+    */
+    MMRESULT selectInputSource(int i, ALXfloat level) {
+        DWORD previous;
+        MMRESULT res;
+
+        if (muxFlags == NULL || i < 0 || i >= numInputs || sourceItem[i] < 0)
+            return MMSYSERR_INVALPARAM;
+
+        alx::Control volume = control(src->controls[i].volumeID);
+        res = volume.getRaw(previous);
+        if (res == MMSYSERR_NOERROR)
+            res = volume.setVolume(level);
+        if (res != MMSYSERR_NOERROR)
+            return res;
+
+        res = setCurrentInputSource(i);
+        if (res != MMSYSERR_NOERROR) {
+            (void) volume.setRaw(previous);
+            return res;
+        }
+
+        state.track(&ALXsharedDevice::inputVolume, ALX_INPUT_VOLUME, false, level);
+        return res;
+    }
+
+    /*
+        The driver posts its notifications to a message-only window of
+        the calling thread, through a second handle to the mixer, so
+        they only come once asked for and are handled wherever that
+        thread dispatches its messages.
+    */
+    bool startNotifications() {
+        WNDCLASSEX wc;
+        HMIXER hNotify;
+
+        if (notifyWindow)
+            return true;
+
+        // fails harmlessly when already registered
+        memset(&wc, 0, sizeof(wc));
+        wc.cbSize = sizeof(wc);
+        wc.lpfnWndProc = notifyProc;
+        wc.hInstance = GetModuleHandle(NULL);
+        wc.lpszClassName = ALX_NOTIFY_CLASS;
+        RegisterClassEx(&wc);
+
+        notifyWindow = CreateWindowEx(0, ALX_NOTIFY_CLASS, NULL, 0, 0, 0, 0, 0,
+            HWND_MESSAGE, NULL, GetModuleHandle(NULL), NULL);
+        if (notifyWindow == NULL)
+            return false;
+        SetWindowLongPtr(notifyWindow, GWLP_USERDATA, (LONG_PTR) this);
+
+        if (alx::driver->open(&hNotify, (UINT) (UINT_PTR) hmx, (DWORD_PTR) notifyWindow, 0,
+                MIXER_OBJECTF_HMIXER|CALLBACK_WINDOW) != MMSYSERR_NOERROR) {
+            DestroyWindow(notifyWindow);
+            notifyWindow = NULL;
+            return false;
+        }
+
+        notifyMixer = hNotify;
+        controlInfo.watch();
+        return true;
+    }
+
+    int processEvents() {
+        MSG msg;
+        int count = 0;
+
+        if (notifyWindow == NULL)
+            return 0;
+
+        while (PeekMessage(&msg, notifyWindow, MM_MIXM_LINE_CHANGE, MM_MIXM_CONTROL_CHANGE,
+                PM_REMOVE)) {
+            DispatchMessage(&msg);
+            ++count;
+        }
+
+        return count;
+    }
+
+    /*
+        Read the values behind a control that someone changed.
+    */
+    void controlChanged(DWORD id) {
+        int i;
+
+        controlInfo.forget(id);
+
+        if (id == speakerID) {
+            (void) getMasterVolume();
+        }
+        else if (id == speakerID_boolean) {
+            (void) isDisabledMasterVolume();
+        }
+        else if (id == waveID) {
+            (void) getPCMOutputVolume();
+        }
+        else if (id == waveID_boolean) {
+            (void) isDisabledPCMOutputVolume();
+        }
+        else if (id == muxID) {
+            // a new source brings its own volume
+            if (inputMux)
+                (void) getCurrentInputSource();
+            (void) getInputVolume();
+        }
+        else {
+            for (i = 0; i < numOutputs; i++) {
+                if (dst->controls[i].volumeID == id)
+                    (void) getOutputVolume(i);
+                else if (dst->controls[i].muteID == id)
+                    (void) isDisabledOutputVolume(i);
+            }
+            for (i = 0; i < numInputs; i++) {
+                if (src->controls[i].volumeID == id)
+                    (void) getInputVolume();
+            }
+        }
+    }
+
+    static LRESULT CALLBACK notifyProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+        ALXdevice_struct *device;
+
+        device = (ALXdevice_struct *) GetWindowLongPtr(hWnd, GWLP_USERDATA);
+        if (device) {
+            switch (uMsg) {
+            case MM_MIXM_CONTROL_CHANGE:
+                device->controlChanged((DWORD) lParam);
+                return 0;
+
+            case MM_MIXM_LINE_CHANGE:
+                // lines come and go with jacks; read everything again
+                device->controlInfo.invalidate();
+                device->readAll();
+                return 0;
+            }
+        }
+
+        return DefWindowProc(hWnd, uMsg, wParam, lParam);
+    }
+};
+
+namespace alx {
+
+///////////////////////////////////////////////////////
+// STRING and EXTENSIONS
+
+typedef struct ALXextension_struct
+{
+    ALCchar       *extName;
+    ALvoid        *address;
+} ALXextension;
+
+typedef struct ALXfunction_struct
+{
+    ALCchar       *funcName;
+    ALvoid        *address;
+} ALXfunction;
+
+static ALXextension Extensions[] = {
+    { NULL,                           (ALvoid *) NULL                     } };
+
+static ALXfunction  Functions[] = {
+    { "alxOpenDevice",                (ALvoid *) alxOpenDevice            },
+    { "alxOpenCaptureDevice",         (ALvoid *) alxOpenCaptureDevice     },
+    { "alxMapDevice",                 (ALvoid *) alxMapDevice             },
+    { "alxMapCaptureDevice",          (ALvoid *) alxMapCaptureDevice      },
+    { "alxCloseDevice",               (ALvoid *) alxCloseDevice           },
+    { "alxGetFloat",                  (ALvoid *) alxGetFloat              },
+    { "alxSetFloat",                  (ALvoid *) alxSetFloat              },
+    { "alxGetBoolean",                (ALvoid *) alxGetBoolean            },
+    { "alxSetBoolean",                (ALvoid *) alxSetBoolean            },
+    { "alxGetString",                 (ALvoid *) alxGetString             },
+    { "alxGetInteger",                (ALvoid *) alxGetInteger            },
+    { "alxSetInteger",                (ALvoid *) alxSetInteger            },
+    { "alxGetIndexedString",          (ALvoid *) alxGetIndexedString      },
+    { "alxGetIndexedFloat",           (ALvoid *) alxGetIndexedFloat       },
+    { "alxGetIndexedBoolean",         (ALvoid *) alxGetIndexedBoolean     },
+    { "alxSetIndexedFloat",           (ALvoid *) alxSetIndexedFloat       },
+    { "alxSetIndexedBoolean",         (ALvoid *) alxSetIndexedBoolean     },
+    { "alxGetError",                  (ALvoid *) alxGetError              },
+    { "alxSetTopologyCache",          (ALvoid *) alxSetTopologyCache      },
+    { "alxQueueFloat",                (ALvoid *) alxQueueFloat            },
+    { "alxQueueBoolean",              (ALvoid *) alxQueueBoolean          },
+    { "alxProcessQueue",              (ALvoid *) alxProcessQueue          },
+    { "alxGetPollDescriptors",        (ALvoid *) alxGetPollDescriptors    },
+    { "alxProcessEvents",             (ALvoid *) alxProcessEvents         },
+    { "alxGenBus",                    (ALvoid *) alxGenBus                },
+    { "alxDeleteBus",                 (ALvoid *) alxDeleteBus             },
+    { "alxAttachSource",              (ALvoid *) alxAttachSource          },
+    { "alxDetachSource",              (ALvoid *) alxDetachSource          },
+    { "alxSetCaptureTap",             (ALvoid *) alxSetCaptureTap         },
+    { "alxPumpCaptureTap",            (ALvoid *) alxPumpCaptureTap        },
+    { "alxGetCapturePosition",        (ALvoid *) alxGetCapturePosition    },
+    { "alxGetCaptureWindow",          (ALvoid *) alxGetCaptureWindow      },
+    { "alxIsCaptureWindowValid",      (ALvoid *) alxIsCaptureWindowValid  },
+    { "alxMeasureLevels",             (ALvoid *) alxMeasureLevels         },
+    { "alxCreateLoudnessMeter",       (ALvoid *) alxCreateLoudnessMeter   },
+    { "alxDeleteLoudnessMeter",       (ALvoid *) alxDeleteLoudnessMeter   },
+    { "alxResetLoudnessMeter",        (ALvoid *) alxResetLoudnessMeter    },
+    { "alxAddLoudnessSamples",        (ALvoid *) alxAddLoudnessSamples    },
+    { "alxGetLoudness",               (ALvoid *) alxGetLoudness           },
+    { "alxSetLoudnessTarget",         (ALvoid *) alxSetLoudnessTarget     },
+    { "alxCreateDucker",              (ALvoid *) alxCreateDucker          },
+    { "alxDeleteDucker",              (ALvoid *) alxDeleteDucker          },
+    { "alxAddDuckTarget",             (ALvoid *) alxAddDuckTarget         },
+    { "alxRemoveDuckTargets",         (ALvoid *) alxRemoveDuckTargets     },
+    { "alxGetDuckerFloat",            (ALvoid *) alxGetDuckerFloat        },
+    { "alxSetDuckerFloat",            (ALvoid *) alxSetDuckerFloat        },
+    { "alxProcessDucker",             (ALvoid *) alxProcessDucker         },
+    { "alxSetCaptureDucker",          (ALvoid *) alxSetCaptureDucker      },
+    { "alxProcessTone",               (ALvoid *) alxProcessTone           },
+    { "alxCreateEnvelope",            (ALvoid *) alxCreateEnvelope        },
+    { "alxDeleteEnvelope",            (ALvoid *) alxDeleteEnvelope        },
+    { "alxAddEnvelopePoint",          (ALvoid *) alxAddEnvelopePoint      },
+    { "alxClearEnvelope",             (ALvoid *) alxClearEnvelope         },
+    { "alxGetEnvelopeGain",           (ALvoid *) alxGetEnvelopeGain       },
+    { "alxProcessEnvelope",           (ALvoid *) alxProcessEnvelope       },
+    { "alxSetEnvelopeTarget",         (ALvoid *) alxSetEnvelopeTarget     },
+    { "alxAdvanceEnvelope",           (ALvoid *) alxAdvanceEnvelope       },
+    { "alxSetAllocator",              (ALvoid *) alxSetAllocator          },
+    { "alxGetChangesSince",           (ALvoid *) alxGetChangesSince       },
+    { "alxPublishSharedState",        (ALvoid *) alxPublishSharedState    },
+    { "alxAttachSharedState",         (ALvoid *) alxAttachSharedState     },
+    { "alxReadSharedDevice",          (ALvoid *) alxReadSharedDevice      },
+    { "alxDetachSharedState",         (ALvoid *) alxDetachSharedState     },
+    { "alxStartTrace",                (ALvoid *) alxStartTrace            },
+    { "alxStopTrace",                 (ALvoid *) alxStopTrace             },
+    { "alxStartEventTrace",           (ALvoid *) alxStartEventTrace       },
+    { "alxStopEventTrace",            (ALvoid *) alxStopEventTrace        },
+    { "alxGetMasterVolume",           (ALvoid *) alxGetMasterVolume       },
+    { "alxSetMasterVolume",           (ALvoid *) alxSetMasterVolume       },
+    { "alxGetMasterMute",             (ALvoid *) alxGetMasterMute         },
+    { "alxSetMasterMute",             (ALvoid *) alxSetMasterMute         },
+    { "alxGetPCMOutputVolume",        (ALvoid *) alxGetPCMOutputVolume    },
+    { "alxSetPCMOutputVolume",        (ALvoid *) alxSetPCMOutputVolume    },
+    { "alxGetPCMOutputMute",          (ALvoid *) alxGetPCMOutputMute      },
+    { "alxSetPCMOutputMute",          (ALvoid *) alxSetPCMOutputMute      },
+    { "alxGetInputVolume",            (ALvoid *) alxGetInputVolume        },
+    { "alxSetInputVolume",            (ALvoid *) alxSetInputVolume        },
+    { "alxGetInputSource",            (ALvoid *) alxGetInputSource        },
+    { "alxSetInputSource",            (ALvoid *) alxSetInputSource        },
+    { "alxGetOutputVolume",           (ALvoid *) alxGetOutputVolume       },
+    { "alxSetOutputVolume",           (ALvoid *) alxSetOutputVolume       },
+    { "alxGetOutputMute",             (ALvoid *) alxGetOutputMute         },
+    { "alxSetOutputMute",             (ALvoid *) alxSetOutputMute         },
+    { "alxGetOutputCount",            (ALvoid *) alxGetOutputCount        },
+    { "alxGetOutputName",             (ALvoid *) alxGetOutputName         },
+    { "alxGetInputSourceCount",       (ALvoid *) alxGetInputSourceCount   },
+    { "alxGetInputSourceName",        (ALvoid *) alxGetInputSourceName    },
+    { "alxGetIntegerv",               (ALvoid *) alxGetIntegerv           },
+    { "alxSetIntegerv",               (ALvoid *) alxSetIntegerv           },
+    { NULL,                           (ALvoid *) NULL                     } };
+
+///////////////////////////////////////////////////////
+// Global Variables
+
+// Mixer Error
+ALXenum LastError = ALX_NO_ERROR;
+
+// Device strings
+ALXchar DeviceList[2048] = { 0 };
+ALXchar CaptureDeviceList[2048] = { 0 };
+
+ALXint MajorVersion = 1;
+ALXint MinorVersion = 1;
+
+///////////////////////////////////////////////////////
+
+/*
+    alx::setError
+
+    Store latest ALC Error
+*/
+void setError(ALXenum errorCode)
+{
+    LastError = errorCode;
+}
+
+/*
+    alx::status
+
+    ALX status of a driver call, for the typed entry points
+*/
+ALXenum status(MMRESULT res)
+{
+    switch (res) {
+    case MMSYSERR_NOERROR:      return ALX_NO_ERROR;
+    case MMSYSERR_INVALPARAM:   return ALX_INVALID_VALUE;
+    default:                    return ALX_INVALID_OPERATION;
+    }
+}
+
+///////////////////////////////////////////////////////
+// Topology cache
+//
+// Discovering the lines and controls of a mixer takes dozens of driver
+// calls. When a cache file is set with alxSetTopologyCache, what was
+// discovered is stored in it, keyed by device name plus a fingerprint
+// of the mixer driver, replacing what the device had there before, and
+// later opens of the same device map the file and copy the topology
+// back instead of asking the driver again.
+
+#define ALX_CACHE_MAGIC         0x43584C41  /* 'ALXC' */
+#define ALX_CACHE_VERSION       5
+#define ALX_CACHE_MAX_SIZE      (1024 * 1024)
+
+// Cache file
+ALXchar CacheFile[MAX_PATH] = { 0 };
+
+struct Fingerprint
+{
+    WORD        wMid;
+    WORD        wPid;
+    DWORD       vDriverVersion;
+    DWORD       cDestinations;
+    ALXchar     szPname[MAXPNAMELEN];
+};
+
+struct CacheHeader
+{
+    DWORD       magic;
+    DWORD       version;
+    DWORD       used;
+    DWORD       reserved;
+};
+
+struct CacheEntry
+{
+    DWORD       size;
+    DWORD       checksum;
+    DWORD       capture;
+    ALXchar     deviceName[MAXPNAMELEN];
+    Fingerprint fingerprint;
+
+    DWORD       speakerID;
+    DWORD       speakerID_boolean;
+    DWORD       waveID;
+    DWORD       waveID_boolean;
+    DWORD       muxID;
+    DWORD       inputMux;
+    DWORD       peakID;
+    DWORD       inputMuteID;
+    DWORD       bassID;
+    DWORD       trebleID;
+    DWORD       equalizerID;
+
+    DWORD       dstSize;
+    DWORD       srcSize;
+    DWORD       muxItems;
+    /* followed by the serialized dst and src line tables, then the
+       source line of each input mux item */
+};
+
+bool getFingerprint(HMIXEROBJ hmx, Fingerprint &fingerprint)
+{
+    MIXERCAPS caps;
+
+    memset(&fingerprint, 0, sizeof(fingerprint));
+    if (driver->getDevCaps((UINT_PTR) hmx, &caps, sizeof(caps)) != MMSYSERR_NOERROR)
+        return false;
+
+    fingerprint.wMid = caps.wMid;
+    fingerprint.wPid = caps.wPid;
+    fingerprint.vDriverVersion = caps.vDriverVersion;
+    fingerprint.cDestinations = caps.cDestinations;
+    memcpy(fingerprint.szPname, caps.szPname, sizeof(fingerprint.szPname));
+    return true;
+}
+
+DWORD checksum(const char *data, DWORD size)
+{
+    DWORD hash = 2166136261UL;
+    DWORD i;
+
+    for (i = 0; i < size; i++) {
+        hash ^= (BYTE) data[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+DWORD poolSize(const ALXlines *lines)
+{
+    DWORD size = 0;
+    DWORD end;
+    UINT i;
+
+    for (i = 0; i < lines->count; i++) {
+        end = lines->nameOffset[i] + strlen(lines->name(i)) + 1;
+        if (end > size)
+            size = end;
+    }
+    return size;
+}
+
+DWORD linesSize(const ALXlines *lines)
+{
+    DWORD size;
+
+    if (lines == NULL)
+        return 0;
+
+    size = 2 * sizeof(DWORD)
+         + lines->count * (sizeof(DWORD) + sizeof(ALXlineControls) + sizeof(UINT))
+         + poolSize(lines);
+    return (size + 3) & ~3;
+}
+
+void writeLines(char *p, const ALXlines *lines)
+{
+    DWORD count = lines->count;
+    DWORD pool = poolSize(lines);
+
+    memcpy(p, &count, sizeof(DWORD));                               p += sizeof(DWORD);
+    memcpy(p, &pool, sizeof(DWORD));                                p += sizeof(DWORD);
+    memcpy(p, lines->lineID, count * sizeof(DWORD));                p += count * sizeof(DWORD);
+    memcpy(p, lines->controls, count * sizeof(ALXlineControls));    p += count * sizeof(ALXlineControls);
+    memcpy(p, lines->nameOffset, count * sizeof(UINT));             p += count * sizeof(UINT);
+    memcpy(p, lines->names, pool);
+}
+
+ALXlines *readLines(Arena *arena, const char *p, DWORD size)
+{
+    DWORD count;
+    DWORD pool;
+    ALXlines *lines;
+    DWORD i;
+
+    if (size < 2 * sizeof(DWORD) || size > ALX_CACHE_MAX_SIZE)
+        return NULL;
+
+    memcpy(&count, p, sizeof(DWORD));                               p += sizeof(DWORD);
+    memcpy(&pool, p, sizeof(DWORD));                                p += sizeof(DWORD);
+    if (count == 0 || count > size / (sizeof(DWORD) + sizeof(ALXlineControls) + sizeof(UINT))
+        || pool > size
+        || 2 * sizeof(DWORD) + count * (sizeof(DWORD) + sizeof(ALXlineControls) + sizeof(UINT)) + pool > size)
+        return NULL;
+
+    lines = ALXlines::create(arena, count, pool);
+    if (lines == NULL)
+        return NULL;
+
+    memcpy(lines->lineID, p, count * sizeof(DWORD));                p += count * sizeof(DWORD);
+    memcpy(lines->controls, p, count * sizeof(ALXlineControls));    p += count * sizeof(ALXlineControls);
+    memcpy(lines->nameOffset, p, count * sizeof(UINT));             p += count * sizeof(UINT);
+    memcpy(lines->names, p, pool);
+
+    // every name must start and end inside the pool
+    for (i = 0; i < count; i++) {
+        if (lines->nameOffset[i] >= pool
+            || memchr(lines->names + lines->nameOffset[i], '\0', pool - lines->nameOffset[i]) == NULL)
+            return NULL;
+    }
+    return lines;
+}
+
+class TopologyCache
+{
+public:
+    TopologyCache()
+        : _file(INVALID_HANDLE_VALUE), _mapping(NULL), _view(NULL), _size(0), _locked(false)
+    {}
+
+    ~TopologyCache() {
+        close();
+    }
+
+    /*
+        Maps the cache file, growing it so that 'extra' bytes can be
+        appended after the entries already stored. The file stays
+        locked until it is closed, shared for readers and exclusive for
+        a writer, since other processes open the same file.
+    */
+    bool open(const ALXchar *filename, DWORD extra) {
+        CacheHeader *header;
+        OVERLAPPED overlapped;
+        DWORD used;
+
+        _file = CreateFile(filename, GENERIC_READ | (extra ? GENERIC_WRITE : 0),
+            FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+            extra ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        memset(&overlapped, 0, sizeof(overlapped));
+        if (!LockFileEx(_file, extra ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, MAXDWORD, MAXDWORD, &overlapped)) {
+            CloseHandle(_file);
+            _file = INVALID_HANDLE_VALUE;
+            return false;
+        }
+        _locked = true;
+
+        _size = GetFileSize(_file, NULL);
+        if (_size == INVALID_FILE_SIZE || (_size < sizeof(CacheHeader) && !extra)) {
+            close();
+            return false;
+        }
+
+        if (extra) {
+            used = sizeof(CacheHeader);
+            if (_size >= sizeof(CacheHeader) && mapView(_size, false)) {
+                header = reinterpret_cast<CacheHeader *>(_view);
+                if (valid(header))
+                    used = header->used;
+                unmapView();
+            }
+            if (used + extra > ALX_CACHE_MAX_SIZE)
+                used = sizeof(CacheHeader);
+            if (used + extra > _size)
+                _size = used + extra;
+        }
+
+        if (!mapView(_size, extra != 0)) {
+            close();
+            return false;
+        }
+
+        header = reinterpret_cast<CacheHeader *>(_view);
+        if (!valid(header)) {
+            if (!extra) {
+                close();
+                return false;
+            }
+            header->magic = ALX_CACHE_MAGIC;
+            header->version = ALX_CACHE_VERSION;
+            header->used = sizeof(CacheHeader);
+            header->reserved = 0;
+        }
+        else if (header->used + extra > ALX_CACHE_MAX_SIZE) {
+            header->used = sizeof(CacheHeader);
+        }
+
+        return true;
+    }
+
+    void close() {
+        OVERLAPPED overlapped;
+
+        unmapView();
+        if (_locked) {
+            memset(&overlapped, 0, sizeof(overlapped));
+            UnlockFileEx(_file, 0, MAXDWORD, MAXDWORD, &overlapped);
+            _locked = false;
+        }
+        if (_file != INVALID_HANDLE_VALUE)
+            CloseHandle(_file);
+        _file = INVALID_HANDLE_VALUE;
+        _size = 0;
+    }
+
+    const CacheEntry *find(const ALXchar *deviceName, bool capture, const Fingerprint &fingerprint) const {
+        const CacheHeader *header = reinterpret_cast<const CacheHeader *>(_view);
+        const CacheEntry *entry;
+        DWORD offset = sizeof(CacheHeader);
+        DWORD used = header->used < _size ? header->used : _size;
+
+        while (offset + sizeof(CacheEntry) <= used) {
+            entry = reinterpret_cast<const CacheEntry *>(_view + offset);
+            if (entry->size < sizeof(CacheEntry) || offset + entry->size > used)
+                break;
+
+            if (entry->capture == (DWORD) capture
+                && !strncmp(entry->deviceName, deviceName, MAXPNAMELEN)
+                && !memcmp(&entry->fingerprint, &fingerprint, sizeof(Fingerprint))
+                && entry->muxItems <= ALX_CACHE_MAX_SIZE / sizeof(int)
+                && entry->dstSize + entry->srcSize + entry->muxItems * sizeof(int)
+                    <= entry->size - sizeof(CacheEntry)
+                && entry->checksum == checksum(reinterpret_cast<const char *>(entry) + 2 * sizeof(DWORD),
+                                               entry->size - 2 * sizeof(DWORD)))
+                return entry;
+
+            offset += entry->size;
+        }
+
+        return NULL;
+    }
+
+    /*
+        Drops the entries of a device, whatever driver they were made
+        with, moving those after them down.
+    */
+    void remove(const ALXchar *deviceName, bool capture) {
+        CacheHeader *header = reinterpret_cast<CacheHeader *>(_view);
+        const CacheEntry *entry;
+        DWORD offset = sizeof(CacheHeader);
+        DWORD used = header->used < _size ? header->used : _size;
+
+        while (offset + sizeof(CacheEntry) <= used) {
+            entry = reinterpret_cast<const CacheEntry *>(_view + offset);
+            if (entry->size < sizeof(CacheEntry) || offset + entry->size > used) {
+                used = offset;
+                break;
+            }
+
+            if (entry->capture == (DWORD) capture
+                && !strncmp(entry->deviceName, deviceName, MAXPNAMELEN)) {
+                memmove(_view + offset, _view + offset + entry->size, used - offset - entry->size);
+                used -= entry->size;
+            }
+            else {
+                offset += entry->size;
+            }
+        }
+        header->used = used;
+    }
+
+    CacheEntry *append(DWORD size) {
+        CacheHeader *header = reinterpret_cast<CacheHeader *>(_view);
+
+        if (header->used + size > _size)
+            return NULL;
+        return reinterpret_cast<CacheEntry *>(_view + header->used);
+    }
+
+    void commit(CacheEntry *entry) {
+        CacheHeader *header = reinterpret_cast<CacheHeader *>(_view);
+
+        entry->checksum = checksum(reinterpret_cast<const char *>(entry) + 2 * sizeof(DWORD),
+                                   entry->size - 2 * sizeof(DWORD));
+        header->used += entry->size;
+        FlushViewOfFile(_view, 0);
+    }
+
+private:
+    HANDLE      _file;
+    HANDLE      _mapping;
+    char       *_view;
+    DWORD       _size;
+    bool        _locked;
+
+    static bool valid(const CacheHeader *header) {
+        return header->magic == ALX_CACHE_MAGIC
+            && header->version == ALX_CACHE_VERSION
+            && header->used >= sizeof(CacheHeader);
+    }
+
+    bool mapView(DWORD size, bool writable) {
+        _mapping = CreateFileMapping(_file, NULL,
+            writable ? PAGE_READWRITE : PAGE_READONLY, 0, size, NULL);
+        if (_mapping == NULL)
+            return false;
+
+        _view = (char *) MapViewOfFile(_mapping,
+            writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+        if (_view == NULL) {
+            unmapView();
+            return false;
+        }
+
+        return true;
+    }
+
+    void unmapView() {
+        if (_view)
+            UnmapViewOfFile(_view);
+        if (_mapping)
+            CloseHandle(_mapping);
+        _view = NULL;
+        _mapping = NULL;
+    }
+};
+
+/*
+    alx::loadTopology
+
+    Fill the device controls from the topology cache, if any entry
+    matches the device name and the current driver fingerprint.
+*/
+bool loadTopology(ALXdevice *pMixer)
+{
+    Span span("loadTopology");
+    TopologyCache cache;
+    Fingerprint fingerprint;
+    const CacheEntry *entry;
+    const char *p;
+    char *block = NULL;
+    int source;
+    DWORD j;
+    bool valid = true;
+    bool capture = pMixer->hWaveIn != NULL;
+
+    if (!CacheFile[0] || !getFingerprint(pMixer->hmx, fingerprint))
+        return false;
+
+    if (!cache.open(CacheFile, 0))
+        return false;
+
+    entry = cache.find(pMixer->szDeviceName, capture, fingerprint);
+    if (entry == NULL)
+        return false;
+
+    p = reinterpret_cast<const char *>(entry + 1);
+    if (entry->dstSize) {
+        pMixer->dst = readLines(pMixer->arena, p, entry->dstSize);
+        if (pMixer->dst == NULL)
+            return false;
+        pMixer->numOutputs = pMixer->dst->count;
+    }
+    p += entry->dstSize;
+    if (entry->srcSize) {
+        pMixer->src = readLines(pMixer->arena, p, entry->srcSize);
+        if (pMixer->src == NULL) {
+            pMixer->dst = NULL;
+            pMixer->numOutputs = 0;
+            return false;
+        }
+        pMixer->numInputs = pMixer->src->count;
+    }
+    p += entry->srcSize;
+
+    // the source of every mux item must be one of the lines read
+    for (j = 0; j < entry->muxItems; j++) {
+        memcpy(&source, p + j * sizeof(int), sizeof(int));
+        if (source < -1 || source >= pMixer->numInputs)
+            valid = false;
+    }
+    if (valid && entry->muxItems > 0) {
+        block = (char *) pMixer->arena->alloc(pMixer->inputMuxSize(entry->muxItems));
+        valid = block != NULL;
+    }
+    if (!valid) {
+        pMixer->dst = NULL;
+        pMixer->src = NULL;
+        pMixer->numOutputs = pMixer->numInputs = 0;
+        return false;
+    }
+
+    if (block != NULL) {
+        pMixer->setInputMux(block, entry->muxItems);
+        for (j = 0; j < entry->muxItems; j++) {
+            memcpy(&source, p + j * sizeof(int), sizeof(int));
+            pMixer->linkInputMux(j, source);
+        }
+    }
+
+    pMixer->speakerID = entry->speakerID;
+    pMixer->speakerID_boolean = entry->speakerID_boolean;
+    pMixer->waveID = entry->waveID;
+    pMixer->waveID_boolean = entry->waveID_boolean;
+    pMixer->muxID = entry->muxID;
+    pMixer->inputMux = entry->inputMux != 0;
+    pMixer->peakID = entry->peakID;
+    pMixer->inputMuteID = entry->inputMuteID;
+    pMixer->bassID = entry->bassID;
+    pMixer->trebleID = entry->trebleID;
+    pMixer->equalizerID = entry->equalizerID;
+    return true;
+}
+
+/*
+    alx::storeTopology
+
+    Append what was discovered for the device to the topology cache.
+*/
+void storeTopology(ALXdevice *pMixer)
+{
+    Span span("storeTopology");
+    TopologyCache cache;
+    Fingerprint fingerprint;
+    CacheEntry *entry;
+    DWORD dstSize, srcSize, muxItems, size;
+    char *p;
+
+    if (!CacheFile[0] || !getFingerprint(pMixer->hmx, fingerprint))
+        return;
+
+    dstSize = linesSize(pMixer->dst);
+    srcSize = linesSize(pMixer->src);
+    muxItems = pMixer->muxFlags != NULL ? pMixer->muxItems : 0;
+    size = sizeof(CacheEntry) + dstSize + srcSize + muxItems * sizeof(int);
+
+    if (!cache.open(CacheFile, size))
+        return;
+
+    // a stale entry of the device is replaced, not left behind
+    cache.remove(pMixer->szDeviceName, pMixer->hWaveIn != NULL);
+    entry = cache.append(size);
+    if (entry == NULL)
+        return;
+
+    memset(entry, 0, size);
+    entry->size = size;
+    entry->capture = pMixer->hWaveIn != NULL;
+    strncpy(entry->deviceName, pMixer->szDeviceName, MAXPNAMELEN);
+    entry->fingerprint = fingerprint;
+    entry->speakerID = pMixer->speakerID;
+    entry->speakerID_boolean = pMixer->speakerID_boolean;
+    entry->waveID = pMixer->waveID;
+    entry->waveID_boolean = pMixer->waveID_boolean;
+    entry->muxID = pMixer->muxID;
+    entry->inputMux = pMixer->inputMux;
+    entry->peakID = pMixer->peakID;
+    entry->inputMuteID = pMixer->inputMuteID;
+    entry->bassID = pMixer->bassID;
+    entry->trebleID = pMixer->trebleID;
+    entry->equalizerID = pMixer->equalizerID;
+    entry->dstSize = dstSize;
+    entry->srcSize = srcSize;
+    entry->muxItems = muxItems;
+
+    p = reinterpret_cast<char *>(entry + 1);
+    if (pMixer->dst)
+        writeLines(p, pMixer->dst);
+    p += dstSize;
+    if (pMixer->src)
+        writeLines(p, pMixer->src);
+    p += srcSize;
+    if (muxItems)
+        memcpy(p, pMixer->muxSource, muxItems * sizeof(int));
+
+    cache.commit(entry);
+}
+
+} // namespace alx
+
+///////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////
+// ALMix Functions calls
+
+#define ALXAPI
+#define ALXAPIENTRY
+
+extern "C" {
+
+ALXAPI ALXdevice * ALXAPIENTRY alxOpenDevice(const ALXchar *devicename)
+{
+    alx::Span span("alxOpenDevice");
+    HMIXER hmx = NULL;
+    ALXdevice *pMixer = NULL;
+    UINT i, numDevs;
+    HWAVEOUT hWaveOut = NULL;
+    WAVEFORMATEX OutputType;
+    MMRESULT mmres;
+    const ALCchar *mixerDevice;
+
+    memset(&OutputType,0,sizeof(WAVEFORMATEX));
+    OutputType.wFormatTag=WAVE_FORMAT_PCM;
+    OutputType.nChannels=1;
+    OutputType.wBitsPerSample=16;
+    OutputType.nBlockAlign=OutputType.nChannels*OutputType.wBitsPerSample/8;
+    OutputType.nSamplesPerSec=8000;
+    OutputType.nAvgBytesPerSec=OutputType.nSamplesPerSec*OutputType.nBlockAlign;
+    OutputType.cbSize=0;
+
+    if ((devicename)) {
+        mixerDevice = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+
+        i = 0;
+        while (*mixerDevice) {
+            if (!strcmp(devicename, mixerDevice))
+                break;
+            mixerDevice += strlen(mixerDevice) + 1;
+            ++i;
+        }
+
+        if (*mixerDevice) {
+            numDevs = waveOutGetNumDevs();
+            if (i < numDevs) {
+                alx::Span step("open mixer");
+                waveOutOpen(&hWaveOut, i, &OutputType, 0, 0, CALLBACK_NULL);
+                mmres = alx::driver->open((LPHMIXER)&hmx,(UINT)hWaveOut,0,0,MIXER_OBJECTF_HWAVEOUT);
+            }
+
+            if (mmres==MMSYSERR_NOERROR) {
+                pMixer = ALXdevice::create();
+                if ((pMixer))
+                {
+                    pMixer->hmx = reinterpret_cast<HMIXEROBJ&>(hmx);
+                    pMixer->hWaveOut = hWaveOut;
+                    pMixer->szDeviceName = pMixer->arena->strdup(mixerDevice);
+
+                    if (!alx::loadTopology(pMixer)) {
+                        pMixer->discoverOutputs();
+                        alx::storeTopology(pMixer);
+                    }
+                    pMixer->mapControls();
+                    pMixer->trackState();
+                }
+                else {
+                    alx::driver->close(hmx);
+                    alx::setError(ALX_OUT_OF_MEMORY);
+                }
+            }
+            else {
+                alx::setError(ALX_INVALID_DEVICE);
+            }
+        }
+        else {
+            alx::setError(ALX_INVALID_DEVICE);
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return pMixer;
+}
+
+
+ALXAPI ALXdevice * ALXAPIENTRY alxOpenCaptureDevice(const ALXchar *devicename)
+{
+    alx::Span span("alxOpenCaptureDevice");
+    HMIXER hmx = NULL;
+    ALXdevice *pMixer = NULL;
+    UINT i, numDevs;
+    HWAVEIN hWaveIn = NULL;
+    WAVEFORMATEX InputType;
+    MMRESULT mmres;
+    const ALCchar *mixerDevice;
+
+    memset(&InputType,0,sizeof(WAVEFORMATEX));
+    InputType.wFormatTag=WAVE_FORMAT_PCM;
+    InputType.nChannels=1;
+    InputType.wBitsPerSample=16;
+    InputType.nBlockAlign=InputType.nChannels*InputType.wBitsPerSample/8;
+    InputType.nSamplesPerSec=8000;
+    InputType.nAvgBytesPerSec=InputType.nSamplesPerSec*InputType.nBlockAlign;
+    InputType.cbSize=0;
+
+    if ((devicename)) {
+        mixerDevice = alxGetString(NULL, ALX_CAPTURE_DEVICE_SPECIFIER);
+
+        i = 0;
+        while (*mixerDevice) {
+            if (!strcmp(devicename, mixerDevice))
+                break;
+            mixerDevice += strlen(mixerDevice) + 1;
+            ++i;
+        }
+
+        if (*mixerDevice) {
+            numDevs = waveInGetNumDevs();
+            if (i < numDevs) {
+                alx::Span step("open mixer");
+                waveInOpen(&hWaveIn, i, &InputType, 0, 0, CALLBACK_NULL);
+                mmres = alx::driver->open((LPHMIXER)&hmx,(UINT)hWaveIn,0,0,MIXER_OBJECTF_HWAVEIN);
+            }
+
+            if (mmres==MMSYSERR_NOERROR) {
+                pMixer = ALXdevice::create();
+                if ((pMixer))
+                {
+                    pMixer->hmx = reinterpret_cast<HMIXEROBJ&>(hmx);
+                    pMixer->hWaveIn = hWaveIn;
+                    pMixer->szDeviceName = pMixer->arena->strdup(mixerDevice);
+
+                    // the cache lays out the mux too, so it is stored after
+                    if (!alx::loadTopology(pMixer)) {
+                        pMixer->discoverInputs();
+                        pMixer->mapInputMux();
+                        alx::storeTopology(pMixer);
+                    }
+                    pMixer->mapInputMux();
+                    pMixer->mapControls();
+                    pMixer->trackState();
+                }
+                else {
+                    alx::driver->close(hmx);
+                    alx::setError(ALX_OUT_OF_MEMORY);
+                }
+            }
+            else {
+                alx::setError(ALX_INVALID_DEVICE);
+            }
+        }
+        else {
+            alx::setError(ALX_INVALID_DEVICE);
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return pMixer;
+}
+
+
+ALXAPI ALXdevice * ALXAPIENTRY alxMapDevice(ALCdevice *pDevice)
+{
+    ALXdevice *pMixer = NULL;
+    const ALCchar *deviceName;
+    const ALCchar *mixerDevice;
+
+    if ((pDevice)) {
+        deviceName = alcGetString(pDevice, ALC_DEVICE_SPECIFIER);
+        mixerDevice = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
+
+        while (*mixerDevice) {
+            if (alx::match_device_name(deviceName, mixerDevice))
+                break;
+            mixerDevice += strlen(mixerDevice) + 1;
+        }
+
+        if (*mixerDevice) {
+            pMixer = alxOpenDevice(mixerDevice);
+        }
+        else {
+            // Open default output mixer, so we can map
+            // 'Generic Software' and 'Generic Hardware'
+            pMixer = alxOpenDevice(alx::DeviceList);
+        }
+
+        if (pMixer) {
+            pMixer->alcDevice = pDevice;
+        }
+        else if ((pMixer = ALXdevice::create()) != NULL) {
+            // No mixer at all, as with a loopback device on a machine
+            // without sound hardware: the device only has the OpenAL
+            // backend, so the listener gain and buses still work.
+            alx::setError(ALX_NO_ERROR);
+            pMixer->alcDevice = pDevice;
+            pMixer->backend = ALX_BACKEND_OPENAL;
+            pMixer->szDeviceName = pMixer->arena->strdup(deviceName);
+            pMixer->mapControls();
+            pMixer->trackState();
+        }
+        else {
+            alx::setError(ALX_OUT_OF_MEMORY);
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return pMixer;
+}
+
+
+ALXAPI ALXdevice * ALXAPIENTRY alxMapCaptureDevice(ALCdevice *pDevice)
+{
+    ALXdevice *pMixer = NULL;
+    const ALCchar *deviceName;
+    const ALCchar *mixerDevice;
+
+    if ((pDevice)) {
+        deviceName = alcGetString(pDevice, ALC_CAPTURE_DEVICE_SPECIFIER);
+        mixerDevice = alxGetString(NULL, ALX_CAPTURE_DEVICE_SPECIFIER);
+
+        while (*mixerDevice) {
+            if (alx::match_device_name(deviceName, mixerDevice))
+                break;
+            mixerDevice += strlen(mixerDevice) + 1;
+        }
+
+        if (*mixerDevice) {
+            pMixer = alxOpenCaptureDevice(mixerDevice);
+        }
+        else {
+            // Open default output mixer, so we can map
+            // 'Generic Software' and 'Generic Hardware'
+            pMixer = alxOpenCaptureDevice(alx::CaptureDeviceList);
+        }
+
+        if (pMixer)
+            pMixer->alcCaptureDevice = pDevice;
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return pMixer;
+}
+
+
+ALXAPI void ALXAPIENTRY alxCloseDevice(ALXdevice *pMixer)
+{
+    if (pMixer)
+        alx::forgetDevice(pMixer);
+    ALXdevice::destroy(pMixer);
+}
+
+
+ALXAPI ALXfloat ALXAPIENTRY alxGetFloat(ALXdevice *pMixer, ALXenum param)
+{
+    ALXfloat value = -1.0;
+
+    if (pMixer)
+    {
+        switch (param)
+        {
+        case ALX_MASTER_VOLUME:
+            value = pMixer->getMasterVolume();
+            break;
+
+        case ALX_PCM_OUTPUT_VOLUME:
+            value = pMixer->getPCMOutputVolume();
+            break;
+
+        case ALX_INPUT_VOLUME:
+            value = pMixer->getInputVolume();
+            break;
+
+        case ALX_INPUT_PEAK:
+            if (pMixer->getInputLevel(ALX_LEVEL_PEAK, value) != MMSYSERR_NOERROR)
+                alx::setError(ALX_INVALID_OPERATION);
+            break;
+
+        case ALX_INPUT_RMS:
+            if (pMixer->getInputLevel(ALX_LEVEL_RMS, value) != MMSYSERR_NOERROR)
+                alx::setError(ALX_INVALID_OPERATION);
+            break;
+
+        case ALX_BASS:
+            pMixer->getTone(alx::ToneFilter::Bass, value);
+            break;
+
+        case ALX_TREBLE:
+            pMixer->getTone(alx::ToneFilter::Treble, value);
+            break;
+
+        case ALX_GATE_THRESHOLD:
+        case ALX_GATE_RATIO:
+        case ALX_GATE_ATTACK:
+        case ALX_GATE_RELEASE:
+        case ALX_GATE_RANGE:
+        case ALX_GATE_MUTE_DELAY:
+            if (pMixer->getGate(param - ALX_GATE_THRESHOLD, value) != MMSYSERR_NOERROR)
+                alx::setError(ALX_INVALID_OPERATION);
+            break;
+
+        case ALX_GATE_GAIN:
+            value = pMixer->gate ? pMixer->gate->gain() : 0.0f;
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return value;
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetFloat(ALXdevice *pMixer, ALXenum param, ALXfloat value)
+{
+    if (pMixer)
+    {
+        switch (param)
+        {
+        case ALX_MASTER_VOLUME:
+            pMixer->setMasterVolume(value);
+            break;
+
+        case ALX_PCM_OUTPUT_VOLUME:
+            pMixer->setPCMOutputVolume(value);
+            break;
+
+        case ALX_INPUT_VOLUME:
+            pMixer->setInputVolume(value);
+            break;
+
+        case ALX_BASS:
+            if (pMixer->setTone(alx::ToneFilter::Bass, value) == MMSYSERR_INVALPARAM)
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        case ALX_TREBLE:
+            if (pMixer->setTone(alx::ToneFilter::Treble, value) == MMSYSERR_INVALPARAM)
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        case ALX_GATE_THRESHOLD:
+        case ALX_GATE_RATIO:
+        case ALX_GATE_ATTACK:
+        case ALX_GATE_RELEASE:
+        case ALX_GATE_RANGE:
+        case ALX_GATE_MUTE_DELAY:
+            switch (pMixer->setGate(param - ALX_GATE_THRESHOLD, value)) {
+            case MMSYSERR_NOERROR:      break;
+            case MMSYSERR_INVALPARAM:   alx::setError(ALX_INVALID_VALUE); break;
+            default:                    alx::setError(ALX_INVALID_OPERATION); break;
+            }
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxGetBoolean(ALXdevice *pMixer, ALXenum param)
+{
+    ALXboolean value = ALX_FALSE;
+
+    if (pMixer)
+    {
+        switch (param)
+        {
+        case ALX_PCM_OUTPUT:
+            value = pMixer->hasPCMOutputVolume();
+            break;
+
+        case ALX_MASTER_VOLUME:
+            value = pMixer->isDisabledMasterVolume();
+            break;
+
+        case ALX_PCM_OUTPUT_VOLUME:
+            value = pMixer->isDisabledPCMOutputVolume();
+            break;
+
+        case ALX_GATE_MUTED:
+            value = pMixer->gateMuted ? ALX_TRUE : ALX_FALSE;
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return value;
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetBoolean(ALXdevice *pMixer, ALXenum param, ALXboolean value)
+{
+    if (pMixer)
+    {
+        switch (param)
+        {
+        case ALX_MASTER_VOLUME:
+            pMixer->disableMasterVolume(value);
+            break;
+
+        case ALX_PCM_OUTPUT_VOLUME:
+            pMixer->disablePCMOutputVolume(value);
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+}
+
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetString(ALXdevice *pMixer, ALXenum param)
+{
+    UINT i, numDevs;
+    const ALXchar *value = NULL;
+    ALXchar *szDeviceList;
+    WAVEINCAPS WaveInCaps;
+    WAVEOUTCAPS WaveOutCaps;
+
+    switch (param)
+    {
+    case ALX_DEVICE_SPECIFIER:
+        if (pMixer)
+        {
+            if (pMixer->hWaveOut)
+                value = pMixer->szDeviceName;
+            else
+                alx::setError(ALX_INVALID_DEVICE);
+        }
+        else
+        {
+            alx::Span span("enumerate output devices");
+            szDeviceList = alx::DeviceList;
+
+            numDevs = waveOutGetNumDevs();
+            for (i = 0; i < numDevs; ++i)
+            {
+                if (waveOutGetDevCaps(i, &WaveOutCaps, sizeof(WaveOutCaps)) == MMSYSERR_NOERROR)
+                {
+                    sprintf(szDeviceList, "%s", WaveOutCaps.szPname);
+                    szDeviceList += strlen(szDeviceList) + 1;
+                }
+            }
+
+            szDeviceList[0] = '\0';
+            value = alx::DeviceList;
+        }
+        break;
+
+    case ALX_CAPTURE_DEVICE_SPECIFIER:
+        if (pMixer)
+        {
+            if (pMixer->hWaveIn)
+                value = pMixer->szDeviceName;
+            else
+                alx::setError(ALX_INVALID_DEVICE);
+        }
+        else
+        {
+            alx::Span span("enumerate capture devices");
+            szDeviceList = alx::CaptureDeviceList;
+
+            numDevs = waveInGetNumDevs();
+            for (i = 0; i < numDevs; ++i)
+            {
+                if (waveInGetDevCaps(i, &WaveInCaps, sizeof(WaveInCaps)) == MMSYSERR_NOERROR)
+                {
+                    sprintf(szDeviceList, "%s", WaveInCaps.szPname);
+                    szDeviceList += strlen(szDeviceList) + 1;
+                }
+            }
+
+            szDeviceList[0] = '\0';
+            value = alx::CaptureDeviceList;
+        }
+        break;
+
+    default:
+        alx::setError(ALX_INVALID_ENUM);
+        break;
+    }
+
+    return value;
+}
+
+
+ALXAPI ALXint ALXAPIENTRY alxGetInteger(ALXdevice *pMixer, ALXenum param)
+{
+    ALXint value = -1;
+
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_OUTPUT_VOLUME_SPECIFIER:
+            value = pMixer->getNumOutputVolumes();
+            break;
+ 
+        case ALX_INPUT_SOURCE_SPECIFIER:
+            value = pMixer->getNumInputSources();
+            break;
+
+        case ALX_INPUT_SOURCE:
+            value = pMixer->getCurrentInputSource();
+            break;
+
+        case ALX_BACKEND:
+            value = pMixer->backend;
+            break;
+
+        case ALX_QUEUE_SIZE:
+            value = pMixer->queue ? pMixer->queue->capacity() : 0;
+            break;
+
+        case ALX_QUEUE_PENDING:
+            value = pMixer->queue ? pMixer->queue->pending() : 0;
+            break;
+
+        case ALX_QUEUE_DROPPED:
+            value = pMixer->queue ? pMixer->queue->dropped() : 0;
+            break;
+
+        case ALX_QUEUE_OVERFLOW:
+            value = pMixer->queue ? pMixer->queue->policy() : ALX_QUEUE_DROP_NEWEST;
+            break;
+
+        case ALX_GENERATION:
+            value = pMixer->state.generation();
+            break;
+
+        case ALX_CHANGE_LOG_SIZE:
+            value = pMixer->state.logSize();
+            break;
+
+        case ALX_EQUALIZER_BANDS:
+            value = pMixer->getNumEqualizerBands();
+            break;
+
+        case ALX_TONE_HARDWARE:
+            value = pMixer->getToneHardware();
+            break;
+ 
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else if (param == ALX_LEVEL_ISA) {
+        value = alx::levelISA();
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return value;
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetInteger(ALXdevice *pMixer, ALXenum param, ALXint value)
+{
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_INPUT_SOURCE:
+            if (pMixer->setCurrentInputSource(value) == MMSYSERR_INVALPARAM)
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        case ALX_QUEUE_SIZE:
+            if (!pMixer->setQueueSize(value))
+                alx::setError(ALX_OUT_OF_MEMORY);
+            break;
+
+        case ALX_QUEUE_OVERFLOW:
+            if (value != ALX_QUEUE_DROP_NEWEST && value != ALX_QUEUE_DROP_OLDEST)
+                alx::setError(ALX_INVALID_VALUE);
+            else if (pMixer->queue == NULL)
+                alx::setError(ALX_INVALID_OPERATION);
+            else
+                pMixer->queue->setPolicy(value);
+            break;
+
+        case ALX_CHANGE_LOG_SIZE:
+            if (value < 0 || value > ALX_CHANGE_LOG_SIZE_MAX)
+                alx::setError(ALX_INVALID_VALUE);
+            else if (!pMixer->setChangeLogSize(value))
+                alx::setError(ALX_OUT_OF_MEMORY);
+            break;
+
+        case ALX_BACKEND:
+            if (value != ALX_BACKEND_DRIVER && value != ALX_BACKEND_OPENAL)
+                alx::setError(ALX_INVALID_VALUE);
+            else if (!pMixer->setBackend(value))
+                alx::setError(ALX_INVALID_OPERATION);
+            break;
+ 
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else if (param == ALX_LEVEL_ISA) {
+        if (!alx::setLevelISA(value))
+            alx::setError(ALX_INVALID_VALUE);
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+}
+
+
+/*
+    alxGetIntegerv
+
+    Raw value of a volume, in the driver's units, or its range. 'index'
+    is only used by ALX_OUTPUT_VOLUME and its range.
+*/
+ALXAPI void ALXAPIENTRY alxGetIntegerv(ALXdevice *pMixer, ALXenum param, ALXint index, ALXint *values)
+{
+    DWORD raw, minimum, maximum, step;
+    ALXenum volume;
+    MMRESULT res;
+
+    if (pMixer == NULL) {
+        alx::setError(ALX_INVALID_DEVICE);
+        return;
+    }
+
+    if (values == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    switch (param)
+    {
+    case ALX_MASTER_VOLUME:
+    case ALX_PCM_OUTPUT_VOLUME:
+    case ALX_INPUT_VOLUME:
+    case ALX_OUTPUT_VOLUME:
+        res = pMixer->getRawVolume(param, index, raw);
+        if (res == MMSYSERR_NOERROR)
+            values[0] = (ALXint) raw;
+        else
+            alx::setError(alx::status(res));
+        return;
+
+    case ALX_MASTER_VOLUME_MIN:
+    case ALX_MASTER_VOLUME_MAX:
+    case ALX_MASTER_VOLUME_STEP:
+        volume = ALX_MASTER_VOLUME;
+        break;
+
+    case ALX_PCM_OUTPUT_VOLUME_MIN:
+    case ALX_PCM_OUTPUT_VOLUME_MAX:
+    case ALX_PCM_OUTPUT_VOLUME_STEP:
+        volume = ALX_PCM_OUTPUT_VOLUME;
+        break;
+
+    case ALX_INPUT_VOLUME_MIN:
+    case ALX_INPUT_VOLUME_MAX:
+    case ALX_INPUT_VOLUME_STEP:
+        volume = ALX_INPUT_VOLUME;
+        break;
+
+    case ALX_OUTPUT_VOLUME_MIN:
+    case ALX_OUTPUT_VOLUME_MAX:
+    case ALX_OUTPUT_VOLUME_STEP:
+        volume = ALX_OUTPUT_VOLUME;
+        break;
+
+    default:
+        alx::setError(ALX_INVALID_ENUM);
+        return;
+    }
+
+    res = pMixer->getVolumeRange(volume, index, minimum, maximum, step);
+    if (res != MMSYSERR_NOERROR) {
+        alx::setError(alx::status(res));
+        return;
+    }
+
+    // Each range comes as MIN, MAX and STEP in that order.
+    switch ((param - ALX_MASTER_VOLUME_MIN) % 3) {
+    case 0:  values[0] = (ALXint) minimum; break;
+    case 1:  values[0] = (ALXint) maximum; break;
+    default: values[0] = (ALXint) step;    break;
+    }
+}
+
+
+/*
+    alxSetIntegerv
+
+    Set a volume to a raw value, in the driver's units, which must be
+    within its range.
+*/
+ALXAPI void ALXAPIENTRY alxSetIntegerv(ALXdevice *pMixer, ALXenum param, ALXint index, const ALXint *values)
+{
+    MMRESULT res;
+
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_MASTER_VOLUME:
+        case ALX_PCM_OUTPUT_VOLUME:
+        case ALX_INPUT_VOLUME:
+        case ALX_OUTPUT_VOLUME:
+            if (values == NULL || values[0] < 0) {
+                alx::setError(ALX_INVALID_VALUE);
+                break;
+            }
+            res = pMixer->setRawVolume(param, index, (DWORD) values[0]);
+            if (res != MMSYSERR_NOERROR)
+                alx::setError(alx::status(res));
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+}
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetIndexedString(ALXdevice *pMixer, ALXenum param, ALXint index)
+{
+    const ALXchar *value = NULL;
+
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_OUTPUT_VOLUME_SPECIFIER:
+            value = pMixer->getOutputVolumeName(index);
+            break;
+ 
+        case ALX_INPUT_SOURCE_SPECIFIER:
+            value = pMixer->getInputSourceName(index);
+            break;
+ 
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return value;
+}
+
+
+ALXAPI ALXfloat ALX_APIENTRY alxGetIndexedFloat(ALXdevice *pMixer, ALXenum param, ALXint index)
+{
+    ALXfloat value = -1.0f;
+    alx::Bus *bus;
+
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_OUTPUT_VOLUME:
+            value = pMixer->getOutputVolume(index);
+            break;
+
+        case ALX_BUS_GAIN:
+            if ((bus = pMixer->findBus(index)) != NULL)
+                value = bus->gain;
+            else if (index == 0)
+                value = 1.0f;
+            else
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        case ALX_EQUALIZER:
+            if (pMixer->getEqualizer(index, value) == MMSYSERR_INVALPARAM)
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+ 
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return value;
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxGetIndexedBoolean(ALXdevice *pMixer, ALXenum param, ALXint index)
+{
+    ALXboolean value = ALX_FALSE;
+    alx::Bus *bus;
+
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_OUTPUT_VOLUME:
+            value = pMixer->isDisabledOutputVolume(index);
+            break;
+
+        case ALX_INPUT_SOURCE:
+            value = pMixer->isDisabledInputVolume(index);
+            break;
+
+        case ALX_BUS_MUTE:
+            if ((bus = pMixer->findBus(index)) != NULL)
+                value = bus->mute;
+            else if (index == 0)
+                value = ALX_FALSE;
+            else
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+
+    return value;
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetIndexedFloat(ALXdevice *pMixer, ALXenum param, ALXint index, ALXfloat value)
+{
+    alx::Bus *bus;
+
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_OUTPUT_VOLUME:
+            pMixer->setOutputVolume(index, value);
+            break;
+
+        case ALX_INPUT_SOURCE:
+            if (pMixer->selectInputSource(index, value) == MMSYSERR_INVALPARAM)
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        case ALX_BUS_GAIN:
+            if ((bus = pMixer->findBus(index, true)) != NULL && value >= 0.0f) {
+                pMixer->buses->setGain(bus, value);
+                pMixer->flushBuses();
+            }
+            else
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        case ALX_EQUALIZER:
+            if (pMixer->setEqualizer(index, value) == MMSYSERR_INVALPARAM)
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetIndexedBoolean(ALXdevice *pMixer, ALXenum param, ALXint index, ALXboolean value)
+{
+    alx::Bus *bus;
+
+    if (pMixer) {
+        switch (param)
+        {
+        case ALX_OUTPUT_VOLUME:
+            pMixer->disableOutputVolume(index, value);
+            break;
+
+        case ALX_BUS_MUTE:
+            if ((bus = pMixer->findBus(index, true)) != NULL) {
+                pMixer->buses->setMute(bus, value ? ALX_TRUE : ALX_FALSE);
+                pMixer->flushBuses();
+            }
+            else
+                alx::setError(ALX_INVALID_VALUE);
+            break;
+
+        default:
+            alx::setError(ALX_INVALID_ENUM);
+            break;
+        }
+    }
+    else {
+        alx::setError(ALX_INVALID_DEVICE);
+    }
+}
+
+
+/*
+    Typed access
+
+    One entry point per control, calling the device directly. They
+    return the status instead of setting the last error, and leave
+    'value' alone when they fail; a NULL 'value' is ALX_INVALID_VALUE.
+*/
+ALXAPI ALXenum ALXAPIENTRY alxGetMasterVolume(ALXdevice *pMixer, ALXfloat *value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+    return alx::status(pMixer->getMasterVolume(*value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetMasterVolume(ALXdevice *pMixer, ALXfloat value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->setMasterVolume(value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetMasterMute(ALXdevice *pMixer, ALXboolean *value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+    return alx::status(pMixer->isDisabledMasterVolume(*value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetMasterMute(ALXdevice *pMixer, ALXboolean value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->disableMasterVolume(value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetPCMOutputVolume(ALXdevice *pMixer, ALXfloat *value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+    return alx::status(pMixer->getPCMOutputVolume(*value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetPCMOutputVolume(ALXdevice *pMixer, ALXfloat value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->setPCMOutputVolume(value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetPCMOutputMute(ALXdevice *pMixer, ALXboolean *value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+    return alx::status(pMixer->isDisabledPCMOutputVolume(*value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetPCMOutputMute(ALXdevice *pMixer, ALXboolean value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->disablePCMOutputVolume(value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetInputVolume(ALXdevice *pMixer, ALXfloat *value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+    return alx::status(pMixer->getInputVolume(*value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetInputVolume(ALXdevice *pMixer, ALXfloat value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->setInputVolume(value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetInputSource(ALXdevice *pMixer, ALXint *value)
+{
+    int i;
+
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+
+    i = pMixer->getCurrentInputSource();
+    if (i < 0)
+        return ALX_INVALID_OPERATION;
+
+    *value = i;
+    return ALX_NO_ERROR;
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetInputSource(ALXdevice *pMixer, ALXint value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->setCurrentInputSource(value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetOutputVolume(ALXdevice *pMixer, ALXint index, ALXfloat *value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+    return alx::status(pMixer->getOutputVolume(index, *value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetOutputVolume(ALXdevice *pMixer, ALXint index, ALXfloat value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->setOutputVolume(index, value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxGetOutputMute(ALXdevice *pMixer, ALXint index, ALXboolean *value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    if (value == NULL)
+        return ALX_INVALID_VALUE;
+    return alx::status(pMixer->isDisabledOutputVolume(index, *value));
+}
+
+ALXAPI ALXenum ALXAPIENTRY alxSetOutputMute(ALXdevice *pMixer, ALXint index, ALXboolean value)
+{
+    if (pMixer == NULL)
+        return ALX_INVALID_DEVICE;
+    return alx::status(pMixer->disableOutputVolume(index, value));
+}
+
+ALXAPI ALXint ALXAPIENTRY alxGetOutputCount(ALXdevice *pMixer)
+{
+    return pMixer ? pMixer->getNumOutputVolumes() : 0;
+}
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetOutputName(ALXdevice *pMixer, ALXint index)
+{
+    return pMixer ? pMixer->getOutputVolumeName(index) : NULL;
+}
+
+ALXAPI ALXint ALXAPIENTRY alxGetInputSourceCount(ALXdevice *pMixer)
+{
+    return pMixer ? pMixer->getNumInputSources() : 0;
+}
+
+ALXAPI const ALXchar * ALXAPIENTRY alxGetInputSourceName(ALXdevice *pMixer, ALXint index)
+{
+    return pMixer ? pMixer->getInputSourceName(index) : NULL;
+}
+
+/*
+    alxGetProcAddress
+
+    Retrieves the function address for a particular extension function
+*/
+ALXAPI void * ALXAPIENTRY alxGetProcAddress(ALXdevice *device, const ALXchar *funcName)
+{
+    int i = 0;
+    void *pFunction = NULL;
+
+    if (funcName)
+    {
+        while ((alx::Functions[i].funcName)&&(strcmp(alx::Functions[i].funcName,funcName)))
+            i++;
+        pFunction = alx::Functions[i].address;
     }
-    else {
-        alx::setError(ALX_INVALID_DEVICE);
+    else
+    {
+        alx::setError(ALX_INVALID_VALUE);
     }
 
-    return pMixer;
+    return pFunction;
 }
 
 
-ALXAPI ALXdevice * ALXAPIENTRY alxMapDevice(ALCdevice *pDevice)
-{
-    ALXdevice *pMixer = NULL;
-    const ALCchar *deviceName;
-    const ALCchar *mixerDevice;
-
-    if ((pDevice)) {
-        deviceName = alcGetString(pDevice, ALC_DEVICE_SPECIFIER);
-        mixerDevice = alxGetString(NULL, ALX_DEVICE_SPECIFIER);
-
-        while (*mixerDevice) {
-            if (alx::match_device_name(deviceName, mixerDevice))
-                break;
-            mixerDevice += strlen(mixerDevice) + 1;
-        }
+/*
+    alxSetAllocator
 
-        if (*mixerDevice) {
-            pMixer = alxOpenDevice(mixerDevice);
-        }
-        else {
-            // Open default output mixer, so we can map
-            // 'Generic Software' and 'Generic Hardware'
-            pMixer = alxOpenDevice(alx::DeviceList);
-        }
+    Route the memory of devices opened from now on through the given
+    functions; NULL restores malloc and free
+*/
+ALXAPI void ALXAPIENTRY alxSetAllocator(LPALXALLOC allocFunc, LPALXFREE freeFunc, void *userdata)
+{
+    if (allocFunc != NULL && freeFunc != NULL) {
+        alx::AllocFunc = allocFunc;
+        alx::FreeFunc = freeFunc;
+        alx::AllocData = userdata;
     }
     else {
-        alx::setError(ALX_INVALID_DEVICE);
+        alx::AllocFunc = alx::defaultAlloc;
+        alx::FreeFunc = alx::defaultFree;
+        alx::AllocData = NULL;
     }
-
-    return pMixer;
 }
 
 
-ALXAPI ALXdevice * ALXAPIENTRY alxMapCaptureDevice(ALCdevice *pDevice)
-{
-    ALXdevice *pMixer = NULL;
-    const ALCchar *deviceName;
-    const ALCchar *mixerDevice;
-
-    if ((pDevice)) {
-        deviceName = alcGetString(pDevice, ALC_CAPTURE_DEVICE_SPECIFIER);
-        mixerDevice = alxGetString(NULL, ALX_CAPTURE_DEVICE_SPECIFIER);
+/*
+    alxGetChangesSince
 
-        while (*mixerDevice) {
-            if (alx::match_device_name(deviceName, mixerDevice))
-                break;
-            mixerDevice += strlen(mixerDevice) + 1;
-        }
+    Copy up to 'count' changes made after 'generation', oldest first.
+    Returns how many were copied, or -1 when some of them are no longer
+    in the log and every value has to be read again.
+*/
+ALXAPI ALXint ALXAPIENTRY alxGetChangesSince(ALXdevice *pMixer, ALXint generation, ALXchange *changes, ALXint count)
+{
+    ALXint n;
 
-        if (*mixerDevice) {
-            pMixer = alxOpenCaptureDevice(mixerDevice);
-        }
-        else {
-            // Open default output mixer, so we can map
-            // 'Generic Software' and 'Generic Hardware'
-            pMixer = alxOpenCaptureDevice(alx::CaptureDeviceList);
-        }
-    }
-    else {
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return -1;
     }
 
-    return pMixer;
-}
-
+    if (changes == NULL || count < 0) {
+        alx::setError(ALX_INVALID_VALUE);
+        return -1;
+    }
 
-ALXAPI void ALXAPIENTRY alxCloseDevice(ALXdevice *pMixer)
-{
-    delete pMixer;
+    n = pMixer->state.changesSince(generation, changes, count);
+    if (n < 0)
+        alx::setError(ALX_INVALID_VALUE);
+    return n;
 }
 
 
-ALXAPI ALXfloat ALXAPIENTRY alxGetFloat(ALXdevice *pMixer, ALXenum param)
-{
-    ALXfloat value = -1.0;
+/*
+    alxPublishSharedState
 
-    if (pMixer)
-    {
-        switch (param)
-        {
-        case ALX_MASTER_VOLUME:
-            value = pMixer->getMasterVolume();
-            break;
+    Create the shared state segment. The view stays mapped while
+    publishing, so it outlives the mapping handle.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxPublishSharedState(const ALXchar *name)
+{
+    HANDLE mapping;
+    ALXsharedState *state;
 
-        case ALX_PCM_OUTPUT_VOLUME:
-            value = pMixer->getPCMOutputVolume();
-            break;
+    if (alx::Shared != NULL) {
+        UnmapViewOfFile(alx::Shared);
+        alx::Shared = NULL;
+        InterlockedIncrement(&alx::SharedGeneration);
+    }
 
-        case ALX_INPUT_VOLUME:
-            value = pMixer->getInputVolume();
-            break;
+    if (name == NULL)
+        return ALX_TRUE;
 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
+    mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+        0, sizeof(ALXsharedState), name);
+    if (mapping == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
     }
-    else {
-        alx::setError(ALX_INVALID_DEVICE);
+
+    state = (ALXsharedState *) MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(ALXsharedState));
+    CloseHandle(mapping);
+    if (state == NULL) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return ALX_FALSE;
     }
 
-    return value;
+    // a segment left by a previous owner is started over
+    memset(state, 0, sizeof(ALXsharedState));
+    state->magic = ALX_SHARED_STATE_MAGIC;
+    state->version = ALX_SHARED_STATE_VERSION;
+
+    alx::Shared = state;
+    return ALX_TRUE;
 }
 
 
-ALXAPI void ALXAPIENTRY alxSetFloat(ALXdevice *pMixer, ALXenum param, ALXfloat value)
+/*
+    alxAttachSharedState
+*/
+ALXAPI const ALXsharedState * ALXAPIENTRY alxAttachSharedState(const ALXchar *name)
 {
-    if (pMixer)
-    {
-        switch (param)
-        {
-        case ALX_MASTER_VOLUME:
-            pMixer->setMasterVolume(value);
-            break;
+    return alx::attachSharedState(name);
+}
 
-        case ALX_PCM_OUTPUT_VOLUME:
-            pMixer->setPCMOutputVolume(value);
-            break;
 
-        case ALX_INPUT_VOLUME:
-            pMixer->setInputVolume(value);
-            break;
+/*
+    alxReadSharedDevice
 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
-    }
-    else {
-        alx::setError(ALX_INVALID_DEVICE);
-    }
+    Copy a device slot, retrying while the owner writes it
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxReadSharedDevice(const ALXsharedState *state, ALXint index, ALXsharedDevice *values)
+{
+    return alx::readSharedDevice(state, index, values) ? ALX_TRUE : ALX_FALSE;
 }
 
 
-ALXAPI ALXboolean ALXAPIENTRY alxGetBoolean(ALXdevice *pMixer, ALXenum param)
+/*
+    alxDetachSharedState
+*/
+ALXAPI void ALXAPIENTRY alxDetachSharedState(const ALXsharedState *state)
 {
-    ALXboolean value = ALX_FALSE;
+    alx::detachSharedState(state);
+}
 
-    if (pMixer)
-    {
-        switch (param)
-        {
-        case ALX_PCM_OUTPUT:
-            value = pMixer->hasPCMOutputVolume();
-            break;
 
-        case ALX_MASTER_VOLUME:
-            value = pMixer->isDisabledMasterVolume();
-            break;
+/*
+    alxStartTrace
 
-        case ALX_PCM_OUTPUT_VOLUME:
-            value = pMixer->isDisabledPCMOutputVolume();
-            break;
+    Record the driver calls of every device into a ring file of
+    'records' calls. Not to be called while other threads use devices.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxStartTrace(const ALXchar *filename, ALXint records)
+{
+    alxStopTrace();
 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
+    if (filename == NULL || records <= 0) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
     }
-    else {
-        alx::setError(ALX_INVALID_DEVICE);
+
+    if (!alx::Tracer.open(filename, records)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
     }
 
-    return value;
+    alx::driver = &alx::Traced;
+    return ALX_TRUE;
 }
 
 
-ALXAPI void ALXAPIENTRY alxSetBoolean(ALXdevice *pMixer, ALXenum param, ALXboolean value)
+/*
+    alxStopTrace
+*/
+ALXAPI void ALXAPIENTRY alxStopTrace()
 {
-    if (pMixer)
-    {
-        switch (param)
-        {
-        case ALX_MASTER_VOLUME:
-            pMixer->disableMasterVolume(value);
-            break;
+    alx::driver = &alx::Winmm;
+    alx::Tracer.close();
+}
 
-        case ALX_PCM_OUTPUT_VOLUME:
-            pMixer->disablePCMOutputVolume(value);
-            break;
 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
-    }
-    else {
-        alx::setError(ALX_INVALID_DEVICE);
+/*
+    alxStartEventTrace
+
+    Write trace events to a Chrome JSON trace file
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxStartEventTrace(const ALXchar *filename)
+{
+    alxStopEventTrace();
+
+    if (filename == NULL || !alx::Events.open(filename)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
     }
+
+    return ALX_TRUE;
 }
 
 
-ALXAPI const ALXchar * ALXAPIENTRY alxGetString(ALXdevice *pMixer, ALXenum param)
+/*
+    alxStopEventTrace
+*/
+ALXAPI void ALXAPIENTRY alxStopEventTrace()
 {
-    UINT i, numDevs;
-    const ALXchar *value = NULL;
-    ALXchar *szDeviceList;
-    WAVEINCAPS WaveInCaps;
-    WAVEOUTCAPS WaveOutCaps;
+    alx::Events.close();
+}
 
-    switch (param)
-    {
-    case ALX_DEVICE_SPECIFIER:
-        if (pMixer)
-        {
-            if (pMixer->hWaveOut)
-                value = pMixer->szDeviceName;
-            else
-                alx::setError(ALX_INVALID_DEVICE);
-        }
-        else
-        {
-            szDeviceList = alx::DeviceList;
 
-            numDevs = waveOutGetNumDevs();
-            for (i = 0; i < numDevs; ++i)
-            {
-                if (waveOutGetDevCaps(i, &WaveOutCaps, sizeof(WaveOutCaps)) == MMSYSERR_NOERROR)
-                {
-                    sprintf(szDeviceList, "%s", WaveOutCaps.szPname);
-                    szDeviceList += strlen(szDeviceList) + 1;
-                }
-            }
+/*
+    alxQueueFloat, alxQueueBoolean
 
-            szDeviceList[0] = '\0';
-            value = alx::DeviceList;
-        }
-        break;
+    Queue a set command without blocking; realtime safe. 'index' is -1
+    for parameters that are not indexed.
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxQueueFloat(ALXdevice *pMixer, ALXenum param, ALXint index, ALXfloat value)
+{
+    alx::Command command;
 
-    case ALX_CAPTURE_DEVICE_SPECIFIER:
-        if (pMixer)
-        {
-            if (pMixer->hWaveIn)
-                value = pMixer->szDeviceName;
-            else
-                alx::setError(ALX_INVALID_DEVICE);
-        }
-        else
-        {
-            szDeviceList = alx::CaptureDeviceList;
+    if (pMixer == NULL || pMixer->queue == NULL)
+        return ALX_FALSE;
+
+    command.param = param;
+    command.index = index;
+    command.isFloat = ALX_TRUE;
+    command.value = value;
+
+    return pMixer->queue->push(command) ? ALX_TRUE : ALX_FALSE;
+}
 
-            numDevs = waveInGetNumDevs();
-            for (i = 0; i < numDevs; ++i)
-            {
-                if (waveInGetDevCaps(i, &WaveInCaps, sizeof(WaveInCaps)) == MMSYSERR_NOERROR)
-                {
-                    sprintf(szDeviceList, "%s", WaveInCaps.szPname);
-                    szDeviceList += strlen(szDeviceList) + 1;
-                }
-            }
 
-            szDeviceList[0] = '\0';
-            value = alx::CaptureDeviceList;
-        }
-        break;
+ALXAPI ALXboolean ALXAPIENTRY alxQueueBoolean(ALXdevice *pMixer, ALXenum param, ALXint index, ALXboolean value)
+{
+    alx::Command command;
 
-    default:
-        alx::setError(ALX_INVALID_ENUM);
-        break;
-    }
+    if (pMixer == NULL || pMixer->queue == NULL)
+        return ALX_FALSE;
 
-    return value;
+    command.param = param;
+    command.index = index;
+    command.isFloat = ALX_FALSE;
+    command.value = value ? 1.0f : 0.0f;
+
+    return pMixer->queue->push(command) ? ALX_TRUE : ALX_FALSE;
 }
 
 
-ALXAPI ALXint ALXAPIENTRY alxGetInteger(ALXdevice *pMixer, ALXenum param)
+/*
+    alxProcessQueue
+
+    Apply every queued command, returning how many were applied, after
+    muting or unmuting the line for the noise gate if the pump asked
+*/
+ALXAPI ALXint ALXAPIENTRY alxProcessQueue(ALXdevice *pMixer)
 {
-    ALXint value = -1;
+    alx::Command command;
+    ALXint count = 0;
 
-    if (pMixer) {
-        switch (param)
-        {
-        case ALX_OUTPUT_VOLUME_SPECIFIER:
-            value = pMixer->getNumOutputVolumes();
-            break;
- 
-        case ALX_INPUT_SOURCE_SPECIFIER:
-            value = pMixer->getNumInputSources();
-            break;
- 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
+    if (pMixer == NULL) {
+        alx::setError(ALX_INVALID_DEVICE);
+        return 0;
+    }
+
+    if (pMixer->gate != NULL && alx::compareExchange(&pMixer->gateDue, 0, 1) == 1)
+        pMixer->muteGate();
+
+    if (pMixer->queue == NULL)
+        return 0;
+
+    pMixer->beginBatch();
+    while (pMixer->queue->pop(command)) {
+        if (command.isFloat) {
+            if (command.index < 0)
+                alxSetFloat(pMixer, command.param, command.value);
+            else
+                alxSetIndexedFloat(pMixer, command.param, command.index, command.value);
         }
+        else {
+            ALXboolean flag = command.value != 0.0f ? ALX_TRUE : ALX_FALSE;
+            if (command.index < 0)
+                alxSetBoolean(pMixer, command.param, flag);
+            else
+                alxSetIndexedBoolean(pMixer, command.param, command.index, flag);
+        }
+        ++count;
     }
-    else {
+    pMixer->endBatch();
+
+    return count;
+}
+
+
+/*
+    alxGetPollDescriptors
+
+    Notifications are posted to the calling thread from now on.
+*/
+ALXAPI ALXint ALXAPIENTRY alxGetPollDescriptors(ALXdevice *pMixer, ALXpollfd *fds, ALXint count)
+{
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return 0;
     }
 
-    return value;
+    if (count < 0 || (count > 0 && fds == NULL)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return 0;
+    }
+
+    if (!pMixer->startNotifications()) {
+        alx::setError(ALX_INVALID_OPERATION);
+        return 0;
+    }
+
+    if (count > 0) {
+        fds[0].fd = -1;
+        fds[0].handle = NULL;
+        fds[0].events = ALX_POLL_MESSAGES;
+    }
+
+    return 1;
 }
 
 
-ALXAPI void ALXAPIENTRY alxSetInteger(ALXdevice *pMixer, ALXenum param, ALXint value)
+/*
+    alxProcessEvents
+
+    Handle the notifications the thread has not dispatched yet, then
+    the command queue.
+*/
+ALXAPI ALXint ALXAPIENTRY alxProcessEvents(ALXdevice *pMixer)
 {
-    if (pMixer) {
-        switch (param)
-        {
-        case ALX_INPUT_SOURCE:
-            pMixer->setCurrentInputSource(value);
-            break;
- 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
-    }
-    else {
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return 0;
     }
+
+    pMixer->applyListenerGain();
+    pMixer->flushBuses();
+    return pMixer->processEvents() + alxProcessQueue(pMixer);
 }
 
 
-ALXAPI const ALXchar * ALXAPIENTRY alxGetIndexedString(ALXdevice *pMixer, ALXenum param, ALXint index)
+/*
+    alxGenBus
+
+    Create a bus under 'parent', 0 being the root bus, and return its
+    id, or 0 on failure
+*/
+ALXAPI ALXint ALXAPIENTRY alxGenBus(ALXdevice *pMixer, ALXint parent)
 {
-    const ALXchar *value = NULL;
+    alx::Bus *bus;
+    ALXint id;
 
-    if (pMixer) {
-        switch (param)
-        {
-        case ALX_OUTPUT_VOLUME_SPECIFIER:
-            value = pMixer->getOutputVolumeName(index);
-            break;
- 
-        case ALX_INPUT_SOURCE_SPECIFIER:
-            value = pMixer->getInputSourceName(index);
-            break;
- 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
-    }
-    else {
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return 0;
     }
 
-    return value;
+    if (pMixer->busGraph() == NULL) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return 0;
+    }
+
+    if ((bus = pMixer->buses->find(parent)) == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return 0;
+    }
+
+    if ((id = pMixer->buses->add(bus)) == 0)
+        alx::setError(ALX_OUT_OF_MEMORY);
+    return id;
 }
 
 
-ALXAPI ALXfloat ALX_APIENTRY alxGetIndexedFloat(ALXdevice *pMixer, ALXenum param, ALXint index)
+/*
+    alxDeleteBus
+
+    Delete a bus, moving its buses and sources to its parent
+*/
+ALXAPI void ALXAPIENTRY alxDeleteBus(ALXdevice *pMixer, ALXint id)
 {
-    ALXfloat value = -1.0f;
+    alx::Bus *bus;
 
-    if (pMixer) {
-        switch (param)
-        {
-        case ALX_OUTPUT_VOLUME:
-            value = pMixer->getOutputVolume(index);
-            break;
- 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
-    }
-    else {
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return;
     }
 
-    return value;
+    if (id == 0 || (bus = pMixer->findBus(id)) == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    pMixer->buses->remove(bus);
+    pMixer->flushBuses();
 }
 
 
-ALXAPI ALXboolean ALXAPIENTRY alxGetIndexedBoolean(ALXdevice *pMixer, ALXenum param, ALXint index)
+/*
+    alxAttachSource
+
+    Put a source of the current context on a bus. From then on ALx owns
+    its AL_GAIN.
+*/
+ALXAPI void ALXAPIENTRY alxAttachSource(ALXdevice *pMixer, ALXint id, ALXuint source)
 {
-    ALXboolean value = ALX_FALSE;
+    alx::Bus *bus;
 
-    if (pMixer) {
-        switch (param)
-        {
-        case ALX_OUTPUT_VOLUME:
-            value = pMixer->isDisabledOutputVolume(index);
-            break;
+    if (pMixer == NULL) {
+        alx::setError(ALX_INVALID_DEVICE);
+        return;
+    }
 
-        case ALX_INPUT_SOURCE:
-            value = pMixer->isDisabledInputVolume(index);
-            break;
+    if (alcGetCurrentContext() == NULL) {
+        alx::setError(ALX_INVALID_OPERATION);
+        return;
+    }
 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
+    if ((bus = pMixer->findBus(id, true)) == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return;
     }
-    else {
+
+    if (!pMixer->buses->attach(bus, source)) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return;
+    }
+    pMixer->flushBuses();
+}
+
+
+/*
+    alxDetachSource
+
+    Take a source of the current context off its bus, leaving its gain
+    as it is
+*/
+ALXAPI void ALXAPIENTRY alxDetachSource(ALXdevice *pMixer, ALXuint source)
+{
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return;
     }
 
-    return value;
+    if (pMixer->buses == NULL || !pMixer->buses->detach(source))
+        alx::setError(ALX_INVALID_VALUE);
 }
 
 
-ALXAPI void ALXAPIENTRY alxSetIndexedFloat(ALXdevice *pMixer, ALXenum param, ALXint index, ALXfloat value)
+/*
+    alxSetCaptureTap
+
+    Set the tap of a device from alxMapCaptureDevice, 0 frames to
+    remove it
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxSetCaptureTap(ALXdevice *pMixer, ALXenum format, ALXint frames, ALXint window)
 {
-    if (pMixer) {
-        switch (param)
-        {
-        case ALX_OUTPUT_VOLUME:
-            pMixer->setOutputVolume(index, value);
-            break;
+    if (pMixer == NULL) {
+        alx::setError(ALX_INVALID_DEVICE);
+        return ALX_FALSE;
+    }
 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
+    if (pMixer->alcCaptureDevice == NULL) {
+        alx::setError(ALX_INVALID_OPERATION);
+        return ALX_FALSE;
     }
-    else {
+
+    if (alx::CaptureTap::frameSize(format) == 0) {
+        alx::setError(ALX_INVALID_ENUM);
+        return ALX_FALSE;
+    }
+
+    if (frames > 0 && (window <= 0 || window > frames)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    if (!pMixer->setCaptureTap(format, frames, window)) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return ALX_FALSE;
+    }
+    return ALX_TRUE;
+}
+
+
+/*
+    alxPumpCaptureTap
+
+    Move the captured frames into the tap, returning how many
+*/
+ALXAPI ALXint ALXAPIENTRY alxPumpCaptureTap(ALXdevice *pMixer)
+{
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return 0;
+    }
+
+    if (pMixer->tap == NULL) {
+        alx::setError(ALX_INVALID_OPERATION);
+        return 0;
     }
+
+    return pMixer->pumpCaptureTap();
 }
 
 
-ALXAPI void ALXAPIENTRY alxSetIndexedBoolean(ALXdevice *pMixer, ALXenum param, ALXint index, ALXboolean value)
+/*
+    alxProcessTone
+
+    Software tone of the device over the application's blocks; without
+    a tone filter every level is flat, so there is nothing to do
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxProcessTone(ALXdevice *pMixer, ALXenum type, ALXint channels, ALXint rate,
+                                             void *samples, ALXint frames)
 {
-    if (pMixer) {
-        switch (param)
-        {
-        case ALX_OUTPUT_VOLUME:
-            pMixer->disableOutputVolume(index, value);
-            break;
+    alx::ToneFilter *tone;
 
-        default:
-            alx::setError(ALX_INVALID_ENUM);
-            break;
-        }
+    if (pMixer == NULL) {
+        alx::setError(ALX_INVALID_DEVICE);
+        return ALX_FALSE;
     }
-    else {
+
+    if (type != ALX_SAMPLE_INT16 && type != ALX_SAMPLE_FLOAT32) {
+        alx::setError(ALX_INVALID_ENUM);
+        return ALX_FALSE;
+    }
+
+    tone = pMixer->tone;
+    if (tone != NULL && !tone->process(type, channels, rate, samples, frames)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+    return ALX_TRUE;
+}
+
+
+/*
+    alxSetCaptureDucker
+
+    Link a ducker to the tap of a capture device, NULL to unlink it
+*/
+ALXAPI ALXboolean ALXAPIENTRY alxSetCaptureDucker(ALXdevice *pMixer, ALXducker *ducker)
+{
+    ALXenum type;
+    int channels;
+
+    if (pMixer == NULL) {
         alx::setError(ALX_INVALID_DEVICE);
+        return ALX_FALSE;
+    }
+
+    if (ducker != NULL && (pMixer->tap == NULL
+        || !alx::CaptureTap::sampleFormat(pMixer->tap->format(), type, channels))) {
+        alx::setError(ALX_INVALID_OPERATION);
+        return ALX_FALSE;
     }
+
+    if (pMixer->ducker)
+        alx::linkDucker(pMixer->ducker, NULL);
+    pMixer->ducker = ducker;
+    if (ducker)
+        alx::linkDucker(ducker, &pMixer->ducker);
+    return ALX_TRUE;
+}
+
+
+ALXAPI ALXuint ALXAPIENTRY alxGetCapturePosition(ALXdevice *pMixer)
+{
+    if (pMixer == NULL || pMixer->tap == NULL)
+        return 0;
+    return pMixer->tap->position();
 }
 
 
 /*
-    alxGetProcAddress
+    alxGetCaptureWindow
 
-    Retrieves the function address for a particular extension function
+    Readers call this from any thread; it sets no error, as a NULL
+    window is the normal answer to a reader that caught up
 */
-ALXAPI void * ALXAPIENTRY alxGetProcAddress(ALXdevice *device, const ALXchar *funcName)
+ALXAPI const void * ALXAPIENTRY alxGetCaptureWindow(ALXdevice *pMixer, ALXuint position, ALXint frames)
 {
-    int i = 0;
-    void *pFunction = NULL;
+    if (pMixer == NULL || pMixer->tap == NULL)
+        return NULL;
+    return pMixer->tap->window(position, frames);
+}
 
-    if (funcName)
-    {
-        while ((alx::Functions[i].funcName)&&(strcmp(alx::Functions[i].funcName,funcName)))
-            i++;
-        pFunction = alx::Functions[i].address;
+
+ALXAPI ALXboolean ALXAPIENTRY alxIsCaptureWindowValid(ALXdevice *pMixer, ALXuint position)
+{
+    if (pMixer == NULL || pMixer->tap == NULL)
+        return ALX_FALSE;
+    return pMixer->tap->valid(position) ? ALX_TRUE : ALX_FALSE;
+}
+
+
+/*
+    alxSetTopologyCache
+
+    Set the file used to cache the topology of opened devices
+*/
+ALXAPI void ALXAPIENTRY alxSetTopologyCache(const ALXchar *filename)
+{
+    if (filename == NULL) {
+        alx::CacheFile[0] = '\0';
     }
-    else
-    {
+    else if (strlen(filename) < sizeof(alx::CacheFile)) {
+        strcpy(alx::CacheFile, filename);
+    }
+    else {
         alx::setError(ALX_INVALID_VALUE);
     }
-
-    return pFunction;
 }
 
 
@@ -0,0 +1,2323 @@
+/*
+ * ALx
+ * Level analysis kernels
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+/*
+ * Per channel RMS, sample peak and true peak of interleaved blocks.
+ *
+ * Every measurement has a scalar reference and vector versions, picked
+ * at run time from what the processor supports. The vector versions
+ * walk the interleaved samples as they are: with V samples per vector
+ * and C channels, the pattern of channels repeats every lcm(V, C)
+ * samples, so that many accumulators per "period" keep each lane on a
+ * fixed channel, and they are folded into channels at the end.
+ *
+ * The loudness meter and the tone filter run each channel through
+ * biquads, which cannot be split over time, so their vectors hold
+ * neighbouring channels of a frame instead, in double precision like
+ * the reference.
+ */
+
+#define ALX_BUILD_LIBRARY
+
+#include <math.h>
+#include <string.h>
+#include <alx.h>
+
+#include "Levels.h"
+
+#include <emmintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#if _MSC_VER >= 1700
+#include <immintrin.h>
+#define ALX_HAVE_AVX2
+#endif
+#define ALX_TARGET_SSE2
+#define ALX_TARGET_AVX2
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define ALX_HAVE_AVX2
+#define ALX_TARGET_SSE2         __attribute__((target("sse2")))
+#define ALX_TARGET_AVX2         __attribute__((target("avx2")))
+#endif
+
+#define ALXAPI
+#define ALXAPIENTRY
+
+// lcm of 16 int16 lanes and ALX_MAX_LEVEL_CHANNELS
+#define ALX_LEVEL_MAX_PERIOD    512
+// periods summed in single precision before going to the double sums
+#define ALX_LEVEL_CHUNK         256
+#define ALX_TRUE_PEAK_TAPS      12
+#define ALX_TRUE_PEAK_BLOCK     1024
+// 0.1 LU bins from the absolute gate up
+#define ALX_LOUDNESS_BINS       1000
+#define ALX_LOUDNESS_GATE       -70.0
+// 100 ms steps in the short-term window
+#define ALX_LOUDNESS_STEPS      30
+// int16 frames converted at a time
+#define ALX_LOUDNESS_CHUNK      256
+// 10 ms steps of the ducker's detector
+#define ALX_DUCK_STEP_RATE      100
+// int16 frames ramped through floats at a time
+#define ALX_RAMP_CHUNK          64
+
+namespace alx {
+
+/*
+    A volume or bus gain of a device that a meter or ducker moves. Its
+    value is read when it is set; writes go through the command queue
+    if the device had one then.
+*/
+struct GainTarget
+{
+    ALXdevice  *mixer;
+    ALXenum     param;
+    ALXint      index;
+    bool        queued;
+    ALXfloat    value;
+    double      ceiling;        // dB
+};
+
+} // namespace alx
+
+/*
+    Loudness meter. The K-weighted energy of each 100 ms step is kept
+    for the last 3 s; every step ends a 400 ms block and a 3 s window,
+    whose loudness goes to the histograms integrated loudness and the
+    loudness range are gated from, so the meter never grows.
+*/
+struct ALXloudness_struct
+{
+    LPALXFREE   freeFunc;
+    void       *allocData;
+    ALXloudness *next;
+
+    ALXint      rate;
+    ALXint      channels;
+    double      coeffs[10];
+    double      weights[ALX_MAX_LEVEL_CHANNELS];
+    double      z[4 * ALX_MAX_LEVEL_CHANNELS];
+    double      energy[ALX_MAX_LEVEL_CHANNELS];
+
+    ALXint      stepFrames;
+    ALXint      stepDone;
+    ALXuint     stepCount;
+    double      steps[ALX_LOUDNESS_STEPS];
+    double      momentary;
+    double      shortTerm;
+    ALXuint     blocks[ALX_LOUDNESS_BINS];
+    ALXuint     windows[ALX_LOUDNESS_BINS];
+
+    // loudness target, when 'follow.mixer' is set
+    alx::GainTarget follow;
+    double      target;
+    double      slew;
+    double      gain;
+    double      written;
+
+    float       buffer[ALX_LOUDNESS_CHUNK * ALX_MAX_LEVEL_CHANNELS];
+};
+
+/*
+    Ducker. Every 10 ms step of captured frames is speech when it is
+    both above the threshold and well above the noise floor, which
+    drops to quiet steps at once and climbs back slowly. Speech pulls
+    the amount toward 1 over the attack time, and once it stops for
+    longer than the hold time the amount falls back over the release
+    time. Targets are written once per block, when they moved enough.
+*/
+struct ALXducker_struct
+{
+    LPALXFREE   freeFunc;
+    void       *allocData;
+    ALXducker  *next;
+
+    // the device field linking it to a tap, if any
+    ALXducker **capture;
+
+    ALXint      rate;
+    ALXint      stepFrames;
+    ALXint      stepDone;
+    double      energy;
+
+    double      threshold;      // dBFS
+    double      attack;         // ms
+    double      hold;
+    double      release;
+
+    double      floor;          // dBFS
+    double      amount;
+    double      holding;        // ms left
+
+    ALXint      targetCount;
+    alx::GainTarget targets[ALX_MAX_DUCK_TARGETS];
+    double      depths[ALX_MAX_DUCK_TARGETS];   // dB
+    double      written[ALX_MAX_DUCK_TARGETS];  // dB
+};
+
+namespace alx {
+
+struct EnvelopePoint
+{
+    ALXuint     position;
+    ALXfloat    gain;
+};
+
+} // namespace alx
+
+/*
+    Gain envelope. Points wait in a ring, in the order of their
+    positions on the clock, until a block reaches them; the last one
+    passed is kept, for the gain to move from it toward the next.
+*/
+struct ALXenvelope_struct
+{
+    LPALXFREE   freeFunc;
+    void       *allocData;
+    ALXenvelope *next;
+
+    ALXint      capacity;
+    ALXint      first;
+    ALXint      count;
+    alx::EnvelopePoint *points;
+
+    bool        passed;
+    alx::EnvelopePoint last;
+    double      gain;           // where the clock was last
+
+    // hardware control, when 'target.mixer' is set
+    alx::GainTarget target;
+    double      written;        // dB
+};
+
+namespace alx {
+
+/*
+    4x oversampling polyphase FIR of ITU-R BS.1770-4, annex 2. Phase p
+    of output n is the sum over k of TruePeakTaps[p][k] x[n - k].
+*/
+static const float TruePeakTaps[4][ALX_TRUE_PEAK_TAPS] = {
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f,
+      -0.0594482421875f,  0.1373291015625f,  0.9721679687500f, -0.1022949218750f,
+       0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f,
+      -0.1665039062500f,  0.4650878906250f,  0.7797851562500f, -0.2003173828125f,
+       0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f,
+      -0.2003173828125f,  0.7797851562500f,  0.4650878906250f, -0.1665039062500f,
+       0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f,
+      -0.1022949218750f,  0.9721679687500f,  0.1373291015625f, -0.0594482421875f,
+       0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }
+};
+
+/*
+    sumFloat and sumInt16 add the squares of 'periods' periods of
+    'period' samples to 'sums', and keep the largest magnitudes in
+    'peaks', both by position in the period. 'period' is a multiple of
+    'lanes' for floats and of 'lanes16' for int16 samples. truePeak
+    returns the largest magnitude of the oversampled 'count' samples at
+    'x', reading the ALX_TRUE_PEAK_TAPS - 1 samples before 'x' too.
+    kWeight filters 'frames' frames of the 'lanesDouble' channels from
+    'first' on of interleaved 'x' through the two biquads of 'coeffs'
+    (b0 b1 b2 a1 a2 each), whose state is z[stage][channel], and adds
+    the squares of the output to 'energy'. biquads runs the same
+    channels through 'stages' biquads of 'coeffs' in place, a stage at
+    a time, with state z[2 * stage + k][channel]. scale multiplies
+    position i of period p of 'periods' periods of 'period' floats by
+    from + step * (frames[i] + advance * p): a ramp over frame numbers,
+    which stay whole so that every instruction set rounds alike.
+    'period' is a multiple of 'lanes'.
+*/
+struct LevelKernels
+{
+    ALXenum     isa;
+    int         lanes;
+    int         lanes16;
+    void      (*sumFloat)(const float *x, int periods, int period, double *sums, float *peaks);
+    void      (*sumInt16)(const short *x, int periods, int period, double *sums, float *peaks);
+    float     (*truePeak)(const float *x, int count);
+    int         lanesDouble;
+    void      (*kWeight)(const double *coeffs, double *z, const float *x, int frames,
+                         int channels, int first, double *energy);
+    void      (*biquads)(const double *coeffs, int stages, double *z, float *x, int frames,
+                         int channels, int first);
+    void      (*scale)(float *x, int periods, int period, const float *frames, float advance,
+                       float from, float step);
+};
+
+///////////////////////////////////////////////////////
+// Scalar reference
+
+static void sumFloatScalar(const float *x, int periods, int period, double *sums, float *peaks)
+{
+    float v;
+    int p, i;
+
+    for (p = 0; p < periods; ++p, x += period) {
+        for (i = 0; i < period; ++i) {
+            v = x[i];
+            sums[i] += (double) (v * v);
+            v = fabsf(v);
+            if (v > peaks[i])
+                peaks[i] = v;
+        }
+    }
+}
+
+static void sumInt16Scalar(const short *x, int periods, int period, double *sums, float *peaks)
+{
+    float v;
+    int p, i;
+
+    for (p = 0; p < periods; ++p, x += period) {
+        for (i = 0; i < period; ++i) {
+            v = x[i] * (1.0f / 32768.0f);
+            sums[i] += (double) (v * v);
+            v = fabsf(v);
+            if (v > peaks[i])
+                peaks[i] = v;
+        }
+    }
+}
+
+static float truePeakScalar(const float *x, int count)
+{
+    float peak = 0.0f, y;
+    int n, p, k;
+
+    for (n = 0; n < count; ++n) {
+        for (p = 0; p < 4; ++p) {
+            y = 0.0f;
+            for (k = 0; k < ALX_TRUE_PEAK_TAPS; ++k)
+                y += TruePeakTaps[p][k] * x[n - k];
+            y = fabsf(y);
+            if (y > peak)
+                peak = y;
+        }
+    }
+    return peak;
+}
+
+static void kWeightScalar(const double *k, double *z, const float *x, int frames,
+                          int channels, int first, double *energy)
+{
+    double s0 = z[first], s1 = z[ALX_MAX_LEVEL_CHANNELS + first];
+    double s2 = z[2 * ALX_MAX_LEVEL_CHANNELS + first], s3 = z[3 * ALX_MAX_LEVEL_CHANNELS + first];
+    double acc = 0.0, v, y;
+    int n;
+
+    for (n = 0, x += first; n < frames; ++n, x += channels) {
+        v = *x;
+        y = k[0] * v + s0;
+        s0 = k[1] * v - k[3] * y + s1;
+        s1 = k[2] * v - k[4] * y;
+        v = y;
+        y = k[5] * v + s2;
+        s2 = k[6] * v - k[8] * y + s3;
+        s3 = k[7] * v - k[9] * y;
+        acc += y * y;
+    }
+
+    z[first] = s0;
+    z[ALX_MAX_LEVEL_CHANNELS + first] = s1;
+    z[2 * ALX_MAX_LEVEL_CHANNELS + first] = s2;
+    z[3 * ALX_MAX_LEVEL_CHANNELS + first] = s3;
+    energy[first] += acc;
+}
+
+static void biquadsScalar(const double *k, int stages, double *z, float *x, int frames,
+                          int channels, int first)
+{
+    double s0, s1, v, y;
+    float *p;
+    int s, n;
+
+    for (s = 0; s < stages; ++s, k += 5, z += 2 * ALX_MAX_LEVEL_CHANNELS) {
+        s0 = z[first];
+        s1 = z[ALX_MAX_LEVEL_CHANNELS + first];
+        for (n = 0, p = x + first; n < frames; ++n, p += channels) {
+            v = *p;
+            y = k[0] * v + s0;
+            s0 = k[1] * v - k[3] * y + s1;
+            s1 = k[2] * v - k[4] * y;
+            *p = (float) y;
+        }
+        z[first] = s0;
+        z[ALX_MAX_LEVEL_CHANNELS + first] = s1;
+    }
+}
+
+static void scaleScalar(float *x, int periods, int period, const float *frames, float advance,
+                        float from, float step)
+{
+    float offset;
+    int p, i;
+
+    for (p = 0; p < periods; ++p, x += period) {
+        offset = advance * (float) p;
+        for (i = 0; i < period; ++i)
+            x[i] *= from + step * (frames[i] + offset);
+    }
+}
+
+///////////////////////////////////////////////////////
+// SSE2
+
+ALX_TARGET_SSE2
+static void sumFloatSSE2(const float *x, int periods, int period, double *sums, float *peaks)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 acc[ALX_LEVEL_MAX_PERIOD / 4], peak[ALX_LEVEL_MAX_PERIOD / 4], v;
+    float partial[4];
+    int n = period / 4, chunk, c, i, j;
+
+    for (i = 0; i < n; ++i)
+        peak[i] = _mm_loadu_ps(peaks + 4 * i);
+
+    for (; periods > 0; periods -= chunk) {
+        chunk = periods < ALX_LEVEL_CHUNK ? periods : ALX_LEVEL_CHUNK;
+        for (i = 0; i < n; ++i)
+            acc[i] = _mm_setzero_ps();
+
+        for (c = 0; c < chunk; ++c, x += period) {
+            for (i = 0; i < n; ++i) {
+                v = _mm_loadu_ps(x + 4 * i);
+                acc[i] = _mm_add_ps(acc[i], _mm_mul_ps(v, v));
+                peak[i] = _mm_max_ps(peak[i], _mm_and_ps(v, absMask));
+            }
+        }
+
+        for (i = 0; i < n; ++i) {
+            _mm_storeu_ps(partial, acc[i]);
+            for (j = 0; j < 4; ++j)
+                sums[4 * i + j] += partial[j];
+        }
+    }
+
+    for (i = 0; i < n; ++i)
+        _mm_storeu_ps(peaks + 4 * i, peak[i]);
+}
+
+ALX_TARGET_SSE2
+static void sumInt16SSE2(const short *x, int periods, int period, double *sums, float *peaks)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    __m128 acc[ALX_LEVEL_MAX_PERIOD / 4], peak[ALX_LEVEL_MAX_PERIOD / 4], lo, hi;
+    __m128i s;
+    float partial[4];
+    int n = period / 4, chunk, c, i, j;
+
+    for (i = 0; i < n; ++i)
+        peak[i] = _mm_loadu_ps(peaks + 4 * i);
+
+    for (; periods > 0; periods -= chunk) {
+        chunk = periods < ALX_LEVEL_CHUNK ? periods : ALX_LEVEL_CHUNK;
+        for (i = 0; i < n; ++i)
+            acc[i] = _mm_setzero_ps();
+
+        for (c = 0; c < chunk; ++c, x += period) {
+            for (i = 0; i < n; i += 2) {
+                s = _mm_loadu_si128((const __m128i *) (x + 4 * i));
+                lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16)), scale);
+                hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16)), scale);
+                acc[i] = _mm_add_ps(acc[i], _mm_mul_ps(lo, lo));
+                acc[i + 1] = _mm_add_ps(acc[i + 1], _mm_mul_ps(hi, hi));
+                peak[i] = _mm_max_ps(peak[i], _mm_and_ps(lo, absMask));
+                peak[i + 1] = _mm_max_ps(peak[i + 1], _mm_and_ps(hi, absMask));
+            }
+        }
+
+        for (i = 0; i < n; ++i) {
+            _mm_storeu_ps(partial, acc[i]);
+            for (j = 0; j < 4; ++j)
+                sums[4 * i + j] += partial[j];
+        }
+    }
+
+    for (i = 0; i < n; ++i)
+        _mm_storeu_ps(peaks + 4 * i, peak[i]);
+}
+
+/*
+    Four outputs of one phase per vector, summed in the order of the
+    scalar reference, so both give the same result.
+*/
+ALX_TARGET_SSE2
+static float truePeakSSE2(const float *x, int count)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 taps[4][ALX_TRUE_PEAK_TAPS], peak = _mm_setzero_ps(), y;
+    float lanes[4], result, tail;
+    int n, p, k;
+
+    for (p = 0; p < 4; ++p) {
+        for (k = 0; k < ALX_TRUE_PEAK_TAPS; ++k)
+            taps[p][k] = _mm_set1_ps(TruePeakTaps[p][k]);
+    }
+
+    for (n = 0; n + 4 <= count; n += 4) {
+        for (p = 0; p < 4; ++p) {
+            y = _mm_setzero_ps();
+            for (k = 0; k < ALX_TRUE_PEAK_TAPS; ++k)
+                y = _mm_add_ps(y, _mm_mul_ps(taps[p][k], _mm_loadu_ps(x + n - k)));
+            peak = _mm_max_ps(peak, _mm_and_ps(y, absMask));
+        }
+    }
+
+    _mm_storeu_ps(lanes, peak);
+    result = lanes[0];
+    for (k = 1; k < 4; ++k) {
+        if (lanes[k] > result)
+            result = lanes[k];
+    }
+
+    tail = truePeakScalar(x + n, count - n);
+    return tail > result ? tail : result;
+}
+
+// two channels per vector, loaded as one 64 bit value
+ALX_TARGET_SSE2
+static void kWeightSSE2(const double *k, double *z, const float *x, int frames,
+                        int channels, int first, double *energy)
+{
+    __m128d b0 = _mm_set1_pd(k[0]), b1 = _mm_set1_pd(k[1]), b2 = _mm_set1_pd(k[2]);
+    __m128d a1 = _mm_set1_pd(k[3]), a2 = _mm_set1_pd(k[4]);
+    __m128d c0 = _mm_set1_pd(k[5]), c1 = _mm_set1_pd(k[6]), c2 = _mm_set1_pd(k[7]);
+    __m128d d1 = _mm_set1_pd(k[8]), d2 = _mm_set1_pd(k[9]);
+    __m128d s0 = _mm_loadu_pd(z + first);
+    __m128d s1 = _mm_loadu_pd(z + ALX_MAX_LEVEL_CHANNELS + first);
+    __m128d s2 = _mm_loadu_pd(z + 2 * ALX_MAX_LEVEL_CHANNELS + first);
+    __m128d s3 = _mm_loadu_pd(z + 3 * ALX_MAX_LEVEL_CHANNELS + first);
+    __m128d acc = _mm_setzero_pd(), v, y;
+    int n;
+
+    for (n = 0, x += first; n < frames; ++n, x += channels) {
+        v = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *) x)));
+        y = _mm_add_pd(_mm_mul_pd(b0, v), s0);
+        s0 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1, v), _mm_mul_pd(a1, y)), s1);
+        s1 = _mm_sub_pd(_mm_mul_pd(b2, v), _mm_mul_pd(a2, y));
+        v = y;
+        y = _mm_add_pd(_mm_mul_pd(c0, v), s2);
+        s2 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(c1, v), _mm_mul_pd(d1, y)), s3);
+        s3 = _mm_sub_pd(_mm_mul_pd(c2, v), _mm_mul_pd(d2, y));
+        acc = _mm_add_pd(acc, _mm_mul_pd(y, y));
+    }
+
+    _mm_storeu_pd(z + first, s0);
+    _mm_storeu_pd(z + ALX_MAX_LEVEL_CHANNELS + first, s1);
+    _mm_storeu_pd(z + 2 * ALX_MAX_LEVEL_CHANNELS + first, s2);
+    _mm_storeu_pd(z + 3 * ALX_MAX_LEVEL_CHANNELS + first, s3);
+    _mm_storeu_pd(energy + first, _mm_add_pd(_mm_loadu_pd(energy + first), acc));
+}
+
+ALX_TARGET_SSE2
+static void biquadsSSE2(const double *k, int stages, double *z, float *x, int frames,
+                        int channels, int first)
+{
+    __m128d b0, b1, b2, a1, a2, s0, s1, v, y;
+    float *p;
+    int s, n;
+
+    for (s = 0; s < stages; ++s, k += 5, z += 2 * ALX_MAX_LEVEL_CHANNELS) {
+        b0 = _mm_set1_pd(k[0]);
+        b1 = _mm_set1_pd(k[1]);
+        b2 = _mm_set1_pd(k[2]);
+        a1 = _mm_set1_pd(k[3]);
+        a2 = _mm_set1_pd(k[4]);
+        s0 = _mm_loadu_pd(z + first);
+        s1 = _mm_loadu_pd(z + ALX_MAX_LEVEL_CHANNELS + first);
+        for (n = 0, p = x + first; n < frames; ++n, p += channels) {
+            v = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *) p)));
+            y = _mm_add_pd(_mm_mul_pd(b0, v), s0);
+            s0 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(b1, v), _mm_mul_pd(a1, y)), s1);
+            s1 = _mm_sub_pd(_mm_mul_pd(b2, v), _mm_mul_pd(a2, y));
+            _mm_storel_epi64((__m128i *) p, _mm_castps_si128(_mm_cvtpd_ps(y)));
+        }
+        _mm_storeu_pd(z + first, s0);
+        _mm_storeu_pd(z + ALX_MAX_LEVEL_CHANNELS + first, s1);
+    }
+}
+
+ALX_TARGET_SSE2
+static void scaleSSE2(float *x, int periods, int period, const float *frames, float advance,
+                      float from, float step)
+{
+    __m128 base = _mm_set1_ps(from), slope = _mm_set1_ps(step), offset, g;
+    int p, i;
+
+    for (p = 0; p < periods; ++p, x += period) {
+        offset = _mm_set1_ps(advance * (float) p);
+        for (i = 0; i < period; i += 4) {
+            g = _mm_add_ps(base, _mm_mul_ps(slope, _mm_add_ps(_mm_loadu_ps(frames + i), offset)));
+            _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), g));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////
+// AVX2
+
+#if defined(ALX_HAVE_AVX2)
+
+ALX_TARGET_AVX2
+static void sumFloatAVX2(const float *x, int periods, int period, double *sums, float *peaks)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 acc[ALX_LEVEL_MAX_PERIOD / 8], peak[ALX_LEVEL_MAX_PERIOD / 8], v;
+    float partial[8];
+    int n = period / 8, chunk, c, i, j;
+
+    for (i = 0; i < n; ++i)
+        peak[i] = _mm256_loadu_ps(peaks + 8 * i);
+
+    for (; periods > 0; periods -= chunk) {
+        chunk = periods < ALX_LEVEL_CHUNK ? periods : ALX_LEVEL_CHUNK;
+        for (i = 0; i < n; ++i)
+            acc[i] = _mm256_setzero_ps();
+
+        for (c = 0; c < chunk; ++c, x += period) {
+            for (i = 0; i < n; ++i) {
+                v = _mm256_loadu_ps(x + 8 * i);
+                acc[i] = _mm256_add_ps(acc[i], _mm256_mul_ps(v, v));
+                peak[i] = _mm256_max_ps(peak[i], _mm256_and_ps(v, absMask));
+            }
+        }
+
+        for (i = 0; i < n; ++i) {
+            _mm256_storeu_ps(partial, acc[i]);
+            for (j = 0; j < 8; ++j)
+                sums[8 * i + j] += partial[j];
+        }
+    }
+
+    for (i = 0; i < n; ++i)
+        _mm256_storeu_ps(peaks + 8 * i, peak[i]);
+}
+
+ALX_TARGET_AVX2
+static void sumInt16AVX2(const short *x, int periods, int period, double *sums, float *peaks)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    __m256 acc[ALX_LEVEL_MAX_PERIOD / 8], peak[ALX_LEVEL_MAX_PERIOD / 8], lo, hi;
+    __m256i s;
+    float partial[8];
+    int n = period / 8, chunk, c, i, j;
+
+    for (i = 0; i < n; ++i)
+        peak[i] = _mm256_loadu_ps(peaks + 8 * i);
+
+    for (; periods > 0; periods -= chunk) {
+        chunk = periods < ALX_LEVEL_CHUNK ? periods : ALX_LEVEL_CHUNK;
+        for (i = 0; i < n; ++i)
+            acc[i] = _mm256_setzero_ps();
+
+        for (c = 0; c < chunk; ++c, x += period) {
+            for (i = 0; i < n; i += 2) {
+                s = _mm256_loadu_si256((const __m256i *) (x + 8 * i));
+                lo = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(s))), scale);
+                hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(s, 1))), scale);
+                acc[i] = _mm256_add_ps(acc[i], _mm256_mul_ps(lo, lo));
+                acc[i + 1] = _mm256_add_ps(acc[i + 1], _mm256_mul_ps(hi, hi));
+                peak[i] = _mm256_max_ps(peak[i], _mm256_and_ps(lo, absMask));
+                peak[i + 1] = _mm256_max_ps(peak[i + 1], _mm256_and_ps(hi, absMask));
+            }
+        }
+
+        for (i = 0; i < n; ++i) {
+            _mm256_storeu_ps(partial, acc[i]);
+            for (j = 0; j < 8; ++j)
+                sums[8 * i + j] += partial[j];
+        }
+    }
+
+    for (i = 0; i < n; ++i)
+        _mm256_storeu_ps(peaks + 8 * i, peak[i]);
+}
+
+ALX_TARGET_AVX2
+static float truePeakAVX2(const float *x, int count)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 taps[4][ALX_TRUE_PEAK_TAPS], peak = _mm256_setzero_ps(), y;
+    float lanes[8], result, tail;
+    int n, p, k;
+
+    for (p = 0; p < 4; ++p) {
+        for (k = 0; k < ALX_TRUE_PEAK_TAPS; ++k)
+            taps[p][k] = _mm256_set1_ps(TruePeakTaps[p][k]);
+    }
+
+    for (n = 0; n + 8 <= count; n += 8) {
+        for (p = 0; p < 4; ++p) {
+            y = _mm256_setzero_ps();
+            for (k = 0; k < ALX_TRUE_PEAK_TAPS; ++k)
+                y = _mm256_add_ps(y, _mm256_mul_ps(taps[p][k], _mm256_loadu_ps(x + n - k)));
+            peak = _mm256_max_ps(peak, _mm256_and_ps(y, absMask));
+        }
+    }
+
+    _mm256_storeu_ps(lanes, peak);
+    result = lanes[0];
+    for (k = 1; k < 8; ++k) {
+        if (lanes[k] > result)
+            result = lanes[k];
+    }
+
+    tail = truePeakScalar(x + n, count - n);
+    return tail > result ? tail : result;
+}
+
+// four channels per vector
+ALX_TARGET_AVX2
+static void kWeightAVX2(const double *k, double *z, const float *x, int frames,
+                        int channels, int first, double *energy)
+{
+    __m256d b0 = _mm256_set1_pd(k[0]), b1 = _mm256_set1_pd(k[1]), b2 = _mm256_set1_pd(k[2]);
+    __m256d a1 = _mm256_set1_pd(k[3]), a2 = _mm256_set1_pd(k[4]);
+    __m256d c0 = _mm256_set1_pd(k[5]), c1 = _mm256_set1_pd(k[6]), c2 = _mm256_set1_pd(k[7]);
+    __m256d d1 = _mm256_set1_pd(k[8]), d2 = _mm256_set1_pd(k[9]);
+    __m256d s0 = _mm256_loadu_pd(z + first);
+    __m256d s1 = _mm256_loadu_pd(z + ALX_MAX_LEVEL_CHANNELS + first);
+    __m256d s2 = _mm256_loadu_pd(z + 2 * ALX_MAX_LEVEL_CHANNELS + first);
+    __m256d s3 = _mm256_loadu_pd(z + 3 * ALX_MAX_LEVEL_CHANNELS + first);
+    __m256d acc = _mm256_setzero_pd(), v, y;
+    int n;
+
+    for (n = 0, x += first; n < frames; ++n, x += channels) {
+        v = _mm256_cvtps_pd(_mm_loadu_ps(x));
+        y = _mm256_add_pd(_mm256_mul_pd(b0, v), s0);
+        s0 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1, v), _mm256_mul_pd(a1, y)), s1);
+        s1 = _mm256_sub_pd(_mm256_mul_pd(b2, v), _mm256_mul_pd(a2, y));
+        v = y;
+        y = _mm256_add_pd(_mm256_mul_pd(c0, v), s2);
+        s2 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(c1, v), _mm256_mul_pd(d1, y)), s3);
+        s3 = _mm256_sub_pd(_mm256_mul_pd(c2, v), _mm256_mul_pd(d2, y));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(y, y));
+    }
+
+    _mm256_storeu_pd(z + first, s0);
+    _mm256_storeu_pd(z + ALX_MAX_LEVEL_CHANNELS + first, s1);
+    _mm256_storeu_pd(z + 2 * ALX_MAX_LEVEL_CHANNELS + first, s2);
+    _mm256_storeu_pd(z + 3 * ALX_MAX_LEVEL_CHANNELS + first, s3);
+    _mm256_storeu_pd(energy + first, _mm256_add_pd(_mm256_loadu_pd(energy + first), acc));
+}
+
+ALX_TARGET_AVX2
+static void biquadsAVX2(const double *k, int stages, double *z, float *x, int frames,
+                        int channels, int first)
+{
+    __m256d b0, b1, b2, a1, a2, s0, s1, v, y;
+    float *p;
+    int s, n;
+
+    for (s = 0; s < stages; ++s, k += 5, z += 2 * ALX_MAX_LEVEL_CHANNELS) {
+        b0 = _mm256_set1_pd(k[0]);
+        b1 = _mm256_set1_pd(k[1]);
+        b2 = _mm256_set1_pd(k[2]);
+        a1 = _mm256_set1_pd(k[3]);
+        a2 = _mm256_set1_pd(k[4]);
+        s0 = _mm256_loadu_pd(z + first);
+        s1 = _mm256_loadu_pd(z + ALX_MAX_LEVEL_CHANNELS + first);
+        for (n = 0, p = x + first; n < frames; ++n, p += channels) {
+            v = _mm256_cvtps_pd(_mm_loadu_ps(p));
+            y = _mm256_add_pd(_mm256_mul_pd(b0, v), s0);
+            s0 = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(b1, v), _mm256_mul_pd(a1, y)), s1);
+            s1 = _mm256_sub_pd(_mm256_mul_pd(b2, v), _mm256_mul_pd(a2, y));
+            _mm_storeu_ps(p, _mm256_cvtpd_ps(y));
+        }
+        _mm256_storeu_pd(z + first, s0);
+        _mm256_storeu_pd(z + ALX_MAX_LEVEL_CHANNELS + first, s1);
+    }
+}
+
+ALX_TARGET_AVX2
+static void scaleAVX2(float *x, int periods, int period, const float *frames, float advance,
+                      float from, float step)
+{
+    __m256 base = _mm256_set1_ps(from), slope = _mm256_set1_ps(step), offset, g;
+    int p, i;
+
+    for (p = 0; p < periods; ++p, x += period) {
+        offset = _mm256_set1_ps(advance * (float) p);
+        for (i = 0; i < period; i += 8) {
+            g = _mm256_add_ps(base, _mm256_mul_ps(slope, _mm256_add_ps(_mm256_loadu_ps(frames + i), offset)));
+            _mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), g));
+        }
+    }
+}
+
+#endif // ALX_HAVE_AVX2
+
+///////////////////////////////////////////////////////
+// Dispatch
+
+// from the least to the most capable
+static const LevelKernels Kernels[] = {
+    { ALX_ISA_SCALAR, 1, 1, sumFloatScalar, sumInt16Scalar, truePeakScalar, 1, kWeightScalar, biquadsScalar, scaleScalar },
+    { ALX_ISA_SSE2, 4, 8, sumFloatSSE2, sumInt16SSE2, truePeakSSE2, 2, kWeightSSE2, biquadsSSE2, scaleSSE2 },
+#if defined(ALX_HAVE_AVX2)
+    { ALX_ISA_AVX2, 8, 16, sumFloatAVX2, sumInt16AVX2, truePeakAVX2, 4, kWeightAVX2, biquadsAVX2, scaleAVX2 },
+#endif
+};
+
+static const LevelKernels * volatile Current = NULL;
+
+static void cpuid(int leaf, int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, 0);
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static bool supported(ALXenum isa)
+{
+    int regs[4];
+
+    switch (isa) {
+    case ALX_ISA_SCALAR:
+        return true;
+
+    case ALX_ISA_SSE2:
+        cpuid(1, regs);
+        return (regs[3] & (1 << 26)) != 0;
+
+#if defined(ALX_HAVE_AVX2)
+    case ALX_ISA_AVX2:
+        cpuid(0, regs);
+        if (regs[0] < 7)
+            return false;
+
+        // AVX, and the system saving the ymm registers
+        cpuid(1, regs);
+        if ((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0)
+            return false;
+#if defined(_MSC_VER)
+        if ((_xgetbv(0) & 6) != 6)
+            return false;
+#else
+        {
+            unsigned int eax, edx;
+            __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+            if ((eax & 6) != 6)
+                return false;
+        }
+#endif
+
+        cpuid(7, regs);
+        return (regs[1] & (1 << 5)) != 0;
+#endif
+
+    default:
+        return false;
+    }
+}
+
+static const LevelKernels *kernels()
+{
+    int i;
+
+    if (Current == NULL) {
+        for (i = sizeof(Kernels) / sizeof(Kernels[0]) - 1; i > 0; --i) {
+            if (supported(Kernels[i].isa))
+                break;
+        }
+        Current = &Kernels[i];
+    }
+    return Current;
+}
+
+ALXenum levelISA()
+{
+    return kernels()->isa;
+}
+
+bool setLevelISA(ALXenum isa)
+{
+    int i;
+
+    for (i = 0; i < (int) (sizeof(Kernels) / sizeof(Kernels[0])); ++i) {
+        if (Kernels[i].isa == isa && supported(isa)) {
+            Current = &Kernels[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////
+// Measurements
+
+static int lcm(int a, int b)
+{
+    int x = a, y = b, t;
+
+    while (y != 0) {
+        t = x % y;
+        x = y;
+        y = t;
+    }
+    return a / x * b;
+}
+
+static float sample(ALXenum type, const void *samples, int i)
+{
+    if (type == ALX_SAMPLE_FLOAT32)
+        return ((const float *) samples)[i];
+    return ((const short *) samples)[i] * (1.0f / 32768.0f);
+}
+
+static short roundInt16(float v)
+{
+    return v >= 32767.0f ? 32767 : v <= -32768.0f ? -32768 : (short) (v < 0.0f ? v - 0.5f : v + 0.5f);
+}
+
+/*
+    Frame n of 'frames' gets 'from' plus n + 1 steps. int16 samples go
+    through floats a chunk at a time.
+*/
+static void rampGain(const LevelKernels *k, ALXenum type, int channels, void *samples, int frames,
+                     float from, float step)
+{
+    float numbers[ALX_LEVEL_MAX_PERIOD], buffer[ALX_RAMP_CHUNK * ALX_MAX_LEVEL_CHANNELS];
+    float advance, start, *x;
+    int period = lcm(k->lanes, channels), total, periods, done, n, i;
+    short *p;
+
+    for (i = 0; i < period; ++i)
+        numbers[i] = (float) (i / channels + 1);
+    advance = (float) (period / channels);
+
+    for (done = 0; done < frames; done += n) {
+        n = frames - done;
+        if (type == ALX_SAMPLE_FLOAT32) {
+            x = (float *) samples + done * channels;
+        }
+        else {
+            if (n > ALX_RAMP_CHUNK)
+                n = ALX_RAMP_CHUNK;
+            p = (short *) samples + done * channels;
+            for (i = 0; i < n * channels; ++i)
+                buffer[i] = p[i];
+            x = buffer;
+        }
+
+        start = from + step * (float) done;
+        total = n * channels;
+        periods = total / period;
+        k->scale(x, periods, period, numbers, advance, start, step);
+        for (i = periods * period; i < total; ++i)
+            x[i] *= start + step * (numbers[i - periods * period] + advance * (float) periods);
+
+        if (type == ALX_SAMPLE_INT16) {
+            for (i = 0; i < total; ++i)
+                p[i] = roundInt16(buffer[i]);
+        }
+    }
+}
+
+static void measureRMSPeak(const LevelKernels *k, ALXenum type, ALXint channels,
+                           const void *samples, ALXint frames, ALXint what, ALXlevel *levels)
+{
+    double sums[ALX_LEVEL_MAX_PERIOD], channelSums[ALX_MAX_LEVEL_CHANNELS];
+    float peaks[ALX_LEVEL_MAX_PERIOD], channelPeaks[ALX_MAX_LEVEL_CHANNELS], v;
+    int period = lcm(type == ALX_SAMPLE_FLOAT32 ? k->lanes : k->lanes16, channels);
+    int total = frames * channels, periods = total / period;
+    int i, c;
+
+    memset(sums, 0, period * sizeof(double));
+    memset(peaks, 0, period * sizeof(float));
+    memset(channelSums, 0, channels * sizeof(double));
+    memset(channelPeaks, 0, channels * sizeof(float));
+
+    if (type == ALX_SAMPLE_FLOAT32)
+        k->sumFloat((const float *) samples, periods, period, sums, peaks);
+    else
+        k->sumInt16((const short *) samples, periods, period, sums, peaks);
+
+    // a period is a whole number of frames, so position i is channel i % channels
+    for (i = 0; i < period; ++i) {
+        c = i % channels;
+        channelSums[c] += sums[i];
+        if (peaks[i] > channelPeaks[c])
+            channelPeaks[c] = peaks[i];
+    }
+
+    for (i = periods * period; i < total; ++i) {
+        c = i % channels;
+        v = sample(type, samples, i);
+        channelSums[c] += (double) (v * v);
+        v = fabsf(v);
+        if (v > channelPeaks[c])
+            channelPeaks[c] = v;
+    }
+
+    for (c = 0; c < channels; ++c) {
+        if (what & ALX_LEVEL_RMS)
+            levels[c].rms = frames > 0 ? (ALXfloat) sqrt(channelSums[c] / frames) : 0.0f;
+        if (what & ALX_LEVEL_PEAK)
+            levels[c].peak = channelPeaks[c];
+    }
+}
+
+/*
+    The filter runs over one channel at a time, copied out of the block
+    behind the samples kept from the previous call.
+*/
+static float measureTruePeak(const LevelKernels *k, ALXenum type, ALXint channels,
+                             const void *samples, ALXint frames, int channel, ALXfloat *history)
+{
+    float buffer[ALX_TRUE_PEAK_TAPS - 1 + ALX_TRUE_PEAK_BLOCK], peak = 0.0f, p;
+    float *x = buffer + ALX_TRUE_PEAK_TAPS - 1;
+    int done, n, i;
+
+    memcpy(buffer, history, (ALX_TRUE_PEAK_TAPS - 1) * sizeof(float));
+
+    for (done = 0; done < frames; done += n) {
+        n = frames - done < ALX_TRUE_PEAK_BLOCK ? frames - done : ALX_TRUE_PEAK_BLOCK;
+        for (i = 0; i < n; ++i)
+            x[i] = sample(type, samples, (done + i) * channels + channel);
+
+        p = k->truePeak(x, n);
+        if (p > peak)
+            peak = p;
+
+        memmove(buffer, buffer + n, (ALX_TRUE_PEAK_TAPS - 1) * sizeof(float));
+    }
+
+    memcpy(history, buffer, (ALX_TRUE_PEAK_TAPS - 1) * sizeof(float));
+    return peak;
+}
+
+///////////////////////////////////////////////////////
+// Loudness
+
+static const double Pi = 3.14159265358979323846;
+
+static double loudness(double meanSquare)
+{
+    return meanSquare > 0.0 ? -0.691 + 10.0 * log10(meanSquare) : -HUGE_VAL;
+}
+
+static int loudnessBin(double lufs)
+{
+    int bin;
+
+    if (!(lufs >= ALX_LOUDNESS_GATE))
+        return -1;
+    bin = (int) ((lufs - ALX_LOUDNESS_GATE) * 10.0);
+    return bin < ALX_LOUDNESS_BINS ? bin : ALX_LOUDNESS_BINS - 1;
+}
+
+static double binLoudness(int bin)
+{
+    return ALX_LOUDNESS_GATE + (bin + 0.5) * 0.1;
+}
+
+static double binEnergy(int bin)
+{
+    return pow(10.0, (binLoudness(bin) + 0.691) / 10.0);
+}
+
+/*
+    The shelf and high-pass of BS.1770 designed for 'rate', which gives
+    the coefficients of its tables at 48 kHz.
+*/
+static void designKWeighting(double rate, double *k)
+{
+    double f0 = 1681.974450955533, q = 0.7071752369554196;
+    double t = tan(Pi * f0 / rate), vh = pow(10.0, 3.999843853973347 / 20.0);
+    double vb = pow(vh, 0.4996667741545416), a0 = 1.0 + t / q + t * t;
+
+    k[0] = (vh + vb * t / q + t * t) / a0;
+    k[1] = 2.0 * (t * t - vh) / a0;
+    k[2] = (vh - vb * t / q + t * t) / a0;
+    k[3] = 2.0 * (t * t - 1.0) / a0;
+    k[4] = (1.0 - t / q + t * t) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    t = tan(Pi * f0 / rate);
+    a0 = 1.0 + t / q + t * t;
+
+    k[5] = 1.0;
+    k[6] = -2.0;
+    k[7] = 1.0;
+    k[8] = 2.0 * (t * t - 1.0) / a0;
+    k[9] = (1.0 - t / q + t * t) / a0;
+}
+
+static void resetLoudness(ALXloudness *m)
+{
+    memset(m->z, 0, sizeof(m->z));
+    memset(m->energy, 0, sizeof(m->energy));
+    memset(m->steps, 0, sizeof(m->steps));
+    memset(m->blocks, 0, sizeof(m->blocks));
+    memset(m->windows, 0, sizeof(m->windows));
+    m->stepDone = 0;
+    m->stepCount = 0;
+    m->momentary = 0.0;
+    m->shortTerm = 0.0;
+}
+
+/*
+    Runs the widest vectors over as many channels as fit, then narrower
+    ones, down to the reference, so stereo still gets a vector when the
+    widest holds four. States that decayed to nothing are flushed, since
+    silence would otherwise leave them denormal.
+*/
+static void filterLoudness(const LevelKernels *k, ALXloudness *m, const float *x, int frames)
+{
+    int c = 0, i;
+
+    for (;; --k) {
+        for (; c + k->lanesDouble <= m->channels; c += k->lanesDouble)
+            k->kWeight(m->coeffs, m->z, x, frames, m->channels, c, m->energy);
+        if (k == Kernels)
+            break;
+    }
+
+    for (i = 0; i < 4 * ALX_MAX_LEVEL_CHANNELS; ++i) {
+        if (fabs(m->z[i]) < 1e-30)
+            m->z[i] = 0.0;
+    }
+}
+
+/*
+    Checks 'param' and 'index' and reads the value of the control
+*/
+static bool setGainTarget(GainTarget &target, ALXdevice *mixer, ALXenum param, ALXint index)
+{
+    switch (param)
+    {
+    case ALX_MASTER_VOLUME:
+    case ALX_PCM_OUTPUT_VOLUME:
+        if (index >= 0) {
+            setError(ALX_INVALID_VALUE);
+            return false;
+        }
+        target.value = alxGetFloat(mixer, param);
+        target.ceiling = 0.0;
+        break;
+
+    case ALX_OUTPUT_VOLUME:
+    case ALX_BUS_GAIN:
+        if (index < 0) {
+            setError(ALX_INVALID_VALUE);
+            return false;
+        }
+        target.value = alxGetIndexedFloat(mixer, param, index);
+        target.ceiling = param == ALX_BUS_GAIN ? 12.0 : 0.0;
+        break;
+
+    default:
+        setError(ALX_INVALID_ENUM);
+        return false;
+    }
+
+    // a value that could not be read counts as full
+    if (target.value < 0.0f)
+        target.value = 1.0f;
+
+    target.mixer = mixer;
+    target.param = param;
+    target.index = index;
+    target.queued = alxGetInteger(mixer, ALX_QUEUE_SIZE) > 0;
+    return true;
+}
+
+/*
+    False when the queue is full, for the caller to try again later
+*/
+static bool writeGain(const GainTarget &target, ALXfloat value)
+{
+    if (target.queued)
+        return alxQueueFloat(target.mixer, target.param, target.index, value) != ALX_FALSE;
+
+    if (target.index < 0)
+        alxSetFloat(target.mixer, target.param, value);
+    else
+        alxSetIndexedFloat(target.mixer, target.param, target.index, value);
+    return true;
+}
+
+/*
+    Moves the gain at most one step of the slew toward the target, and
+    writes it once it is 0.1 dB away from what was written. A full
+    queue leaves 'written' alone, so the next step tries again.
+*/
+static void followLoudness(ALXloudness *m)
+{
+    double lufs = loudness(m->shortTerm), wanted;
+
+    if (m->follow.mixer == NULL || m->stepCount < ALX_LOUDNESS_STEPS || lufs < ALX_LOUDNESS_GATE)
+        return;
+
+    wanted = m->target - lufs;
+    if (wanted > m->follow.ceiling)
+        wanted = m->follow.ceiling;
+    if (wanted < -60.0)
+        wanted = -60.0;
+
+    if (wanted > m->gain + m->slew)
+        m->gain += m->slew;
+    else if (wanted < m->gain - m->slew)
+        m->gain -= m->slew;
+    else
+        m->gain = wanted;
+
+    if (fabs(m->gain - m->written) < 0.1)
+        return;
+
+    if (writeGain(m->follow, (ALXfloat) pow(10.0, m->gain / 20.0)))
+        m->written = m->gain;
+}
+
+static void endLoudnessStep(ALXloudness *m)
+{
+    double sum = 0.0;
+    int c, i, bin;
+
+    for (c = 0; c < m->channels; ++c) {
+        sum += m->weights[c] * m->energy[c];
+        m->energy[c] = 0.0;
+    }
+    m->steps[m->stepCount % ALX_LOUDNESS_STEPS] = sum / m->stepFrames;
+    m->stepDone = 0;
+    ++m->stepCount;
+
+    // the steps before the first are silence
+    sum = 0.0;
+    for (i = 1; i <= 4 && (ALXuint) i <= m->stepCount; ++i)
+        sum += m->steps[(m->stepCount + ALX_LOUDNESS_STEPS - i) % ALX_LOUDNESS_STEPS];
+    m->momentary = sum / 4;
+    for (; i <= ALX_LOUDNESS_STEPS && (ALXuint) i <= m->stepCount; ++i)
+        sum += m->steps[(m->stepCount + ALX_LOUDNESS_STEPS - i) % ALX_LOUDNESS_STEPS];
+    m->shortTerm = sum / ALX_LOUDNESS_STEPS;
+
+    if (m->stepCount >= 4 && (bin = loudnessBin(loudness(m->momentary))) >= 0)
+        ++m->blocks[bin];
+    if (m->stepCount >= ALX_LOUDNESS_STEPS && (bin = loudnessBin(loudness(m->shortTerm))) >= 0)
+        ++m->windows[bin];
+
+    followLoudness(m);
+}
+
+/*
+    Mean energy of the binned loudness values within 'gate' LU of their
+    own mean, and the first bin of those.
+*/
+static double gatedEnergy(const ALXuint *histogram, double gate, int *first, double *count)
+{
+    double sum = 0.0, n = 0.0;
+    int i;
+
+    for (i = 0; i < ALX_LOUDNESS_BINS; ++i) {
+        if (histogram[i]) {
+            sum += histogram[i] * binEnergy(i);
+            n += histogram[i];
+        }
+    }
+    if (n == 0.0)
+        return 0.0;
+
+    i = loudnessBin(loudness(sum / n) - gate);
+    if (i < 0)
+        i = 0;
+    else if (binLoudness(i) < loudness(sum / n) - gate)
+        ++i;
+    *first = i;
+
+    sum = n = 0.0;
+    for (; i < ALX_LOUDNESS_BINS; ++i) {
+        if (histogram[i]) {
+            sum += histogram[i] * binEnergy(i);
+            n += histogram[i];
+        }
+    }
+    *count = n;
+    return n > 0.0 ? sum / n : 0.0;
+}
+
+static double integratedLoudness(const ALXloudness *m)
+{
+    double n;
+    int first;
+
+    return loudness(gatedEnergy(m->blocks, 10.0, &first, &n));
+}
+
+// from the 10th to the 95th percentile of the gated short-term values
+static double loudnessRange(const ALXloudness *m)
+{
+    double n, seen = 0.0, low = 0.0;
+    int first, i;
+
+    if (gatedEnergy(m->windows, 20.0, &first, &n) == 0.0)
+        return 0.0;
+
+    for (i = first; i < ALX_LOUDNESS_BINS; ++i) {
+        if (seen <= floor((n - 1) * 0.10))
+            low = binLoudness(i);
+        seen += m->windows[i];
+        if (seen > floor((n - 1) * 0.95))
+            return binLoudness(i) - low;
+    }
+    return 0.0;
+}
+
+
+///////////////////////////////////////////////////////
+// Ducking
+
+static void endDuckStep(ALXducker *d)
+{
+    double level = 10.0 * log10(d->energy / d->stepFrames + 1e-20);
+    double ms = 1000.0 * d->stepFrames / d->rate;
+
+    d->energy = 0.0;
+    d->stepDone = 0;
+
+    // 2 dB per second up
+    if (level < d->floor)
+        d->floor = level;
+    else
+        d->floor += 2.0 * ms / 1000.0;
+
+    if (level > d->threshold && level > d->floor + 10.0)
+        d->holding = d->hold + ms;
+
+    if (d->holding > 0.0) {
+        d->holding -= ms;
+        d->amount = d->attack > 0.0 ? d->amount + ms / d->attack : 1.0;
+        if (d->amount > 1.0)
+            d->amount = 1.0;
+    }
+    else {
+        d->amount = d->release > 0.0 ? d->amount - ms / d->release : 0.0;
+        if (d->amount < 0.0)
+            d->amount = 0.0;
+    }
+}
+
+/*
+    A target is written when it moved by 0.25 dB, or reached either end
+    of its range, so a block costs at most one write per target. Targets
+    are queued, as the tap pump may be the one writing them.
+*/
+static void writeDuckTargets(ALXducker *d)
+{
+    double gain;
+    int i;
+
+    for (i = 0; i < d->targetCount; ++i) {
+        gain = d->amount * d->depths[i];
+        if (gain == d->written[i])
+            continue;
+        if (fabs(gain - d->written[i]) < 0.25 && d->amount > 0.0 && d->amount < 1.0)
+            continue;
+        if (writeGain(d->targets[i], (ALXfloat) (d->targets[i].value * pow(10.0, gain / 20.0))))
+            d->written[i] = gain;
+    }
+}
+
+static void removeDuckTarget(ALXducker *d, int i)
+{
+    if (d->written[i] != 0.0)
+        writeGain(d->targets[i], d->targets[i].value);
+
+    --d->targetCount;
+    d->targets[i] = d->targets[d->targetCount];
+    d->depths[i] = d->depths[d->targetCount];
+    d->written[i] = d->written[d->targetCount];
+}
+
+
+/*
+    Meters, duckers and envelopes alive, for alxCloseDevice to find
+    those moving controls of the device it closes
+*/
+static ALXloudness *Meters = NULL;
+static ALXducker *Duckers = NULL;
+static ALXenvelope *Envelopes = NULL;
+
+template <class T>
+static void unlink(T **list, T *item)
+{
+    T **link;
+
+    for (link = list; *link; link = &(*link)->next) {
+        if (*link == item) {
+            *link = item->next;
+            break;
+        }
+    }
+}
+
+void forgetDevice(ALXdevice *mixer)
+{
+    ALXloudness *meter;
+    ALXducker *ducker;
+    ALXenvelope *envelope;
+    int i;
+
+    for (meter = Meters; meter; meter = meter->next) {
+        if (meter->follow.mixer == mixer)
+            meter->follow.mixer = NULL;
+    }
+
+    for (ducker = Duckers; ducker; ducker = ducker->next) {
+        for (i = ducker->targetCount - 1; i >= 0; --i) {
+            if (ducker->targets[i].mixer == mixer) {
+                // the queue is not processed again
+                ducker->targets[i].queued = false;
+                removeDuckTarget(ducker, i);
+            }
+        }
+    }
+
+    for (envelope = Envelopes; envelope; envelope = envelope->next) {
+        if (envelope->target.mixer == mixer)
+            envelope->target.mixer = NULL;
+    }
+}
+
+void linkDucker(ALXducker *ducker, ALXducker **capture)
+{
+    if (ducker->capture && ducker->capture != capture && *ducker->capture == ducker)
+        *ducker->capture = NULL;
+    ducker->capture = capture;
+}
+
+
+///////////////////////////////////////////////////////
+// Envelopes
+
+static const EnvelopePoint &nextPoint(const ALXenvelope *e)
+{
+    return e->points[e->first];
+}
+
+static void passPoints(ALXenvelope *e, ALXuint position)
+{
+    while (e->count > 0 && (ALXint) (nextPoint(e).position - position) <= 0) {
+        e->last = nextPoint(e);
+        e->passed = true;
+        e->first = (e->first + 1) % e->capacity;
+        --e->count;
+    }
+}
+
+/*
+    Gain at 'position', after the points up to it were passed, and how
+    much it moves each frame from there to the next point. Without a
+    point passed, or with none left, it holds.
+*/
+static double envelopeGain(const ALXenvelope *e, ALXuint position, double *slope)
+{
+    ALXint since = (ALXint) (position - e->last.position);
+
+    *slope = 0.0;
+    if (!e->passed)
+        return e->gain;
+    if (e->count == 0 || since < 0)
+        return e->last.gain;
+
+    *slope = (nextPoint(e).gain - (double) e->last.gain) / (ALXint) (nextPoint(e).position - e->last.position);
+    return e->last.gain + *slope * since;
+}
+
+/*
+    Writes the gain once it moved by 0.5 dB, or when it stopped moving,
+    so that a long ramp costs a write per half dB.
+*/
+static void followEnvelope(ALXenvelope *e, double slope)
+{
+    double gain = 20.0 * log10(e->gain + 1e-10);
+
+    if (gain > e->target.ceiling)
+        gain = e->target.ceiling;
+    if (gain == e->written || (slope != 0.0 && fabs(gain - e->written) < 0.5))
+        return;
+
+    if (writeGain(e->target, (ALXfloat) pow(10.0, gain / 20.0)))
+        e->written = gain;
+}
+
+
+///////////////////////////////////////////////////////
+// Tone
+
+ToneFilter::ToneFilter()
+    : _sequence(0), _designed(0), _rate(0), _channels(0), _count(0)
+{
+    int i;
+
+    for (i = 0; i < ALX_TONE_STAGES; ++i)
+        _levels[i] = 0.5f;
+}
+
+void ToneFilter::setLevel(int stage, ALXfloat level)
+{
+    ++_sequence;
+    _levels[stage] = level;
+    ++_sequence;
+}
+
+double ToneFilter::frequency(int stage)
+{
+    if (stage == Bass)
+        return 100.0;
+    if (stage == Treble)
+        return 10000.0;
+    return 31.25 * (1 << (stage - FirstBand));
+}
+
+/*
+    Shelves and peaks of the Audio EQ Cookbook, the shelves with a slope
+    of 1. State carries over for stages that stay, when the stream is
+    the same.
+*/
+void ToneFilter::design(const ALXfloat *levels, int channels, int rate)
+{
+    double z[2 * ALX_TONE_STAGES * ALX_MAX_LEVEL_CHANNELS], *k;
+    double a, w, c, alpha, root, a0;
+    int slots[ALX_TONE_STAGES], stage, count = 0, i;
+
+    for (stage = 0; stage < ALX_TONE_STAGES; ++stage)
+        slots[stage] = -1;
+    if (channels == _channels && rate == _rate) {
+        for (i = 0; i < _count; ++i)
+            slots[_stages[i]] = i;
+    }
+
+    memset(z, 0, sizeof(z));
+
+    for (stage = 0; stage < ALX_TONE_STAGES; ++stage) {
+        a = (levels[stage] - 0.5) * 24.0;
+        if (fabs(a) < 0.01 || frequency(stage) >= 0.45 * rate)
+            continue;
+
+        k = _coeffs + 5 * count;
+        a = pow(10.0, a / 40.0);
+        w = 2.0 * Pi * frequency(stage) / rate;
+        c = cos(w);
+
+        if (stage == Bass || stage == Treble) {
+            alpha = sin(w) / 2.0 * sqrt(2.0);
+            root = 2.0 * sqrt(a) * alpha;
+            if (stage == Bass) {
+                a0 = (a + 1.0) + (a - 1.0) * c + root;
+                k[0] = a * ((a + 1.0) - (a - 1.0) * c + root) / a0;
+                k[1] = 2.0 * a * ((a - 1.0) - (a + 1.0) * c) / a0;
+                k[2] = a * ((a + 1.0) - (a - 1.0) * c - root) / a0;
+                k[3] = -2.0 * ((a - 1.0) + (a + 1.0) * c) / a0;
+                k[4] = ((a + 1.0) + (a - 1.0) * c - root) / a0;
+            }
+            else {
+                a0 = (a + 1.0) - (a - 1.0) * c + root;
+                k[0] = a * ((a + 1.0) + (a - 1.0) * c + root) / a0;
+                k[1] = -2.0 * a * ((a - 1.0) + (a + 1.0) * c) / a0;
+                k[2] = a * ((a + 1.0) + (a - 1.0) * c - root) / a0;
+                k[3] = 2.0 * ((a - 1.0) - (a + 1.0) * c) / a0;
+                k[4] = ((a + 1.0) - (a - 1.0) * c - root) / a0;
+            }
+        }
+        else {
+            // an octave wide
+            alpha = sin(w) / (2.0 * 1.41);
+            a0 = 1.0 + alpha / a;
+            k[0] = (1.0 + alpha * a) / a0;
+            k[1] = -2.0 * c / a0;
+            k[2] = (1.0 - alpha * a) / a0;
+            k[3] = -2.0 * c / a0;
+            k[4] = (1.0 - alpha / a) / a0;
+        }
+
+        if (slots[stage] >= 0) {
+            for (i = 0; i < 2 * ALX_MAX_LEVEL_CHANNELS; ++i)
+                z[2 * count * ALX_MAX_LEVEL_CHANNELS + i] = _z[2 * slots[stage] * ALX_MAX_LEVEL_CHANNELS + i];
+        }
+        _stages[count++] = stage;
+    }
+
+    memcpy(_z, z, sizeof(z));
+    _count = count;
+    _channels = channels;
+    _rate = rate;
+}
+
+/*
+    Like the loudness meter, the widest vectors first, then narrower
+    ones over the channels left
+*/
+void ToneFilter::filter(float *x, int frames)
+{
+    const LevelKernels *k = kernels();
+    int c = 0, i;
+
+    for (;; --k) {
+        for (; c + k->lanesDouble <= _channels; c += k->lanesDouble)
+            k->biquads(_coeffs, _count, _z, x, frames, _channels, c);
+        if (k == Kernels)
+            break;
+    }
+
+    for (i = 0; i < 2 * _count * ALX_MAX_LEVEL_CHANNELS; ++i) {
+        if (fabs(_z[i]) < 1e-30)
+            _z[i] = 0.0;
+    }
+}
+
+bool ToneFilter::process(ALXenum type, int channels, int rate, void *samples, int frames)
+{
+    ALXfloat levels[ALX_TONE_STAGES];
+    ALXuint sequence;
+    short *p;
+    int done, n, i;
+
+    if (channels <= 0 || channels > ALX_MAX_LEVEL_CHANNELS || rate < 8000 || frames < 0
+        || (frames > 0 && samples == NULL))
+        return false;
+
+    sequence = _sequence;
+    if (sequence != _designed || channels != _channels || rate != _rate) {
+        do {
+            sequence = _sequence;
+            for (i = 0; i < ALX_TONE_STAGES; ++i)
+                levels[i] = _levels[i];
+        } while ((sequence & 1) != 0 || sequence != _sequence);
+
+        design(levels, channels, rate);
+        _designed = sequence;
+    }
+
+    if (_count == 0)
+        return true;
+
+    for (done = 0; done < frames; done += n) {
+        n = frames - done < ALX_TONE_CHUNK ? frames - done : ALX_TONE_CHUNK;
+
+        if (type == ALX_SAMPLE_FLOAT32) {
+            filter((float *) samples + done * channels, n);
+            continue;
+        }
+
+        p = (short *) samples + done * channels;
+        for (i = 0; i < n * channels; ++i)
+            _buffer[i] = p[i];
+        filter(_buffer, n);
+        for (i = 0; i < n * channels; ++i)
+            p[i] = roundInt16(_buffer[i]);
+    }
+    return true;
+}
+
+
+///////////////////////////////////////////////////////
+// Noise gate
+
+static const ALXfloat GateInitial[NoiseGate::Params] = {
+    -50.0f,     // Threshold
+    1.0f,       // Ratio
+    1.0f,       // Attack
+    100.0f,     // Release
+    -60.0f,     // Range
+    0.0f        // MuteDelay
+};
+
+NoiseGate::NoiseGate()
+    : _reported(0.0f), _envelope(0.0), _gain(0.0), _silence(0.0)
+{
+    int i;
+
+    for (i = 0; i < Params; ++i)
+        _params[i] = GateInitial[i];
+}
+
+ALXfloat NoiseGate::initial(int param)
+{
+    return GateInitial[param];
+}
+
+bool NoiseGate::set(int param, ALXfloat value)
+{
+    switch (param) {
+    case Threshold:
+    case Range:
+        if (value > 0.0f)
+            return false;
+        break;
+    case Ratio:
+        if (value < 1.0f)
+            return false;
+        break;
+    default:
+        if (value < 0.0f)
+            return false;
+        break;
+    }
+    _params[param] = value;
+    return true;
+}
+
+void NoiseGate::process(ALXenum type, int channels, int rate, void *samples, int frames)
+{
+    const LevelKernels *k = kernels();
+    ALXlevel levels[ALX_MAX_LEVEL_CHANNELS];
+    double threshold = _params[Threshold], ratio = _params[Ratio];
+    double attack = _params[Attack], release = _params[Release], range = _params[Range];
+    double power, level, target, time, next, from, ms;
+    char *x = (char *) samples;
+    int size = channels * (type == ALX_SAMPLE_FLOAT32 ? 4 : 2), n, c;
+
+    if (ratio <= 1.0 && _gain == 0.0) {
+        _silence = 0.0;
+        return;
+    }
+
+    for (; frames > 0; frames -= n, x += n * size) {
+        n = frames < ALX_GATE_CHUNK ? frames : ALX_GATE_CHUNK;
+        ms = 1000.0 * n / rate;
+
+        measureRMSPeak(k, type, channels, x, n, ALX_LEVEL_RMS, levels);
+        power = 0.0;
+        for (c = 0; c < channels; ++c) {
+            if ((double) levels[c].rms * levels[c].rms > power)
+                power = (double) levels[c].rms * levels[c].rms;
+        }
+
+        if (power > _envelope)
+            _envelope = power;
+        else
+            _envelope += (power - _envelope) * (1.0 - exp(-ms / 10.0));
+
+        level = 10.0 * log10(_envelope + 1e-20);
+        if (level < threshold) {
+            _silence += ms;
+            target = (level - threshold) * (ratio - 1.0);
+            if (target < range)
+                target = range;
+        }
+        else {
+            _silence = 0.0;
+            target = 0.0;
+        }
+
+        time = target > _gain ? attack : release;
+        next = time > 0.0 ? _gain + (target - _gain) * (1.0 - exp(-ms / time)) : target;
+        if (target == 0.0 && next > -0.001)
+            next = 0.0;
+
+        if (_gain != 0.0 || next != 0.0) {
+            from = pow(10.0, _gain / 20.0);
+            rampGain(k, type, channels, x, n, (float) from, (float) ((pow(10.0, next / 20.0) - from) / n));
+        }
+        _gain = next;
+    }
+
+    _reported = (ALXfloat) _gain;
+}
+
+} // namespace alx
+
+//////////////////////////////////////////////////////////////////////////////
+
+ALXAPI ALXboolean ALXAPIENTRY alxMeasureLevels(ALXenum type, ALXint channels, const void *samples,
+                                               ALXint frames, ALXint what, ALXlevel *levels)
+{
+    const alx::LevelKernels *k = alx::kernels();
+    int c;
+
+    if (type != ALX_SAMPLE_INT16 && type != ALX_SAMPLE_FLOAT32) {
+        alx::setError(ALX_INVALID_ENUM);
+        return ALX_FALSE;
+    }
+
+    if (channels <= 0 || channels > ALX_MAX_LEVEL_CHANNELS || frames < 0
+        || (frames > 0 && samples == NULL) || levels == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    if (what & (ALX_LEVEL_RMS | ALX_LEVEL_PEAK))
+        alx::measureRMSPeak(k, type, channels, samples, frames, what, levels);
+
+    if (what & ALX_LEVEL_TRUE_PEAK) {
+        for (c = 0; c < channels; ++c)
+            levels[c].truePeak = alx::measureTruePeak(k, type, channels, samples, frames, c, levels[c].history);
+    }
+
+    return ALX_TRUE;
+}
+
+
+ALXAPI ALXloudness * ALXAPIENTRY alxCreateLoudnessMeter(ALXint rate, ALXint channels)
+{
+    ALXloudness *meter;
+    LPALXFREE freeFunc;
+    void *data;
+    int c;
+
+    if (rate < 8000 || channels <= 0 || channels > ALX_MAX_LEVEL_CHANNELS) {
+        alx::setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    meter = (ALXloudness *) alx::allocate(sizeof(ALXloudness), &freeFunc, &data);
+    if (meter == NULL) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    meter->freeFunc = freeFunc;
+    meter->allocData = data;
+    meter->rate = rate;
+    meter->channels = channels;
+    meter->stepFrames = (rate + 5) / 10;
+    meter->follow.mixer = NULL;
+    alx::designKWeighting(rate, meter->coeffs);
+    meter->next = alx::Meters;
+    alx::Meters = meter;
+
+    for (c = 0; c < channels; ++c)
+        meter->weights[c] = 1.0;
+    if (channels == 6) {
+        meter->weights[3] = 0.0;
+        meter->weights[4] = meter->weights[5] = 1.41;
+    }
+
+    alx::resetLoudness(meter);
+    return meter;
+}
+
+
+ALXAPI void ALXAPIENTRY alxDeleteLoudnessMeter(ALXloudness *meter)
+{
+    if (meter) {
+        alx::unlink(&alx::Meters, meter);
+        meter->freeFunc(meter, meter->allocData);
+    }
+}
+
+
+ALXAPI void ALXAPIENTRY alxResetLoudnessMeter(ALXloudness *meter)
+{
+    if (meter)
+        alx::resetLoudness(meter);
+    else
+        alx::setError(ALX_INVALID_VALUE);
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxAddLoudnessSamples(ALXloudness *meter, ALXenum type,
+                                                    const void *samples, ALXint frames)
+{
+    const alx::LevelKernels *k = alx::kernels();
+    const float *x;
+    int n, i;
+
+    if (type != ALX_SAMPLE_INT16 && type != ALX_SAMPLE_FLOAT32) {
+        alx::setError(ALX_INVALID_ENUM);
+        return ALX_FALSE;
+    }
+
+    if (meter == NULL || frames < 0 || (frames > 0 && samples == NULL)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    while (frames > 0) {
+        n = meter->stepFrames - meter->stepDone;
+        if (n > frames)
+            n = frames;
+
+        if (type == ALX_SAMPLE_FLOAT32) {
+            x = (const float *) samples;
+            samples = x + n * meter->channels;
+        }
+        else {
+            if (n > ALX_LOUDNESS_CHUNK)
+                n = ALX_LOUDNESS_CHUNK;
+            for (i = 0; i < n * meter->channels; ++i)
+                meter->buffer[i] = ((const short *) samples)[i] * (1.0f / 32768.0f);
+            x = meter->buffer;
+            samples = (const short *) samples + n * meter->channels;
+        }
+
+        alx::filterLoudness(k, meter, x, n);
+        frames -= n;
+        meter->stepDone += n;
+        if (meter->stepDone == meter->stepFrames)
+            alx::endLoudnessStep(meter);
+    }
+
+    return ALX_TRUE;
+}
+
+
+ALXAPI ALXfloat ALXAPIENTRY alxGetLoudness(ALXloudness *meter, ALXenum param)
+{
+    if (meter == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return 0.0f;
+    }
+
+    switch (param)
+    {
+    case ALX_LOUDNESS_MOMENTARY:
+        return (ALXfloat) alx::loudness(meter->momentary);
+    case ALX_LOUDNESS_SHORT_TERM:
+        return (ALXfloat) alx::loudness(meter->shortTerm);
+    case ALX_LOUDNESS_INTEGRATED:
+        return (ALXfloat) alx::integratedLoudness(meter);
+    case ALX_LOUDNESS_RANGE:
+        return (ALXfloat) alx::loudnessRange(meter);
+    default:
+        alx::setError(ALX_INVALID_ENUM);
+        return 0.0f;
+    }
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxSetLoudnessTarget(ALXloudness *meter, ALXdevice *mixer, ALXenum param,
+                                                   ALXint index, ALXfloat target, ALXfloat rate)
+{
+    if (meter == NULL || (mixer != NULL && rate <= 0.0f)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    meter->follow.mixer = NULL;
+    if (mixer == NULL)
+        return ALX_TRUE;
+
+    if (!alx::setGainTarget(meter->follow, mixer, param, index))
+        return ALX_FALSE;
+
+    // start from where the control is
+    meter->gain = meter->follow.value > 0.001f ? 20.0 * log10((double) meter->follow.value) : -60.0;
+    meter->written = meter->gain;
+    meter->target = target;
+    meter->slew = rate * (double) meter->stepFrames / meter->rate;
+    return ALX_TRUE;
+}
+
+
+ALXAPI ALXducker * ALXAPIENTRY alxCreateDucker(ALXint rate)
+{
+    ALXducker *ducker;
+    LPALXFREE freeFunc;
+    void *data;
+
+    if (rate < 8000) {
+        alx::setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    ducker = (ALXducker *) alx::allocate(sizeof(ALXducker), &freeFunc, &data);
+    if (ducker == NULL) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    ducker->freeFunc = freeFunc;
+    ducker->allocData = data;
+    ducker->rate = rate;
+    ducker->stepFrames = (rate + ALX_DUCK_STEP_RATE / 2) / ALX_DUCK_STEP_RATE;
+    ducker->stepDone = 0;
+    ducker->energy = 0.0;
+    ducker->threshold = -45.0;
+    ducker->attack = 20.0;
+    ducker->hold = 300.0;
+    ducker->release = 500.0;
+    // the first quiet step sets it
+    ducker->floor = 0.0;
+    ducker->amount = 0.0;
+    ducker->holding = 0.0;
+    ducker->targetCount = 0;
+    ducker->capture = NULL;
+    ducker->next = alx::Duckers;
+    alx::Duckers = ducker;
+    return ducker;
+}
+
+
+ALXAPI void ALXAPIENTRY alxDeleteDucker(ALXducker *ducker)
+{
+    if (ducker) {
+        while (ducker->targetCount > 0)
+            alx::removeDuckTarget(ducker, ducker->targetCount - 1);
+        alx::linkDucker(ducker, NULL);
+        alx::unlink(&alx::Duckers, ducker);
+        ducker->freeFunc(ducker, ducker->allocData);
+    }
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxAddDuckTarget(ALXducker *ducker, ALXdevice *mixer, ALXenum param,
+                                               ALXint index, ALXfloat depth)
+{
+    alx::GainTarget target;
+    int i;
+
+    if (ducker == NULL || mixer == NULL || depth > 0.0f) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    // adding a target again changes its depth
+    for (i = 0; i < ducker->targetCount; ++i) {
+        target = ducker->targets[i];
+        if (target.mixer == mixer && target.param == param && target.index == index) {
+            ducker->depths[i] = depth;
+            return ALX_TRUE;
+        }
+    }
+
+    if (ducker->targetCount == ALX_MAX_DUCK_TARGETS) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return ALX_FALSE;
+    }
+
+    if (!alx::setGainTarget(target, mixer, param, index))
+        return ALX_FALSE;
+
+    // written from the thread pumping the tap, which must not call the driver
+    if (!target.queued) {
+        alx::setError(ALX_INVALID_OPERATION);
+        return ALX_FALSE;
+    }
+
+    i = ducker->targetCount++;
+    ducker->targets[i] = target;
+    ducker->depths[i] = depth;
+    ducker->written[i] = 0.0;
+    return ALX_TRUE;
+}
+
+
+ALXAPI void ALXAPIENTRY alxRemoveDuckTargets(ALXducker *ducker, ALXdevice *mixer)
+{
+    int i;
+
+    if (ducker == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    for (i = ducker->targetCount - 1; i >= 0; --i) {
+        if (mixer == NULL || ducker->targets[i].mixer == mixer)
+            alx::removeDuckTarget(ducker, i);
+    }
+}
+
+
+ALXAPI ALXfloat ALXAPIENTRY alxGetDuckerFloat(ALXducker *ducker, ALXenum param)
+{
+    if (ducker == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return 0.0f;
+    }
+
+    switch (param)
+    {
+    case ALX_DUCK_THRESHOLD:    return (ALXfloat) ducker->threshold;
+    case ALX_DUCK_ATTACK:       return (ALXfloat) ducker->attack;
+    case ALX_DUCK_HOLD:         return (ALXfloat) ducker->hold;
+    case ALX_DUCK_RELEASE:      return (ALXfloat) ducker->release;
+    case ALX_DUCK_AMOUNT:       return (ALXfloat) ducker->amount;
+    case ALX_DUCK_NOISE_FLOOR:  return (ALXfloat) ducker->floor;
+    default:
+        alx::setError(ALX_INVALID_ENUM);
+        return 0.0f;
+    }
+}
+
+
+ALXAPI void ALXAPIENTRY alxSetDuckerFloat(ALXducker *ducker, ALXenum param, ALXfloat value)
+{
+    if (ducker == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    switch (param)
+    {
+    case ALX_DUCK_THRESHOLD:
+        ducker->threshold = value;
+        break;
+
+    case ALX_DUCK_ATTACK:
+    case ALX_DUCK_HOLD:
+    case ALX_DUCK_RELEASE:
+        if (value < 0.0f) {
+            alx::setError(ALX_INVALID_VALUE);
+            return;
+        }
+        if (param == ALX_DUCK_ATTACK)
+            ducker->attack = value;
+        else if (param == ALX_DUCK_HOLD)
+            ducker->hold = value;
+        else
+            ducker->release = value;
+        break;
+
+    default:
+        alx::setError(ALX_INVALID_ENUM);
+        break;
+    }
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxProcessDucker(ALXducker *ducker, ALXenum type, ALXint channels,
+                                               const void *samples, ALXint frames)
+{
+    const alx::LevelKernels *k = alx::kernels();
+    ALXlevel levels[ALX_MAX_LEVEL_CHANNELS];
+    int n, c;
+
+    if (type != ALX_SAMPLE_INT16 && type != ALX_SAMPLE_FLOAT32) {
+        alx::setError(ALX_INVALID_ENUM);
+        return ALX_FALSE;
+    }
+
+    if (ducker == NULL || channels <= 0 || channels > ALX_MAX_LEVEL_CHANNELS || frames < 0
+        || (frames > 0 && samples == NULL)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    while (frames > 0) {
+        n = ducker->stepFrames - ducker->stepDone;
+        if (n > frames)
+            n = frames;
+
+        // mean square over the channels
+        alx::measureRMSPeak(k, type, channels, samples, n, ALX_LEVEL_RMS, levels);
+        for (c = 0; c < channels; ++c)
+            ducker->energy += (double) levels[c].rms * levels[c].rms * n / channels;
+
+        samples = (const char *) samples + n * channels * (type == ALX_SAMPLE_FLOAT32 ? 4 : 2);
+        frames -= n;
+        ducker->stepDone += n;
+        if (ducker->stepDone == ducker->stepFrames)
+            alx::endDuckStep(ducker);
+    }
+
+    alx::writeDuckTargets(ducker);
+    return ALX_TRUE;
+}
+
+
+ALXAPI ALXenvelope * ALXAPIENTRY alxCreateEnvelope(ALXint points)
+{
+    ALXenvelope *envelope;
+    LPALXFREE freeFunc;
+    void *data;
+
+    if (points <= 0 || points > ALX_MAX_ENVELOPE_POINTS) {
+        alx::setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    envelope = (ALXenvelope *) alx::allocate(sizeof(ALXenvelope) + points * sizeof(alx::EnvelopePoint),
+        &freeFunc, &data);
+    if (envelope == NULL) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    envelope->freeFunc = freeFunc;
+    envelope->allocData = data;
+    envelope->capacity = points;
+    envelope->first = 0;
+    envelope->count = 0;
+    envelope->points = (alx::EnvelopePoint *) (envelope + 1);
+    envelope->passed = false;
+    envelope->gain = 1.0;
+    envelope->target.mixer = NULL;
+    envelope->written = 0.0;
+    envelope->next = alx::Envelopes;
+    alx::Envelopes = envelope;
+    return envelope;
+}
+
+
+ALXAPI void ALXAPIENTRY alxDeleteEnvelope(ALXenvelope *envelope)
+{
+    if (envelope) {
+        alx::unlink(&alx::Envelopes, envelope);
+        envelope->freeFunc(envelope, envelope->allocData);
+    }
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxAddEnvelopePoint(ALXenvelope *envelope, ALXuint position, ALXfloat gain)
+{
+    const alx::EnvelopePoint *latest;
+    alx::EnvelopePoint *point;
+
+    if (envelope == NULL || gain < 0.0f) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    // after every point scheduled, and the one passed
+    latest = envelope->count > 0
+        ? &envelope->points[(envelope->first + envelope->count - 1) % envelope->capacity]
+        : envelope->passed ? &envelope->last : NULL;
+    if (latest != NULL && (ALXint) (position - latest->position) <= 0) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    if (envelope->count == envelope->capacity) {
+        alx::setError(ALX_OUT_OF_MEMORY);
+        return ALX_FALSE;
+    }
+
+    point = &envelope->points[(envelope->first + envelope->count) % envelope->capacity];
+    point->position = position;
+    point->gain = gain;
+    ++envelope->count;
+    return ALX_TRUE;
+}
+
+
+ALXAPI void ALXAPIENTRY alxClearEnvelope(ALXenvelope *envelope)
+{
+    if (envelope == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    // the gain holds where the clock was last
+    envelope->first = 0;
+    envelope->count = 0;
+    envelope->passed = false;
+}
+
+
+ALXAPI ALXfloat ALXAPIENTRY alxGetEnvelopeGain(ALXenvelope *envelope)
+{
+    if (envelope == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return 0.0f;
+    }
+    return (ALXfloat) envelope->gain;
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxProcessEnvelope(ALXenvelope *envelope, ALXenum type, ALXint channels,
+                                                 ALXuint position, void *samples, ALXint frames)
+{
+    const alx::LevelKernels *k = alx::kernels();
+    int size = type == ALX_SAMPLE_FLOAT32 ? 4 : 2, done, n;
+    double gain, slope;
+
+    if (type != ALX_SAMPLE_INT16 && type != ALX_SAMPLE_FLOAT32) {
+        alx::setError(ALX_INVALID_ENUM);
+        return ALX_FALSE;
+    }
+
+    if (envelope == NULL || channels <= 0 || channels > ALX_MAX_LEVEL_CHANNELS || frames < 0
+        || (frames > 0 && samples == NULL)) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    // a segment runs up to the next point, or to the end of the block
+    for (done = 0; done < frames; done += n) {
+        alx::passPoints(envelope, position + done);
+        gain = alx::envelopeGain(envelope, position + done, &slope);
+
+        n = frames - done;
+        if (envelope->count > 0 && (ALXint) (alx::nextPoint(envelope).position - (position + done)) < n)
+            n = (ALXint) (alx::nextPoint(envelope).position - (position + done));
+
+        if (gain != 1.0 || slope != 0.0)
+            alx::rampGain(k, type, channels, (char *) samples + done * channels * size, n,
+                (float) (gain - slope), (float) slope);
+    }
+
+    alx::passPoints(envelope, position + frames);
+    envelope->gain = alx::envelopeGain(envelope, position + frames, &slope);
+    return ALX_TRUE;
+}
+
+
+ALXAPI ALXboolean ALXAPIENTRY alxSetEnvelopeTarget(ALXenvelope *envelope, ALXdevice *mixer, ALXenum param,
+                                                   ALXint index)
+{
+    if (envelope == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return ALX_FALSE;
+    }
+
+    envelope->target.mixer = NULL;
+    if (mixer == NULL)
+        return ALX_TRUE;
+
+    if (!alx::setGainTarget(envelope->target, mixer, param, index))
+        return ALX_FALSE;
+
+    envelope->written = 20.0 * log10(envelope->target.value + 1e-10);
+    return ALX_TRUE;
+}
+
+
+ALXAPI void ALXAPIENTRY alxAdvanceEnvelope(ALXenvelope *envelope, ALXuint position)
+{
+    double slope;
+
+    if (envelope == NULL) {
+        alx::setError(ALX_INVALID_VALUE);
+        return;
+    }
+
+    alx::passPoints(envelope, position);
+    envelope->gain = alx::envelopeGain(envelope, position, &slope);
+    if (envelope->target.mixer != NULL)
+        alx::followEnvelope(envelope, slope);
+}
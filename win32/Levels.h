@@ -0,0 +1,166 @@
+/*
+ * ALx
+ * Level analysis kernels, internal interface
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef ALX_LEVELS_H
+#define ALX_LEVELS_H
+
+#include <alx.h>
+
+namespace alx {
+
+void setError(ALXenum errorCode);
+
+/*
+    A block from the allocator of alxSetAllocator, to be given back to
+    'freeFunc' with 'data', which the caller keeps for when it does.
+*/
+void *allocate(size_t size, LPALXFREE *freeFunc, void **data);
+
+/*
+    Instruction set the kernels run with: the best the processor has,
+    unless ALX_LEVEL_ISA was set.
+*/
+ALXenum levelISA();
+
+bool setLevelISA(ALXenum isa);
+
+/*
+    For alxCloseDevice, before the device goes: duck targets on it are
+    removed, their values written back, and loudness meters and
+    envelopes moving its controls stop.
+*/
+void forgetDevice(ALXdevice *mixer);
+
+/*
+    Keeps the device field linking a ducker to a tap, NULL when none,
+    for alxDeleteDucker to clear it.
+*/
+void linkDucker(ALXducker *ducker, ALXducker **capture);
+
+// software equalizer bands, an octave apart from 31.25 Hz
+#define ALX_TONE_BANDS          10
+#define ALX_TONE_STAGES         (2 + ALX_TONE_BANDS)
+// frames filtered at a time
+#define ALX_TONE_CHUNK          64
+
+/*
+    Software bass, treble and equalizer: a low shelf at 100 Hz, a high
+    shelf at 10 kHz and octave wide peaks, each up to 12 dB from flat,
+    run in place over interleaved blocks. Levels are 0.0 to 1.0, flat
+    at 0.5. One thread sets them while another processes blocks, which
+    picks them up through a sequence lock and designs the filters again
+    only when they or the stream changed. Flat stages are left out.
+*/
+class ToneFilter
+{
+public:
+    enum { Bass, Treble, FirstBand };
+
+    ToneFilter();
+
+    ALXfloat level(int stage) const { return _levels[stage]; }
+    void setLevel(int stage, ALXfloat level);
+
+    bool process(ALXenum type, int channels, int rate, void *samples, int frames);
+
+    static double frequency(int stage);
+
+private:
+    void design(const ALXfloat *levels, int channels, int rate);
+    void filter(float *x, int frames);
+
+    volatile ALXuint    _sequence;
+    volatile ALXfloat   _levels[ALX_TONE_STAGES];
+
+    ALXuint     _designed;
+    int         _rate;
+    int         _channels;
+    int         _count;
+    int         _stages[ALX_TONE_STAGES];
+    double      _coeffs[5 * ALX_TONE_STAGES];
+    double      _z[2 * ALX_TONE_STAGES * ALX_MAX_LEVEL_CHANNELS];
+    float       _buffer[ALX_TONE_CHUNK * ALX_MAX_LEVEL_CHANNELS];
+};
+
+// frames the gate measures and moves its gain over at a time
+#define ALX_GATE_CHUNK          32
+
+/*
+    Noise gate and expander of captured blocks. Below the threshold,
+    every dB the level drops takes 'ratio' - 1 dB more off the gain,
+    down to the range; the gain opens over the attack time and closes
+    over the release time, and moves linearly across each chunk. The
+    level is the loudest channel's, rising at once and falling over
+    10 ms so that low tones do not chatter. Parameters are set from any
+    thread; blocks are processed by the one pumping the tap. A ratio
+    of 1 leaves blocks alone once the gain is back at 0 dB.
+*/
+class NoiseGate
+{
+public:
+    enum { Threshold, Ratio, Attack, Release, Range, MuteDelay, Params };
+
+    NoiseGate();
+
+    ALXfloat get(int param) const { return _params[param]; }
+    bool set(int param, ALXfloat value);
+
+    // what a gate starts with, for devices that have none yet
+    static ALXfloat initial(int param);
+
+    bool active() const { return _params[Ratio] > 1.0f; }
+
+    void process(ALXenum type, int channels, int rate, void *samples, int frames);
+
+    // dB, and ms the level has been below the threshold
+    ALXfloat gain() const { return _reported; }
+    double silence() const { return _silence; }
+
+    // after the line was muted, whose blocks say nothing of the level
+    void reopen() { _envelope = 0.0; _silence = 0.0; }
+
+private:
+    volatile ALXfloat   _params[Params];
+    volatile ALXfloat   _reported;
+
+    double      _envelope;
+    double      _gain;
+    double      _silence;
+};
+
+} // namespace alx
+
+#endif /* ALX_LEVELS_H */
@@ -0,0 +1,186 @@
+/*
+ * ALx
+ * Realtime command queue, internal interface
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef ALX_QUEUE_H
+#define ALX_QUEUE_H
+
+#include <alx.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#endif
+
+namespace alx {
+
+// the few atomic operations the queue needs
+#if defined(_WIN32)
+typedef LONG QueueIndex;
+
+inline QueueIndex compareExchange(volatile QueueIndex *target, QueueIndex value, QueueIndex comparand)
+{
+    return InterlockedCompareExchange(target, value, comparand);
+}
+
+inline void publish(volatile QueueIndex *target, QueueIndex value)
+{
+    InterlockedExchange(target, value);
+}
+
+inline void fullBarrier()
+{
+    MemoryBarrier();
+}
+#else
+typedef int QueueIndex;
+
+inline QueueIndex compareExchange(volatile QueueIndex *target, QueueIndex value, QueueIndex comparand)
+{
+    return __sync_val_compare_and_swap(target, comparand, value);
+}
+
+inline void publish(volatile QueueIndex *target, QueueIndex value)
+{
+    __sync_synchronize();
+    *target = value;
+}
+
+inline void fullBarrier()
+{
+    __sync_synchronize();
+}
+#endif
+
+/*
+    Single producer, single consumer queue of set commands.
+
+    The producer (typically an audio thread) only copies the command
+    into a preallocated slot and publishes it with interlocked
+    operations: it never allocates, locks or calls the system. The
+    consumer applies the commands later, from a control thread; in the
+    daemon client that is also the thread that talks to the daemon.
+
+    When the queue is full the newest command is dropped, or, with
+    ALX_QUEUE_DROP_OLDEST, the producer takes the oldest slot back by
+    advancing the read index itself. The consumer advances that index
+    with a compare-exchange too, and discards what it read whenever the
+    exchange fails, since the slot may have been rewritten meanwhile.
+*/
+struct Command
+{
+    ALXenum     param;
+    ALXint      index;
+    ALXboolean  isFloat;
+    ALXfloat    value;
+};
+
+class CommandQueue
+{
+public:
+    CommandQueue(Command *slots, QueueIndex capacity)
+        : _slots(slots), _mask(capacity - 1), _head(0), _tail(0),
+          _dropped(0), _policy(ALX_QUEUE_DROP_NEWEST)
+    {}
+
+    static QueueIndex roundCapacity(ALXint size) {
+        QueueIndex capacity = 1;
+        while (capacity < size && capacity < (1 << 20))
+            capacity <<= 1;
+        return capacity;
+    }
+
+    bool push(const Command &command) {
+        QueueIndex head = _head;
+        QueueIndex tail;
+
+        for (;;) {
+            tail = _tail;
+            if ((unsigned long)(head - tail) <= (unsigned long) _mask)
+                break;
+
+            if (_policy != ALX_QUEUE_DROP_OLDEST) {
+                _dropped = _dropped + 1;
+                return false;
+            }
+
+            if (compareExchange(&_tail, tail + 1, tail) == tail) {
+                _dropped = _dropped + 1;
+                break;
+            }
+        }
+
+        _slots[head & _mask] = command;
+        publish(&_head, head + 1);
+        return true;
+    }
+
+    bool pop(Command &command) {
+        QueueIndex head;
+        QueueIndex tail;
+
+        for (;;) {
+            tail = _tail;
+            head = _head;
+            fullBarrier();
+            if (tail == head)
+                return false;
+
+            command = _slots[tail & _mask];
+            if (compareExchange(&_tail, tail + 1, tail) == tail)
+                return true;
+        }
+    }
+
+    QueueIndex capacity() const { return _mask + 1; }
+    QueueIndex pending() const { return _head - _tail; }
+    QueueIndex dropped() const { return _dropped; }
+    ALXenum policy() const { return _policy; }
+    void setPolicy(ALXenum policy) { _policy = policy; }
+
+private:
+    Command            *_slots;
+    QueueIndex          _mask;
+    volatile QueueIndex _head;
+    volatile QueueIndex _tail;
+    volatile QueueIndex _dropped;
+    volatile ALXenum    _policy;
+};
+
+} // namespace alx
+
+#endif // ALX_QUEUE_H
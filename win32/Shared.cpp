@@ -0,0 +1,140 @@
+/*
+ * ALx
+ * Shared state readers
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Used by both the library and the daemon client, which read the same
+ * segments. Segments are only found on Windows.
+ */
+
+#define ALX_BUILD_LIBRARY
+
+#include <string.h>
+#include <alx.h>
+
+#include "Shared.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#endif
+
+namespace alx {
+
+void setError(ALXenum errorCode);
+
+/*
+    Map a segment read-only, checking it is one of this version.
+*/
+const ALXsharedState *attachSharedState(const ALXchar *name)
+{
+#if defined(_WIN32)
+    HANDLE mapping;
+    const ALXsharedState *state;
+
+    if (name == NULL) {
+        setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (mapping == NULL) {
+        setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    state = (const ALXsharedState *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(ALXsharedState));
+    CloseHandle(mapping);
+    if (state == NULL) {
+        setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    if (state->magic != ALX_SHARED_STATE_MAGIC || state->version != ALX_SHARED_STATE_VERSION) {
+        UnmapViewOfFile(state);
+        setError(ALX_INVALID_VALUE);
+        return NULL;
+    }
+
+    return state;
+#else
+    (void) name;
+    setError(ALX_INVALID_OPERATION);
+    return NULL;
+#endif
+}
+
+/*
+    Copy a device slot, retrying while the owner writes it.
+*/
+bool readSharedDevice(const ALXsharedState *state, ALXint index, ALXsharedDevice *values)
+{
+#if defined(_WIN32)
+    const ALXsharedDevice *slot;
+    ALXint sequence;
+    int tries;
+
+    if (state == NULL || values == NULL || index < 0 || index >= state->numDevices
+        || index >= ALX_SHARED_MAX_DEVICES)
+        return false;
+
+    slot = &state->devices[index];
+    for (tries = 0; tries < 100; tries++) {
+        sequence = slot->sequence;
+        if (sequence & 1) {
+            YieldProcessor();
+            continue;
+        }
+
+        MemoryBarrier();
+        memcpy(values, (const void *) slot, sizeof(ALXsharedDevice));
+        MemoryBarrier();
+
+        if (slot->sequence == sequence)
+            return true;
+    }
+#else
+    (void) state; (void) index; (void) values;
+#endif
+    return false;
+}
+
+void detachSharedState(const ALXsharedState *state)
+{
+#if defined(_WIN32)
+    if (state != NULL)
+        UnmapViewOfFile(state);
+#else
+    (void) state;
+#endif
+}
+
+} // namespace alx
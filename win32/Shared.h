@@ -0,0 +1,97 @@
+/*
+ * ALx
+ * Shared state readers, internal interface
+ *
+ * Copyright (c) 2002-2009
+ *
+ * Written by Guilherme Balena Versiani
+ *
+ * OpenAL mixer is intended to work side-by-side with OpenAL.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef ALX_SHARED_H
+#define ALX_SHARED_H
+
+#include <string.h>
+#include <alx.h>
+
+namespace alx {
+
+/*
+    Readers of the segment of alxPublishSharedState, for the library and
+    the daemon client alike. Errors go to alx::setError.
+*/
+const ALXsharedState *attachSharedState(const ALXchar *name);
+
+bool readSharedDevice(const ALXsharedState *state, ALXint index, ALXsharedDevice *values);
+
+void detachSharedState(const ALXsharedState *state);
+
+/*
+    Whether the shorter of two device names is part of the longer, as
+    OpenAL and the daemon clients name mixers. Inline, so alxd can map
+    names without the library exporting it.
+*/
+inline ALXboolean match_device_name(const char *name1, const char *name2)
+{
+    int name1len, name2len, prefix;
+    struct {
+        const char *s;
+        int len;
+    } g, l;
+
+    name1len = strlen(name1);
+    name2len = strlen(name2);
+    prefix = name1len - name2len;
+
+    if (prefix >= 0) {
+        g.s = name1;
+        g.len = name1len;
+        l.s = name2;
+        l.len = name2len;
+    }
+    else {
+        g.s = name2;
+        g.len = name2len;
+        l.s = name1;
+        l.len = name1len;
+        prefix = -prefix;
+    }
+
+    while (prefix >= 0) {
+        if (!strncmp(g.s + prefix, l.s, l.len))
+            return ALX_TRUE;
+        --prefix;
+    }
+
+    return ALX_FALSE;
+}
+
+} // namespace alx
+
+#endif // ALX_SHARED_H